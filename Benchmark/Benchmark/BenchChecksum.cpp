@@ -0,0 +1,88 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <benchmark/benchmark.h>
+
+#include <strapper/net/Crc32c.h>
+#include <strapper/net/Lz4.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace strapper { namespace net { namespace bench {
+
+namespace {
+
+//! Compressible text, similar to replication traffic.
+std::string Text(size_t len)
+{
+    std::string const words[] = { "replica ", "update ", "key=", "value ", "timestamp ", "\n" };
+    std::mt19937 rng(7);
+    std::string s;
+    while (s.length() < len)
+        s += words[rng() % 6];
+    s.resize(len);
+    return s;
+}
+
+}  // namespace
+
+void Crc32cHardware(benchmark::State& state)
+{
+    std::vector<char> const data(static_cast<size_t>(state.range(0)), 'x');
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Crc32c(data.data(), data.size()));
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    state.SetLabel(Crc32cIsHardwareAccelerated() ? "sse4.2" : "portable");
+}
+BENCHMARK(Crc32cHardware)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+void Crc32cSoftware(benchmark::State& state)
+{
+    std::vector<char> const data(static_cast<size_t>(state.range(0)), 'x');
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Crc32cPortable(data.data(), data.size()));
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(Crc32cSoftware)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+void Lz4CompressText(benchmark::State& state)
+{
+    std::string const text = Text(static_cast<size_t>(state.range(0)));
+    std::vector<char> dest(Lz4CompressBound(text.length()));
+    size_t compressedLen = 0;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(compressedLen = Lz4Compress(text.data(), text.length(), dest.data(), dest.size()));
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    state.counters["ratio"] = static_cast<double>(text.length()) / static_cast<double>(compressedLen);
+}
+BENCHMARK(Lz4CompressText)->Arg(4096)->Arg(1 << 20);
+
+void Lz4DecompressText(benchmark::State& state)
+{
+    std::string const text = Text(static_cast<size_t>(state.range(0)));
+    std::vector<char> compressed(Lz4CompressBound(text.length()));
+    compressed.resize(Lz4Compress(text.data(), text.length(), compressed.data(), compressed.size()));
+    std::string dest(text.length(), '\0');
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Lz4Decompress(compressed.data(), compressed.size(), &dest[0], dest.length()));
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(Lz4DecompressText)->Arg(4096)->Arg(1 << 20);
+
+}}}  // namespace strapper::net::bench
@@ -0,0 +1,31 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <cstdint>
+
+namespace strapper { namespace net { namespace bench {
+
+//! Different ports than the unit tests, so both can run at once.
+struct BenchGlobals
+{
+    static char constexpr localhost[] = "127.0.0.1";
+    static uint16_t constexpr benchPortA = 11113;
+    static uint16_t constexpr benchPortB = 11114;
+};
+
+}}}  // namespace strapper::net::bench
@@ -0,0 +1,58 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        // Write JSON for regression tracking unless an output file was given. The console report is still printed.
+        std::vector<char*> args(argv, argv + argc);
+        std::string out = "--benchmark_out=StrapperNetBench.json";
+        std::string outFormat = "--benchmark_out_format=json";
+        bool const hasOut = std::any_of(args.begin(), args.end(), [](char const* arg) { return std::strncmp(arg, "--benchmark_out=", 16) == 0; });
+        if (!hasOut)
+        {
+            args.push_back(&out[0]);
+            args.push_back(&outFormat[0]);
+        }
+
+        auto count = static_cast<int>(args.size());
+        benchmark::Initialize(&count, args.data());
+        if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+            return EXIT_FAILURE;
+        benchmark::RunSpecifiedBenchmarks();
+        benchmark::Shutdown();
+        return EXIT_SUCCESS;
+    }
+    catch (std::exception const& e)
+    {
+        std::cout << "Exception occured.\n"
+                  << e.what() << std::endl;
+    }
+    catch (...)
+    {
+        std::cout << "Unknown exception occured." << std::endl;
+    }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,138 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <benchmark/benchmark.h>
+
+#include <strapper/net/ErrorCode.h>
+#include <strapper/net/IpAddress.h>
+#include <strapper/net/TcpListener.h>
+#include <strapper/net/TcpSerializer.h>
+#include <strapper/net/TcpSocket.h>
+#include <strapper/net/UdpSocket.h>
+#include "BenchGlobals.h"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace strapper { namespace net { namespace bench {
+
+namespace {
+
+//! Both ends of a loopback TCP connection. Stands in for a socketpair, which the library doesn't have.
+struct Connection
+{
+    Connection()
+    {
+        TcpListener listener(BenchGlobals::benchPortA);
+        client = TcpSocket(BenchGlobals::localhost, BenchGlobals::benchPortA);
+        server = listener.Accept();
+    }
+
+    TcpSocket client;
+    TcpSocket server;
+};
+
+}  // namespace
+
+//! Writes a value on one end of a connection and reads it from the other.
+template <typename T>
+void TcpSerializerRoundTrip(benchmark::State& state, T value)
+{
+    Connection connection;
+    TcpSerializer writer(std::move(connection.client));
+    TcpSerializer reader(std::move(connection.server));
+    writer.EnableChecksums(state.range(0) != 0);
+    reader.EnableChecksums(state.range(0) != 0);
+
+    T received{};
+    for (auto _ : state)
+    {
+        writer.Write(value);
+        if (!reader.Read(&received))
+        {
+            state.SkipWithError("Connection closed.");
+            break;
+        }
+        benchmark::DoNotOptimize(received);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(TcpSerializerRoundTrip, Int32, int32_t{ 12345 })->ArgName("checksums")->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK_CAPTURE(TcpSerializerRoundTrip, Double, 3.14159)->ArgName("checksums")->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK_CAPTURE(TcpSerializerRoundTrip, String64, std::string(64, 'x'))->ArgName("checksums")->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK_CAPTURE(TcpSerializerRoundTrip, String4096, std::string(4096, 'x'))->ArgName("checksums")->Arg(0)->Arg(1)->UseRealTime();
+
+//! Round trip latency: the message is echoed back by another thread.
+void TcpSocketPingPong(benchmark::State& state)
+{
+    Connection connection;
+    auto const len = static_cast<size_t>(state.range(0));
+    TcpSocket& server = connection.server;
+    std::thread echo([&server, len]() {
+        std::vector<char> buffer(len);
+        ErrorCode ec;
+        while (server.Read(buffer.data(), buffer.size(), &ec) && !ec)
+            server.Write(buffer.data(), buffer.size(), &ec);
+    });
+
+    std::vector<char> message(len, 'x');
+    for (auto _ : state)
+    {
+        connection.client.Write(message.data(), message.size());
+        if (!connection.client.Read(message.data(), message.size()))
+        {
+            state.SkipWithError("Connection closed.");
+            break;
+        }
+    }
+    connection.client.ShutdownSend();
+    echo.join();
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(TcpSocketPingPong)->Arg(1)->Arg(64)->Arg(1024)->Arg(16384)->UseRealTime();
+
+//! Packet rate of sending and receiving datagrams over loopback, in batches small enough not to be dropped.
+void UdpSocketLoopback(benchmark::State& state)
+{
+    int constexpr batch = 32;
+    UdpSocket sender(BenchGlobals::benchPortB);
+    UdpSocket receiver(BenchGlobals::benchPortA);
+    receiver.SetReadTimeout(1000);  // Don't hang if a datagram is dropped.
+    IpAddressV4 const ip(BenchGlobals::localhost);
+
+    std::vector<char> message(static_cast<size_t>(state.range(0)), 'x');
+    std::vector<char> received(message.size());
+    ErrorCode ec;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < batch; ++i)
+            sender.Write(message.data(), message.size(), ip, BenchGlobals::benchPortA);
+        for (int i = 0; i < batch && !ec; ++i)
+            receiver.Read(received.data(), received.size(), nullptr, nullptr, &ec);
+        if (ec)
+        {
+            state.SkipWithError(ec.What().c_str());
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+    state.SetBytesProcessed(state.iterations() * batch * state.range(0));
+}
+BENCHMARK(UdpSocketLoopback)->Arg(64)->Arg(1400)->UseRealTime();
+
+}}}  // namespace strapper::net::bench
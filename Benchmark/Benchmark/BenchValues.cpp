@@ -0,0 +1,114 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <benchmark/benchmark.h>
+
+#include <strapper/net/Endian.h>
+#include <strapper/net/ErrorCode.h>
+#include <strapper/net/IpAddress.h>
+#include <strapper/net/SocketError.h>
+
+#include <cstdint>
+#include <exception>
+#include <string>
+
+namespace strapper { namespace net { namespace bench {
+
+void IpAddressV4Parse(benchmark::State& state)
+{
+    std::string const ip = "192.168.100.200";
+    for (auto _ : state)
+    {
+        IpAddressV4 const address(ip);
+        benchmark::DoNotOptimize(address.ToInt());
+    }
+}
+BENCHMARK(IpAddressV4Parse);
+
+void IpAddressV4Format(benchmark::State& state)
+{
+    IpAddressV4 const address("192.168.100.200");
+    for (auto _ : state)
+        benchmark::DoNotOptimize(address.ToString('.'));
+}
+BENCHMARK(IpAddressV4Format);
+
+void NtonInt32(benchmark::State& state)
+{
+    int32_t value = 0x12345678;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(value);
+        benchmark::DoNotOptimize(nton(value));
+    }
+}
+BENCHMARK(NtonInt32);
+
+void NtonUint32InPlace(benchmark::State& state)
+{
+    uint32_t value = 0x12345678;
+    for (auto _ : state)
+    {
+        nton(&value);
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK(NtonUint32InPlace);
+
+void NtonDouble(benchmark::State& state)
+{
+    double value = 3.14159;
+    for (auto _ : state)
+    {
+        nton(&value);
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK(NtonDouble);
+
+void ErrorCodeDefault(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        ErrorCode const ec;
+        benchmark::DoNotOptimize(ec.NativeCode());
+    }
+}
+BENCHMARK(ErrorCodeDefault);
+
+void ErrorCodeFromSocketError(benchmark::State& state)
+{
+    std::exception_ptr const exception = std::make_exception_ptr(SocketError(111));
+    for (auto _ : state)
+    {
+        ErrorCode const ec(exception);
+        benchmark::DoNotOptimize(ec.NativeCode());
+    }
+}
+BENCHMARK(ErrorCodeFromSocketError);
+
+void ErrorCodeFromProgramError(benchmark::State& state)
+{
+    std::exception_ptr const exception = std::make_exception_ptr(ProgramError("Socket is not connected."));
+    for (auto _ : state)
+    {
+        ErrorCode const ec(exception);
+        benchmark::DoNotOptimize(ec.NativeCode());
+    }
+}
+BENCHMARK(ErrorCodeFromProgramError);
+
+}}}  // namespace strapper::net::bench
@@ -0,0 +1,78 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include "CommandLine.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace strapper { namespace net {
+
+CommandLine::CommandLine(int argc, char const* const* argv, std::initializer_list<std::string> booleanFlags /* = {} */)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg = argv[i];
+        if (arg.length() <= 2 || arg.compare(0, 2, "--") != 0)
+            throw std::invalid_argument("Unexpected argument: " + arg);
+
+        std::string const name = arg.substr(2);
+        if (std::find(booleanFlags.begin(), booleanFlags.end(), name) != booleanFlags.end())
+        {
+            m_flags[name] = "";
+            continue;
+        }
+        if (i + 1 >= argc)
+            throw std::invalid_argument("Missing value for " + arg);
+        m_flags[name] = argv[++i];
+    }
+}
+
+bool CommandLine::Has(std::string const& name) const
+{
+    return m_flags.count(name) != 0;
+}
+
+std::string CommandLine::GetString(std::string const& name, std::string const& defaultValue) const
+{
+    auto const it = m_flags.find(name);
+    return it == m_flags.end() ? defaultValue : it->second;
+}
+
+uint64_t CommandLine::GetNumber(std::string const& name, uint64_t defaultValue, uint64_t min /* = 0 */, uint64_t max /* = UINT64_MAX */) const
+{
+    auto const it = m_flags.find(name);
+    if (it == m_flags.end())
+        return defaultValue;
+
+    std::string const& value = it->second;
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+        throw std::invalid_argument("--" + name + " must be a whole number.");
+    uint64_t number = 0;
+    try
+    {
+        number = std::stoull(value);
+    }
+    catch (std::out_of_range const&)
+    {
+        throw std::invalid_argument("--" + name + " is out of range.");
+    }
+    if (number < min || number > max)
+        throw std::invalid_argument("--" + name + " must be between " + std::to_string(min) + " and " + std::to_string(max) + ".");
+    return number;
+}
+
+}}  // namespace strapper::net
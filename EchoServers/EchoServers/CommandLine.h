@@ -0,0 +1,43 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <string>
+
+namespace strapper { namespace net {
+
+//! Parses flags of the form --name value, or --name for a boolean flag.
+class CommandLine
+{
+public:
+    //! @param[in] booleanFlags Flags that don't take a value.
+    //! @throws std::invalid_argument If an argument isn't a flag, or a flag is missing its value.
+    CommandLine(int argc, char const* const* argv, std::initializer_list<std::string> booleanFlags = {});
+
+    bool Has(std::string const& name) const;
+    std::string GetString(std::string const& name, std::string const& defaultValue) const;
+    //! @throws std::invalid_argument If the value isn't a whole number in [min, max].
+    uint64_t GetNumber(std::string const& name, uint64_t defaultValue, uint64_t min = 0, uint64_t max = UINT64_MAX) const;
+
+private:
+    std::map<std::string, std::string> m_flags;
+};
+
+}}  // namespace strapper::net
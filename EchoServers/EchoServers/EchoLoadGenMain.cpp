@@ -0,0 +1,467 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include "CommandLine.h"
+
+#include <strapper/net/Endian.h>
+#include <strapper/net/ErrorCode.h>
+#include <strapper/net/IpAddress.h>
+#include <strapper/net/SocketError.h>
+#include <strapper/net/SocketStats.h>
+#include <strapper/net/TcpSerializer.h>
+#include <strapper/net/TcpSocket.h>
+#include <strapper/net/Trace.h>
+#include <strapper/net/UdpSocket.h>
+
+#ifndef _WIN32
+    #include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace strapper::net;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+//! A datagram that hasn't come back after this long is counted as lost.
+constexpr std::chrono::milliseconds c_udpLossTimeout(200);
+
+struct Options
+{
+    bool udp = false;
+    std::string host;
+    uint16_t port = 0;
+    unsigned connections = 0;
+    size_t size = 0;
+    uint64_t rate = 0;  // Messages per second per connection. 0 is unlimited.
+    unsigned pipeline = 0;
+    std::chrono::milliseconds duration{ 0 };
+    std::chrono::milliseconds timeout{ 0 };  // How long a TCP connection waits for an echo before failing.
+    std::string tracePath;  // Empty for no trace.
+};
+
+//! Results from one connection or flow.
+struct FlowResult
+{
+    std::vector<uint64_t> latenciesNs;
+    SocketStats stats;
+    uint64_t lost = 0;
+    std::string error;
+};
+
+void PrintUsage()
+{
+    std::cout << "Usage: EchoLoadGen [options]\n"
+                 "  --protocol     tcp or udp. Default tcp.\n"
+                 "  --host         Echo server address. Default 127.0.0.1.\n"
+                 "  --port         Echo server port. Default 11111.\n"
+                 "  --connections  Number of TCP connections or UDP flows, each on its own threads. Default 1.\n"
+                 "  --size         Message payload size in bytes. Default 64. At least 8 for UDP.\n"
+                 "  --rate         Messages per second per connection. Default 0, which is as fast as possible.\n"
+                 "  --pipeline     Messages in flight per connection. Default 1.\n"
+                 "  --duration     Seconds to send for. Default 5.\n"
+                 "  --timeout      Seconds a TCP connection waits for an echo before giving up. Default 5.\n"
+                 "  --trace        File to write a binary trace of every socket call to. See TraceDecoder.\n"
+                 "With --rate, latency is measured from when each message was due to be sent, so a stalled\n"
+                 "server is charged for the messages it held up rather than only the one it was stuck on.\n"
+              << std::flush;
+}
+
+Options ParseOptions(CommandLine const& args)
+{
+    Options options;
+    std::string const protocol = args.GetString("protocol", "tcp");
+    if (protocol != "tcp" && protocol != "udp")
+        throw std::invalid_argument("--protocol must be tcp or udp.");
+    options.udp = protocol == "udp";
+    options.host = args.GetString("host", "127.0.0.1");
+    options.port = static_cast<uint16_t>(args.GetNumber("port", 11111, 1, UINT16_MAX));
+    options.connections = static_cast<unsigned>(args.GetNumber("connections", 1, 1, 10000));
+    options.size = static_cast<size_t>(args.GetNumber("size", 64, options.udp ? sizeof(uint64_t) : 0, options.udp ? 65507 : TcpSerializer::c_maxStringLen));
+    options.rate = args.GetNumber("rate", 0, 0, 10000000);
+    options.pipeline = static_cast<unsigned>(args.GetNumber("pipeline", 1, 1, 100000));
+    options.duration = std::chrono::seconds(args.GetNumber("duration", 5, 1, 3600));
+    options.timeout = std::chrono::seconds(args.GetNumber("timeout", 5, 1, 3600));
+    options.tracePath = args.GetString("trace", "");
+    return options;
+}
+
+//! Decides when each message is sent.
+class Pacer
+{
+public:
+    Pacer(Options const& options, Clock::time_point start)
+        : m_start(start)
+        , m_end(start + options.duration)
+        , m_interval(options.rate == 0 ? Clock::duration(0) : std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / static_cast<double>(options.rate))))
+    { }
+
+    //! Waits until the next message is due.
+    //! @param[out] intended When the message should have been sent, which latency is measured from.
+    //! @return False when the run is over.
+    bool Next(Clock::time_point* intended)
+    {
+        if (m_interval == Clock::duration(0))
+        {
+            *intended = Clock::now();
+            return *intended < m_end;
+        }
+
+        *intended = m_start + m_interval * static_cast<Clock::rep>(m_sent++);
+        if (*intended >= m_end)
+            return false;
+        std::this_thread::sleep_until(*intended);
+        return true;
+    }
+
+private:
+    Clock::time_point const m_start;
+    Clock::time_point const m_end;
+    Clock::duration const m_interval;
+    uint64_t m_sent = 0;
+};
+
+uint64_t Nanoseconds(Clock::duration d)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+
+//! Sends length-prefixed messages in the TcpSerializer string format on one thread and reads the echoes on another.
+//! Responses come back in order, so the send times are a queue.
+void RunTcpFlow(Options const& options, Clock::time_point start, FlowResult* result)
+{
+    TcpSocket socket(options.host, options.port);
+    // So a server that stops replying fails the run instead of hanging it.
+    socket.SetReadTimeout(static_cast<unsigned>(options.timeout.count()));
+
+    std::vector<char> message(sizeof(int32_t) + options.size, 'x');
+    int32_t const header = nton(static_cast<int32_t>(options.size));
+    std::memcpy(message.data(), &header, sizeof(header));
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<Clock::time_point> inFlight;
+    bool done = false;
+    bool failed = false;
+
+    std::thread receiver([&]() {
+        std::vector<char> reply(options.size);
+        try
+        {
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    changed.wait(guard, [&]() { return !inFlight.empty() || done; });
+                    if (inFlight.empty())
+                        return;
+                }
+
+                int32_t replyHeader = 0;
+                if (!socket.Read(&replyHeader, sizeof(replyHeader)))
+                    throw ProgramError("Server closed the connection.");
+                if (replyHeader != header)
+                    throw ProgramError("Echo has the wrong length.");
+                if (!reply.empty())
+                {
+                    if (!socket.Read(reply.data(), reply.size()))
+                        throw ProgramError("Server closed the connection.");
+                }
+                Clock::time_point const now = Clock::now();
+
+                std::lock_guard<std::mutex> guard(lock);
+                result->latenciesNs.push_back(Nanoseconds(now - inFlight.front()));
+                inFlight.pop_front();
+                changed.notify_all();
+            }
+        }
+        catch (std::exception const& e)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            result->error = e.what();
+            failed = true;
+            changed.notify_all();
+        }
+    });
+
+    try
+    {
+        Pacer pacer(options, start);
+        Clock::time_point intended;
+        while (pacer.Next(&intended))
+        {
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard, [&]() { return inFlight.size() < options.pipeline || failed; });
+                if (failed)
+                    break;
+                inFlight.push_back(intended);
+                changed.notify_all();
+            }
+            socket.Write(message.data(), message.size());
+        }
+    }
+    catch (std::exception const& e)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        result->error = e.what();
+        failed = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        done = true;
+        if (failed)
+            socket.Close();  // Unblocks the receiver.
+        changed.notify_all();
+    }
+    receiver.join();
+    result->stats = socket.GetStats();
+}
+
+//! Sends datagrams tagged with a sequence number on one thread and reads the echoes on another.
+//! Datagrams can be lost or reordered, so the send times are looked up by sequence number.
+void RunUdpFlow(Options const& options, Clock::time_point start, FlowResult* result)
+{
+    IpAddressV4 const server(options.host);
+    UdpSocket socket(0);
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::map<uint64_t, Clock::time_point> inFlight;
+
+    std::thread receiver([&]() {
+        std::vector<char> reply(options.size + 1);
+        while (true)
+        {
+            ErrorCode ec;
+            unsigned const len = socket.Read(reply.data(), reply.size(), nullptr, nullptr, &ec);
+            if (ec)
+                return;  // Closed by the sender when it is done.
+            Clock::time_point const now = Clock::now();
+
+            std::lock_guard<std::mutex> guard(lock);
+            if (len != options.size)
+                continue;
+            uint64_t sequence = 0;
+            std::memcpy(&sequence, reply.data(), sizeof(sequence));
+            auto const it = inFlight.find(sequence);
+            if (it == inFlight.end())
+                continue;  // Already counted as lost.
+            result->latenciesNs.push_back(Nanoseconds(now - it->second));
+            inFlight.erase(it);
+            changed.notify_all();
+        }
+    });
+
+    // Waits for pred, counting datagrams older than the loss timeout as lost while waiting.
+    auto waitFor = [&](std::unique_lock<std::mutex>& guard, std::function<bool()> const& pred) {
+        while (!changed.wait_for(guard, c_udpLossTimeout, pred))
+        {
+            Clock::time_point const cutoff = Clock::now() - c_udpLossTimeout;
+            for (auto it = inFlight.begin(); it != inFlight.end() && it->second < cutoff;)
+            {
+                it = inFlight.erase(it);
+                ++result->lost;
+            }
+        }
+    };
+
+    try
+    {
+        std::vector<char> message(options.size, 'x');
+        Pacer pacer(options, start);
+        Clock::time_point intended;
+        for (uint64_t sequence = 0; pacer.Next(&intended); ++sequence)
+        {
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                waitFor(guard, [&]() { return inFlight.size() < options.pipeline; });
+                inFlight[sequence] = intended;
+            }
+            std::memcpy(message.data(), &sequence, sizeof(sequence));
+            socket.Write(message.data(), message.size(), server, options.port);
+        }
+
+        std::unique_lock<std::mutex> guard(lock);
+        waitFor(guard, [&]() { return inFlight.empty(); });
+    }
+    catch (std::exception const& e)
+    {
+        result->error = e.what();
+    }
+
+    socket.Close();
+    receiver.join();
+    result->stats = socket.GetStats();
+}
+
+double Percentile(std::vector<uint64_t> const& sorted, double percent)
+{
+    if (sorted.empty())
+        return 0;
+    auto const rank = static_cast<size_t>(percent / 100.0 * static_cast<double>(sorted.size()));
+    return static_cast<double>(sorted[std::min(rank, sorted.size() - 1)]) / 1000.0;
+}
+
+//! Voluntary plus involuntary context switches so far, where the platform reports them.
+long ContextSwitches()
+{
+#ifdef _WIN32
+    return -1;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+#endif
+}
+
+void Report(Options const& options, std::vector<FlowResult>& results, Clock::duration elapsed, long contextSwitches)
+{
+    std::vector<uint64_t> latencies;
+    uint64_t writes = 0;
+    uint64_t reads = 0;
+    uint64_t lost = 0;
+    for (FlowResult& result : results)
+    {
+        latencies.insert(latencies.end(), result.latenciesNs.begin(), result.latenciesNs.end());
+        result.latenciesNs = std::vector<uint64_t>();
+        writes += result.stats.writeCalls;
+        reads += result.stats.readCalls;
+        lost += result.lost;
+        if (!result.error.empty())
+            std::cout << "error        " << result.error << '\n';
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    double const seconds = std::chrono::duration<double>(elapsed).count();
+    auto const messages = static_cast<double>(latencies.size());
+    double const perMessage = messages > 0 ? 1.0 / messages : 0;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "EchoLoadGen  " << (options.udp ? "udp " : "tcp ") << options.host << ':' << options.port
+              << " connections=" << options.connections << " size=" << options.size << " pipeline=" << options.pipeline
+              << " rate=" << (options.rate == 0 ? std::string("max") : std::to_string(options.rate)) << '\n'
+              << "messages     " << latencies.size() << " in " << seconds << " s";
+    if (options.udp)
+        std::cout << ", " << lost << " lost";
+    std::cout << '\n'
+              << "throughput   " << messages / seconds << " msg/s, "
+              << messages * static_cast<double>(options.size) / seconds / 1e6 << " MB/s each way\n"
+              << "latency us   p50 " << Percentile(latencies, 50) << "  p99 " << Percentile(latencies, 99)
+              << "  p99.9 " << Percentile(latencies, 99.9) << "  max " << Percentile(latencies, 100) << '\n'
+              << "syscalls     " << static_cast<double>(writes) * perMessage << " send and " << static_cast<double>(reads) * perMessage << " recv per message";
+#if !STRAPPER_NET_SOCKET_STATS
+    std::cout << " (socket stats are compiled out)";
+#endif
+    std::cout << '\n';
+    if (contextSwitches >= 0)
+        std::cout << "ctx switches " << static_cast<double>(contextSwitches) * perMessage << " per message\n";
+    std::cout << std::flush;
+}
+
+int Run(Options const& options)
+{
+    std::vector<FlowResult> results(options.connections);
+    for (FlowResult& result : results)
+    {
+        uint64_t const expected = options.rate == 0 ? 1 << 16 : options.rate * static_cast<uint64_t>(options.duration.count()) / 1000;
+        result.latenciesNs.reserve(static_cast<size_t>(std::min<uint64_t>(expected, 1 << 24)));
+    }
+
+    Trace::Enable(!options.tracePath.empty());
+    long const switchesBefore = ContextSwitches();
+    Clock::time_point const start = Clock::now();
+    std::vector<std::thread> threads;
+    for (FlowResult& result : results)
+    {
+        FlowResult* r = &result;
+        threads.emplace_back([&options, start, r]() {
+            try
+            {
+                if (options.udp)
+                    RunUdpFlow(options, start, r);
+                else
+                    RunTcpFlow(options, start, r);
+            }
+            catch (std::exception const& e)
+            {
+                r->error = e.what();
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    Clock::duration const elapsed = Clock::now() - start;
+    long const switchesAfter = ContextSwitches();
+    Trace::Enable(false);
+
+    Report(options, results, elapsed, switchesBefore < 0 ? -1 : switchesAfter - switchesBefore);
+    if (!options.tracePath.empty())
+        std::cout << "trace        " << Trace::Dump(options.tracePath) << " records written to " << options.tracePath << std::endl;
+
+    bool const anyErrors = std::any_of(results.begin(), results.end(), [](FlowResult const& r) { return !r.error.empty(); });
+    return anyErrors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        CommandLine const args(argc, argv, { "help" });
+        if (args.Has("help"))
+        {
+            PrintUsage();
+            return EXIT_SUCCESS;
+        }
+        return Run(ParseOptions(args));
+    }
+    catch (std::invalid_argument const& e)
+    {
+        std::cout << e.what() << std::endl;
+        PrintUsage();
+    }
+    catch (std::exception const& e)
+    {
+        std::cout << "Exception occured.\n"
+                  << e.what() << std::endl;
+    }
+    catch (...)
+    {
+        std::cout << "Unknown exception occured." << std::endl;
+    }
+    return EXIT_FAILURE;
+}
@@ -17,8 +17,7 @@
 #include "EchoServers.h"
 
 #include <strapper/net/IpAddress.h>
-#include <strapper/net/TcpListener.h>
-#include <strapper/net/TcpSerializer.h>
+#include <strapper/net/SocketError.h>
 #include <strapper/net/UdpSocket.h>
 
 #include <array>
@@ -27,6 +26,209 @@
 
 namespace strapper { namespace net {
 
+//! Starts listening on port and serving clients immediately.
+TcpEchoServerPool::TcpEchoServerPool(uint16_t port, unsigned threads, int maxMessageLen /* = TcpSerializer::c_maxStringLen */)
+    : m_maxMessageLen(maxMessageLen)
+    , m_listener(port)
+{
+    if (threads == 0)
+        throw ProgramError("Echo server needs at least one thread.");
+    if (maxMessageLen < 0)
+        throw ProgramError("Max message length cannot be less than 0.");
+
+    // The system picks the port, so the wake connections can't be mistaken for clients.
+    TcpListener wakeListener(0);
+    uint16_t const wakePort = wakeListener.LocalPort();
+    ConnectOptions wakeOptions;
+    wakeOptions.socketOptions.noDelay = true;  // Otherwise a wake can wait for the previous one's delayed ACK.
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        m_workers.emplace_back(new Worker);
+        m_workers.back()->m_wakeSend = TcpSocket("127.0.0.1", wakePort, wakeOptions);
+        m_workers.back()->m_wakeReceive = wakeListener.Accept();
+    }
+    for (auto& worker : m_workers)
+    {
+        Worker& w = *worker;
+        w.m_thread = std::thread([this, &w]() { serve(w); });
+    }
+    m_acceptThread = std::thread([this]() { acceptLoop(); });
+}
+
+TcpEchoServerPool::~TcpEchoServerPool()
+{
+    Stop();
+}
+
+size_t TcpEchoServerPool::Connections() const
+{
+    return m_connections;
+}
+
+uint64_t TcpEchoServerPool::MessagesEchoed() const
+{
+    return m_messages;
+}
+
+//! Closes the listener and all connections, and joins the threads. Safe to call more than once.
+//! A worker blocked reading a partial message has that connection closed under it. One blocked writing to a client that
+//! has stopped reading still holds up Stop until the write fails.
+void TcpEchoServerPool::Stop()
+{
+    std::lock_guard<std::mutex> lock(m_stopLock);
+    if (m_joined)
+        return;
+
+    m_stop = true;
+    m_listener.Close();
+    for (auto& worker : m_workers)
+    {
+        std::lock_guard<std::mutex> workerLock(worker->m_lock);
+        wake(*worker);
+        // The others are closed by the worker once it wakes, since a socket can't be closed while another thread waits on it.
+        if (worker->m_reading)
+            worker->m_reading->Socket().Close();
+    }
+
+    m_acceptThread.join();
+    for (auto& worker : m_workers)
+        worker->m_thread.join();
+    m_joined = true;
+    m_stopped.notify_all();
+}
+
+//! Blocks until Stop is called from another thread.
+void TcpEchoServerPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_stopLock);
+    m_stopped.wait(lock, [this]() { return m_joined; });
+}
+
+void TcpEchoServerPool::acceptLoop()
+{
+    size_t next = 0;
+    while (!m_stop)
+    {
+        ErrorCode ec;
+        TcpSocket socket = m_listener.Accept(&ec);
+        if (m_stop || !m_listener.IsListening())
+            break;
+        if (ec || !socket)
+            continue;
+
+        // Round robin is close enough to balanced for clients with similar load.
+        Worker& worker = *m_workers[next++ % m_workers.size()];
+        std::unique_ptr<TcpSerializer> client(new TcpSerializer(std::move(socket), m_maxMessageLen));
+        ++m_connections;
+        std::lock_guard<std::mutex> lock(worker.m_lock);
+        worker.m_incoming.push_back(std::move(client));
+        wake(worker);
+    }
+}
+
+//! Makes the worker's WaitReadable return. Must be called with the worker's lock held.
+//! At most one byte is in flight, so the wake connection never fills up.
+void TcpEchoServerPool::wake(Worker& worker)
+{
+    if (worker.m_woken)
+        return;
+    char const signal = 0;
+    ErrorCode ec;
+    worker.m_wakeSend.Write(&signal, sizeof(signal), &ec);
+    if (ec)
+        std::cerr << "Echo server wake failed: " << ec.What() << std::endl;
+    worker.m_woken = !ec;
+}
+
+//! Echoes one message from each readable connection, and repeats.
+//! A client that sends part of a message holds up the worker until the rest arrives, like it would a dedicated thread.
+void TcpEchoServerPool::serve(Worker& worker)
+{
+    std::vector<std::unique_ptr<TcpSerializer>> clients;
+    std::vector<TcpSocket*> sockets;
+    std::vector<bool> ready;
+    std::string message;
+
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(worker.m_lock);
+            if (m_stop)
+                break;
+            for (auto& client : worker.m_incoming)
+                clients.push_back(std::move(client));
+            worker.m_incoming.clear();
+        }
+
+        // The wake connection comes first, so client i is at i + 1.
+        sockets.assign(1, &worker.m_wakeReceive);
+        for (auto& client : clients)
+            sockets.push_back(&client->Socket());
+
+        ErrorCode ec;
+        if (TcpSocket::WaitReadable(sockets, &ready, -1, &ec) == 0)
+        {
+            // Shouldn't happen, since failed connections are dropped below. Drop any that were closed some other way.
+            std::cerr << "Echo server wait failed: " << ec.What() << std::endl;
+            ready.assign(sockets.size(), false);
+            for (size_t i = 0; i < clients.size(); ++i)
+                ready[i + 1] = !clients[i]->Socket().IsOpen();
+        }
+
+        if (ready[0])
+        {
+            std::lock_guard<std::mutex> lock(worker.m_lock);
+            char signal = 0;
+            if (!worker.m_wakeReceive.Read(&signal, sizeof(signal), &ec) || ec)
+            {
+                std::cerr << "Echo server wake connection failed." << std::endl;
+                break;
+            }
+            worker.m_woken = false;
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < clients.size(); ++i)
+        {
+            bool open = true;
+            if (ready[i + 1] && !clients[i]->Socket().IsOpen())
+            {
+                open = false;
+            }
+            else if (ready[i + 1])
+            {
+                TcpSerializer& client = *clients[i];
+                {
+                    std::lock_guard<std::mutex> lock(worker.m_lock);
+                    if (m_stop)
+                        break;
+                    worker.m_reading = &client;
+                }
+                // A fresh error per client, so one failed connection doesn't drop the rest.
+                ErrorCode clientEc;
+                open = client.Read(&message, &clientEc) && !clientEc;
+                {
+                    std::lock_guard<std::mutex> lock(worker.m_lock);
+                    worker.m_reading = nullptr;
+                }
+                if (open)
+                {
+                    client.Write(message, &clientEc);
+                    open = !clientEc;
+                    if (open)
+                        ++m_messages;
+                }
+            }
+            if (open)
+                clients[kept++] = std::move(clients[i]);
+        }
+        m_connections -= clients.size() - kept;
+        clients.resize(kept);
+    }
+
+    m_connections -= clients.size();
+}
+
 void TcpEchoServer(uint16_t port)
 {
     TcpListener listener(port);
@@ -16,10 +16,67 @@
 
 #pragma once
 
+#include <strapper/net/TcpListener.h>
+#include <strapper/net/TcpSerializer.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace strapper { namespace net {
 
+//! Echoes strings sent with TcpSerializer back to any number of clients, using a fixed number of worker threads.
+//! Each new connection is handed to a worker, which waits on all its connections at once with TcpSocket::WaitReadable.
+//! Each worker also waits on a loopback connection of its own, written to when it is handed a connection or stopped.
+class TcpEchoServerPool
+{
+public:
+    TcpEchoServerPool(uint16_t port, unsigned threads, int maxMessageLen = TcpSerializer::c_maxStringLen);
+    TcpEchoServerPool(TcpEchoServerPool const&) = delete;
+    TcpEchoServerPool(TcpEchoServerPool&&) = delete;
+    TcpEchoServerPool& operator=(TcpEchoServerPool const&) = delete;
+    TcpEchoServerPool& operator=(TcpEchoServerPool&&) = delete;
+    ~TcpEchoServerPool();
+
+    size_t Connections() const;
+    uint64_t MessagesEchoed() const;
+
+    void Stop();
+    void Wait();
+
+private:
+    struct Worker
+    {
+        std::mutex m_lock;
+        std::vector<std::unique_ptr<TcpSerializer>> m_incoming;
+        TcpSerializer* m_reading = nullptr;  // The connection being read, so Stop can close it.
+        bool m_woken = false;                // Whether a wake byte is waiting to be read.
+        TcpSocket m_wakeSend;
+        TcpSocket m_wakeReceive;
+        std::thread m_thread;
+    };
+
+    void acceptLoop();
+    void serve(Worker& worker);
+    static void wake(Worker& worker);
+
+    int const m_maxMessageLen;
+    TcpListener m_listener;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::thread m_acceptThread;
+    std::atomic<bool> m_stop{ false };
+    std::atomic<size_t> m_connections{ 0 };
+    std::atomic<uint64_t> m_messages{ 0 };
+    std::mutex m_stopLock;
+    std::condition_variable m_stopped;
+    bool m_joined = false;
+};
+
 void TcpEchoServer(uint16_t port);
 void UdpEchoServer(uint16_t port);
 
@@ -14,20 +14,60 @@
 // limitations under the License.
 // ==================================================================
 
+#include "CommandLine.h"
 #include "EchoServers.h"
 
+#include <cstdint>
 #include <exception>
 #include <iostream>
+#include <stdexcept>
 
 using namespace strapper::net;
 
-int main()
+namespace {
+
+void PrintUsage()
+{
+    std::cout << "Usage: TcpEchoServer [--port N] [--threads N] [--buffer-size N]\n"
+                 "  --port         Port to listen on. Default 11111.\n"
+                 "  --threads      Serve any number of clients on N worker threads until killed.\n"
+                 "                 Without this, serves a single client interactively.\n"
+                 "  --buffer-size  Largest message accepted from a client, in bytes. Default 1048576.\n"
+              << std::flush;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
 {
     try
     {
-        TcpEchoServer(11111);
+        CommandLine const args(argc, argv, { "help" });
+        if (args.Has("help"))
+        {
+            PrintUsage();
+            return EXIT_SUCCESS;
+        }
+        auto const port = static_cast<uint16_t>(args.GetNumber("port", 11111, 1, UINT16_MAX));
+        auto const threads = static_cast<unsigned>(args.GetNumber("threads", 0, 0, 4096));
+        auto const bufferSize = static_cast<int>(args.GetNumber("buffer-size", TcpSerializer::c_maxStringLen, 0, INT32_MAX));
+
+        if (threads == 0)
+        {
+            TcpEchoServer(port);
+            return EXIT_SUCCESS;
+        }
+
+        TcpEchoServerPool server(port, threads, bufferSize);
+        std::cout << "Echoing on port " << port << " with " << threads << " threads." << std::endl;
+        server.Wait();
         return EXIT_SUCCESS;
     }
+    catch (std::invalid_argument const& e)
+    {
+        std::cout << e.what() << std::endl;
+        PrintUsage();
+    }
     catch (std::exception const& e)
     {
         std::cout << "Exception occured.\n"
@@ -0,0 +1,93 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Converts a binary trace written by strapper::net::Trace::Dump to the Chrome trace event format,
+// which chrome://tracing and https://ui.perfetto.dev can display as a timeline.
+
+#include "CommandLine.h"
+
+#include <strapper/net/Trace.h>
+
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace strapper::net;
+
+namespace {
+
+void PrintUsage()
+{
+    std::cout << "Usage: TraceDecoder --in FILE [--out FILE]\n"
+                 "  --in   Binary trace, e.g. from EchoLoadGen --trace.\n"
+                 "  --out  JSON file to write. Default is the input path with .json appended.\n"
+              << std::flush;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        CommandLine const args(argc, argv, { "help" });
+        if (args.Has("help"))
+        {
+            PrintUsage();
+            return EXIT_SUCCESS;
+        }
+        std::string const inPath = args.GetString("in", "");
+        if (inPath.empty())
+            throw std::invalid_argument("--in is required.");
+        std::string const outPath = args.GetString("out", inPath + ".json");
+
+        std::ifstream in(inPath, std::ios::binary);
+        if (!in)
+            throw std::runtime_error("Could not open " + inPath + ".");
+        auto records = Trace::Read(in);
+        size_t const count = records.size();
+
+        std::ofstream out(outPath);
+        if (!out)
+            throw std::runtime_error("Could not open " + outPath + " for writing.");
+        Trace::WriteChromeJson(std::move(records), out);
+        out.close();
+        if (!out)
+            throw std::runtime_error("Failed to write " + outPath + ".");
+
+        std::cout << "Decoded " << count << " records to " << outPath << std::endl;
+        return EXIT_SUCCESS;
+    }
+    catch (std::invalid_argument const& e)
+    {
+        std::cout << e.what() << std::endl;
+        PrintUsage();
+    }
+    catch (std::exception const& e)
+    {
+        std::cout << "Exception occured.\n"
+                  << e.what() << std::endl;
+    }
+    catch (...)
+    {
+        std::cout << "Unknown exception occured." << std::endl;
+    }
+    return EXIT_FAILURE;
+}
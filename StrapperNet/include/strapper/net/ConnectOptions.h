@@ -0,0 +1,54 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <strapper/net/IpAddress.h>
+#include <strapper/net/SocketOptions.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace strapper { namespace net {
+
+class Resolver;
+
+//! Controls how TcpSocket connects to a host name.
+//! All resolved addresses are tried, alternating between address families. Each attempt gets attemptDelay to
+//! succeed before the next one is started alongside it, and the first connection to complete wins (RFC 8305).
+struct ConnectOptions
+{
+    //! Bound on the whole connect, across every attempt. Zero leaves it to the system's own retry schedule.
+    std::chrono::milliseconds timeout{ 0 };
+    //! Head start given to each attempt before the next address is tried in parallel.
+    std::chrono::milliseconds attemptDelay{ 250 };  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    //! Resolves the host name. Null uses Resolver::Global().
+    Resolver* resolver = nullptr;
+
+    //! Local address to connect from, to pick the outgoing interface on a multi-homed host.
+    //! Left as IPv4 Any with localPort 0, the system chooses. Otherwise only resolved addresses of the same family are tried.
+    IpAddress localAddress;
+    //! Local port to connect from. Zero defers the choice to connect time (IP_BIND_ADDRESS_NO_PORT on Linux),
+    //! so binding a local address does not reserve an ephemeral port per socket and exhaust the range.
+    uint16_t localPort = 0;
+    //! Network interface to send through, e.g. "eth1" (SO_BINDTODEVICE). Linux only.
+    std::string device;
+    //! Applied to each attempt before it connects, so buffer sizes take part in the handshake.
+    SocketOptions socketOptions;
+};
+
+}}  // namespace strapper::net
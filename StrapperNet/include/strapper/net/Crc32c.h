@@ -0,0 +1,34 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace strapper { namespace net {
+
+//! Size of a CRC32C integrity trailer on the wire.
+constexpr size_t c_checksumLen = sizeof(uint32_t);
+
+//! CRC32C (Castagnoli). Uses the SSE4.2 crc32 instruction when the CPU supports it.
+//! @param[in] crc The result of a previous call, to continue a checksum over multiple buffers.
+uint32_t Crc32c(void const* data, size_t len, uint32_t crc = 0);
+//! Same result as Crc32c, computed without hardware support (slicing-by-8).
+uint32_t Crc32cPortable(void const* data, size_t len, uint32_t crc = 0);
+bool Crc32cIsHardwareAccelerated();
+
+}}  // namespace strapper::net
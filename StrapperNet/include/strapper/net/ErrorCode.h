@@ -31,6 +31,7 @@ public:
 
     int NativeCode() const { return m_nativeErrorCode; }
     std::string const& What() const { return m_what; }
+    bool IsIntegrityError() const { return m_integrityError; }
     explicit operator bool() const { return !!m_exception; }
 
     void Rethrow() const;
@@ -38,6 +39,7 @@ public:
 private:
     std::exception_ptr m_exception;
     int m_nativeErrorCode = 0;
+    bool m_integrityError = false;
     std::string m_what = GetErrorName(0);
 };
 
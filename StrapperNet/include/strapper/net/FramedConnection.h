@@ -0,0 +1,88 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <strapper/net/TcpSocket.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace strapper { namespace net {
+
+class ErrorCode;
+
+//! Sends length-prefixed frames tagged with a sequence ID.
+//! Requests can be pipelined: many can be sent before any response is read.
+//! Responses are matched to requests by sequence ID, so the other side may reply out of order.
+//! One thread may read while others write.
+class FramedConnection
+{
+public:
+    //! Sequence ID and payload length, both 32-bit big endian.
+    static constexpr size_t c_headerLen = 8;
+    static constexpr uint32_t c_maxFrameLen = 1024 * 1024;
+
+    struct Frame
+    {
+        uint32_t sequence = 0;
+        std::string payload;
+    };
+
+    explicit FramedConnection(TcpSocket&& socket, uint32_t maxFrameLen = c_maxFrameLen);
+    FramedConnection(FramedConnection const&) = delete;
+    FramedConnection(FramedConnection&&) = delete;
+    FramedConnection& operator=(FramedConnection const&) = delete;
+    FramedConnection& operator=(FramedConnection&&) = delete;
+    ~FramedConnection() = default;
+
+    TcpSocket const& Socket() const;
+    TcpSocket& Socket();
+
+    void Encode(uint32_t sequence, std::string const& payload, std::string* dest) const;
+
+    void Send(uint32_t sequence, std::string const& payload, ErrorCode* ec = nullptr);
+    bool Receive(Frame* dest, ErrorCode* ec = nullptr);
+
+    uint32_t SendRequest(std::string const& payload, ErrorCode* ec = nullptr);
+    bool ReadResponse(uint32_t sequence, std::string* dest, ErrorCode* ec = nullptr);
+    bool ReadNextResponse(Frame* dest, ErrorCode* ec = nullptr);
+    size_t Outstanding() const;
+
+private:
+    void send(uint32_t sequence, std::string const& payload);
+    bool receive(Frame* dest);
+    bool takeArrived(uint32_t sequence, std::string* dest);
+
+    TcpSocket m_socket;
+    uint32_t const m_maxFrameLen;
+
+    std::mutex m_writeLock;
+    std::string m_writeBuffer;
+    uint32_t m_nextSequence = 0;
+
+    std::mutex m_readLock;
+
+    mutable std::mutex m_requestLock;
+    std::unordered_set<uint32_t> m_outstanding;
+    std::unordered_map<uint32_t, std::string> m_arrived;
+};
+
+}}  // namespace strapper::net
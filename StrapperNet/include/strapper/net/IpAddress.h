@@ -45,4 +45,72 @@ private:
     uint32_t m_val = 0;
 };
 
+class IpAddressV6
+{
+public:
+    static IpAddressV6 const Any;
+    static IpAddressV6 const Loopback;
+
+    IpAddressV6() = default;
+    IpAddressV6(std::string const& ip);  // cppcheck-suppress[noExplicitConstructor] NOLINT: Intentional conversion constructor.
+    //! @param[in] bytes The address in network byte order.
+    explicit IpAddressV6(std::array<uint8_t, 16> const& bytes);
+
+    //! @return The IPv4-mapped address ::ffff:a.b.c.d, which is how a dual-stack socket sees an IPv4 peer.
+    static IpAddressV6 MapV4(IpAddressV4 const& ip);
+
+    //! Formats per RFC 5952: lowercase hex, leading zeros dropped, the longest run of zero groups
+    //! compressed to "::", and IPv4-mapped addresses written with a dotted quad.
+    std::string ToString() const;
+    std::array<uint8_t, 16> ToArray() const;
+
+    bool IsV4Mapped() const;
+    //! @return The embedded address of an IPv4-mapped address. Throws if IsV4Mapped is false.
+    IpAddressV4 ToV4() const;
+
+    bool operator==(IpAddressV6 const& other) const;
+    bool operator!=(IpAddressV6 const& other) const;
+
+private:
+    std::array<uint8_t, 16> m_bytes{};
+};
+
+//! Holds either an IPv4 or an IPv6 address.
+//! Sockets report IPv4-mapped peers of a dual-stack socket as plain IPv4 addresses.
+class IpAddress
+{
+public:
+    enum class Family
+    {
+        V4,
+        V6
+    };
+
+    IpAddress() = default;
+    IpAddress(IpAddressV4 const& ip);    // cppcheck-suppress[noExplicitConstructor] NOLINT: Intentional conversion constructor.
+    IpAddress(IpAddressV6 const& ip);    // cppcheck-suppress[noExplicitConstructor] NOLINT: Intentional conversion constructor.
+    IpAddress(std::string const& ip);    // cppcheck-suppress[noExplicitConstructor] NOLINT: Intentional conversion constructor.
+
+    //! Parses like the string constructor, but returns false instead of throwing.
+    static bool TryParse(std::string const& text, IpAddress* out_ip);
+
+    Family GetFamily() const;
+    bool IsV4() const;
+    bool IsV6() const;
+    //! Throws if the address is not of the requested family.
+    IpAddressV4 const& V4() const;
+    IpAddressV6 const& V6() const;
+
+    //! IPv4 addresses use '.' as the delimiter, since ':' would be ambiguous.
+    std::string ToString() const;
+
+    bool operator==(IpAddress const& other) const;
+    bool operator!=(IpAddress const& other) const;
+
+private:
+    Family m_family = Family::V4;
+    IpAddressV4 m_v4;
+    IpAddressV6 m_v6;
+};
+
 }}  // namespace strapper::net
@@ -0,0 +1,98 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace strapper { namespace net {
+
+//! A log-linear latency histogram in nanoseconds, in the style of HdrHistogram.
+//! Each power of two is split into c_subBuckets linear buckets, so any recorded value is
+//! reported to within 1/c_subBuckets (about 3%) of its true value over the whole 64-bit range.
+//! Recording is lock-free and allocation-free, so one histogram can be shared by many sockets and threads.
+//! Queries taken while other threads record may be slightly out of step with each other.
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned c_subBucketBits = 5;
+    static constexpr uint64_t c_subBuckets = uint64_t(1) << c_subBucketBits;
+    static constexpr size_t c_bucketCount = (64 - c_subBucketBits + 1) * c_subBuckets;
+
+    LatencyHistogram() = default;
+    LatencyHistogram(LatencyHistogram const&) = delete;
+    LatencyHistogram& operator=(LatencyHistogram const&) = delete;
+
+    void Record(uint64_t nanoseconds) noexcept;
+    void Record(std::chrono::nanoseconds duration) noexcept;
+    void Merge(LatencyHistogram const& other) noexcept;
+    void Reset() noexcept;
+
+    uint64_t Count() const noexcept;
+    uint64_t Min() const noexcept;
+    uint64_t Max() const noexcept;
+    double Mean() const noexcept;
+    uint64_t Percentile(double percentile) const noexcept;
+
+    static size_t BucketIndex(uint64_t nanoseconds) noexcept;
+    static uint64_t BucketLowerBound(size_t index) noexcept;
+    static uint64_t BucketUpperBound(size_t index) noexcept;
+
+private:
+    std::array<std::atomic<uint64_t>, c_bucketCount> m_buckets{};
+    std::atomic<uint64_t> m_count{ 0 };
+    std::atomic<uint64_t> m_sum{ 0 };
+    std::atomic<uint64_t> m_min{ UINT64_MAX };
+    std::atomic<uint64_t> m_max{ 0 };
+};
+
+//! Histograms a socket records into. Any of them may be null, and one histogram may be
+//! attached to many sockets to merge their latencies as they are recorded.
+struct SocketLatency
+{
+    std::shared_ptr<LatencyHistogram> read;      //!< Time in the receive (or accept) system calls of one Read (or Accept).
+    std::shared_ptr<LatencyHistogram> write;     //!< Time in the send system calls of one Write.
+    std::shared_ptr<LatencyHistogram> lockWait;  //!< Time spent waiting for the socket's state lock before starting.
+};
+
+//! Measures one interval for a histogram that may not be attached.
+//! Reads the clock only when enabled, so sockets without histograms pay a branch instead.
+class LatencyTimer
+{
+public:
+    explicit LatencyTimer(bool enabled) noexcept
+    {
+        if (enabled)
+            m_start = std::chrono::steady_clock::now();
+    }
+
+    //! Records the time since construction into histogram. Does nothing if either is missing.
+    void Stop(LatencyHistogram* histogram) const noexcept
+    {
+        if (histogram && m_start != std::chrono::steady_clock::time_point())
+            histogram->Record(std::chrono::steady_clock::now() - m_start);
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+}}  // namespace strapper::net
@@ -0,0 +1,34 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <cstddef>
+
+namespace strapper { namespace net {
+
+//! Largest possible compressed size for an input of the given length.
+size_t Lz4CompressBound(size_t len);
+//! Compresses to the LZ4 block format, which any LZ4 block decoder can read.
+//! @param[in] destCapacity Must be at least Lz4CompressBound(len).
+//! @return The compressed size.
+size_t Lz4Compress(void const* src, size_t len, void* dest, size_t destCapacity);
+//! Decompresses an LZ4 block. Malformed input throws a ProgramError instead of reading or writing out of bounds.
+//! @param[in] destCapacity The decompressed size must not exceed this.
+//! @return The decompressed size.
+size_t Lz4Decompress(void const* src, size_t len, void* dest, size_t destCapacity);
+
+}}  // namespace strapper::net
@@ -0,0 +1,98 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace strapper { namespace net {
+
+//! Process-wide socket metrics, aggregated across every socket and listener.
+//! The basic sockets report into Global() as they work. Open connections are always tracked.
+//! Everything else is only counted after Enable(true), and costs a relaxed load and a branch until then.
+//! Counters are sharded by thread so busy threads do not contend on the same cache line.
+class MetricsRegistry
+{
+public:
+    enum class Counter
+    {
+        TCP_CONNECTS,
+        TCP_ACCEPTS,
+        TCP_CLOSES,
+        TCP_BYTES_READ,
+        TCP_BYTES_WRITTEN,
+        UDP_DATAGRAMS_READ,
+        UDP_DATAGRAMS_WRITTEN,
+        UDP_BYTES_READ,
+        UDP_BYTES_WRITTEN,
+        COUNT
+    };
+
+    static constexpr size_t c_counterCount = static_cast<size_t>(Counter::COUNT);
+    static constexpr size_t c_shardCount = 16;
+
+    static MetricsRegistry& Global();
+
+    static bool Enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void Enable(bool enable) { s_enabled.store(enable, std::memory_order_relaxed); }
+
+    //! Adds to a counter of the global registry if metrics are enabled.
+    static void Count(Counter counter, uint64_t value = 1)
+    {
+        if (Enabled())
+            Global().Add(counter, value);
+    }
+    //! Counts a failed system call by its native error code if metrics are enabled.
+    static void CountError(int nativeErrorCode)
+    {
+        if (Enabled())
+            Global().AddError(nativeErrorCode);
+    }
+
+    MetricsRegistry(MetricsRegistry const&) = delete;
+    MetricsRegistry& operator=(MetricsRegistry const&) = delete;
+
+    void Add(Counter counter, uint64_t value = 1) noexcept;
+    void AddError(int nativeErrorCode);
+
+    uint64_t Get(Counter counter) const noexcept;
+    uint64_t OpenConnections() const noexcept;
+    std::map<int, uint64_t> GetErrors() const;
+
+    std::string RenderPrometheus() const;
+
+private:
+    MetricsRegistry() = default;
+
+    struct alignas(64) Shard
+    {
+        std::array<std::atomic<uint64_t>, c_counterCount> counters{};
+    };
+
+    static std::atomic<bool> s_enabled;
+
+    std::array<Shard, c_shardCount> m_shards;
+    mutable std::mutex m_errorLock;
+    std::map<int, uint64_t> m_errors;
+};
+
+}}  // namespace strapper::net
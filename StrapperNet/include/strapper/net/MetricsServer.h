@@ -0,0 +1,55 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <strapper/net/TcpListener.h>
+
+#include <cstdint>
+#include <thread>
+
+namespace strapper { namespace net {
+
+class ErrorCode;
+
+//! A tiny HTTP/1.1 server that serves MetricsRegistry::Global() at /metrics in the Prometheus text format.
+//! Clients are handled one at a time on a thread owned by the server, which is plenty for a scraper.
+//! Starting a server enables the registry.
+class MetricsServer
+{
+public:
+    explicit MetricsServer(uint16_t port, ErrorCode* ec = nullptr);
+    MetricsServer(MetricsServer const&) = delete;
+    MetricsServer(MetricsServer&&) = delete;
+    MetricsServer& operator=(MetricsServer const&) = delete;
+    MetricsServer& operator=(MetricsServer&&) = delete;
+    ~MetricsServer();
+
+    bool IsListening() const;
+    void Close() noexcept;
+
+    static constexpr size_t c_maxRequestLen = 8192;
+    static constexpr unsigned c_clientTimeoutMs = 1000;
+
+private:
+    void acceptLoop();
+    static void serve(TcpSocket& client);
+
+    TcpListener m_listener;
+    std::thread m_acceptor;
+};
+
+}}  // namespace strapper::net
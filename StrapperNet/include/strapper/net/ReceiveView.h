@@ -0,0 +1,32 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <cstddef>
+
+namespace strapper { namespace net {
+
+//! Bytes received by ReadView, read in place instead of being copied into a caller's buffer.
+//! Valid until the next ReadView on the same socket, or until the socket is closed.
+struct ReceiveView
+{
+    char const* data = nullptr;  //!< Null at end of stream.
+    size_t size = 0;             //!< Zero at end of stream.
+    bool mapped = false;         //!< Whether the bytes are kernel pages mapped with TCP_ZEROCOPY_RECEIVE rather than copied.
+};
+
+}}  // namespace strapper::net
@@ -0,0 +1,125 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <strapper/net/IpAddress.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace strapper { namespace net {
+
+class ErrorCode;
+class WorkerPool;
+
+struct ResolverStats
+{
+    uint64_t hits = 0;          // Answered from a cached address list.
+    uint64_t negativeHits = 0;  // Answered from a cached failure.
+    uint64_t misses = 0;        // Not cached, or expired.
+    uint64_t coalesced = 0;     // Misses that waited on a lookup already in flight instead of starting their own.
+    uint64_t evictions = 0;     // Unexpired entries dropped to stay within the size bound.
+};
+
+//! Resolves host names with an in-process cache in front of the system resolver.
+//! Successes and failures are cached for separate TTLs, the cache is bounded with LRU eviction, and concurrent
+//! misses on the same host share a single lookup. Numeric addresses are parsed directly and never cached.
+//! The system resolver does not report record TTLs, so the TTLs are configured rather than taken from DNS.
+class Resolver
+{
+public:
+    using Addresses = std::vector<IpAddress>;
+    //! Returns the addresses of a host in preference order. Throws on failure.
+    using LookupFunction = std::function<Addresses(std::string const& host)>;
+    using Callback = std::function<void(Addresses const& addresses, ErrorCode const& ec)>;
+
+    struct Options
+    {
+        std::chrono::milliseconds positiveTtl{ 30000 };  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        std::chrono::milliseconds negativeTtl{ 5000 };   // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        size_t maxEntries = 1024;                        // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        unsigned workerThreads = 2;                      // Threads for ResolveAsync. Started on first use.
+    };
+
+    //! The resolver used by TcpSocket.
+    static Resolver& Global();
+    //! Looks up a host with getaddrinfo. Throws SocketError with the getaddrinfo error code on failure.
+    static Addresses SystemLookup(std::string const& host);
+    //! Reorders addresses to alternate between families, keeping the first address first (RFC 8305 section 4).
+    static Addresses InterleaveFamilies(Addresses const& addresses);
+
+    Resolver();
+    explicit Resolver(Options options, LookupFunction lookup = SystemLookup);
+    Resolver(Resolver const&) = delete;
+    Resolver& operator=(Resolver const&) = delete;
+    ~Resolver();
+
+    //! Blocks until the host is resolved. The returned list is never empty.
+    Addresses Resolve(std::string const& host, ErrorCode* ec = nullptr);
+    //! Resolves on the worker pool. A cached answer completes the future immediately.
+    std::future<Addresses> ResolveAsync(std::string const& host);
+    //! Resolves on the worker pool and calls back from a worker thread. The callback must not throw.
+    //! A cached answer calls back on the calling thread before returning.
+    void ResolveAsync(std::string const& host, Callback callback);
+
+    void Clear();
+    size_t Size() const;
+    ResolverStats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Answer
+    {
+        Addresses addresses;
+        std::exception_ptr error;
+    };
+
+    struct Entry
+    {
+        Answer answer;
+        Clock::time_point expires;
+        std::list<std::string>::iterator lru;
+    };
+
+    bool tryNumeric(std::string const& host, Addresses* out_addresses) const;
+    bool tryCache(std::string const& host, Answer* out_answer);
+    Answer resolve(std::string const& host);
+    void store(std::string const& host, Answer const& answer);
+
+    Options const m_options;
+    LookupFunction const m_lookup;
+
+    mutable std::mutex m_cacheLock;
+    std::unordered_map<std::string, Entry> m_cache;
+    std::list<std::string> m_lru;  // Most recently used at the front.
+    std::unordered_map<std::string, std::shared_future<Answer>> m_inFlight;
+    ResolverStats m_stats;
+    std::unique_ptr<WorkerPool> m_pool;  // Declared last, so it is joined before the cache is torn down.
+};
+
+}}  // namespace strapper::net
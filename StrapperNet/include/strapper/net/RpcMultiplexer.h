@@ -0,0 +1,74 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <strapper/net/FramedConnection.h>
+#include <strapper/net/TcpSocket.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace strapper { namespace net {
+
+class ErrorCode;
+
+//! Lets many threads make calls over one connection at the same time.
+//! Each call is a FramedConnection frame whose sequence ID is the stream ID. The other side replies with the same ID,
+//! in any order. A reader thread owned by the multiplexer hands each response to the future of the matching call.
+//! Calls made while another thread is writing are queued and sent together in the next write.
+//! The multiplexer must not be destroyed on its own reader thread, since that thread still uses it after Close returns.
+class RpcMultiplexer
+{
+public:
+    explicit RpcMultiplexer(TcpSocket&& socket, uint32_t maxFrameLen = FramedConnection::c_maxFrameLen);
+    RpcMultiplexer(RpcMultiplexer const&) = delete;
+    RpcMultiplexer(RpcMultiplexer&&) = delete;
+    RpcMultiplexer& operator=(RpcMultiplexer const&) = delete;
+    RpcMultiplexer& operator=(RpcMultiplexer&&) = delete;
+    ~RpcMultiplexer();
+
+    bool IsOpen() const;
+    void Close() noexcept;
+
+    std::future<std::string> Call(std::string const& request, ErrorCode* ec = nullptr);
+
+    size_t Pending() const;
+
+private:
+    void flush();
+    void readLoop();
+    void fail(std::exception_ptr error) noexcept;
+
+    FramedConnection m_connection;
+
+    mutable std::mutex m_lock;
+    std::unordered_map<uint32_t, std::promise<std::string>> m_pending;
+    std::string m_outgoing;
+    bool m_flushing = false;
+    uint32_t m_nextStream = 0;
+    std::exception_ptr m_error;
+
+    std::thread m_reader;
+};
+
+}}  // namespace strapper::net
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <strapper/net/ErrorCode.h>
+#include <strapper/net/MetricsRegistry.h>
 
 #include <exception>
 #include <string>
@@ -50,7 +51,9 @@ public:
         : ProgramError(nativeErrorCode != 0 ? "SocketError: A socket API call returned " + ErrorCode::GetErrorName(nativeErrorCode) + "."
                                             : "SocketError: Unknown cause.")
         , m_nativeCode(nativeErrorCode)
-    { }
+    {
+        MetricsRegistry::CountError(nativeErrorCode);
+    }
 
     int NativeCode() const
     {
@@ -61,4 +64,17 @@ private:
     int m_nativeCode = 0;
 };
 
+//! Data failed an integrity check, such as a checksum mismatch. The connection itself may still be usable.
+class IntegrityError : public ProgramError
+{
+public:
+    IntegrityError()
+        : ProgramError("IntegrityError: Checksum mismatch.")
+    { }
+
+    explicit IntegrityError(std::string const& what)
+        : ProgramError("IntegrityError: " + what)
+    { }
+};
+
 }}  // namespace strapper::net
@@ -0,0 +1,70 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <chrono>
+
+namespace strapper { namespace net {
+
+//! A socket option value that may be left unset, in which case the system default is kept.
+template <typename T>
+class SocketOption
+{
+public:
+    SocketOption() = default;
+    SocketOption(T value)  // cppcheck-suppress[noExplicitConstructor] NOLINT: Intentional conversion constructor.
+        : m_set(true)
+        , m_value(value)
+    { }
+
+    bool IsSet() const { return m_set; }
+    T const& Get() const { return m_value; }
+    void Reset() { *this = SocketOption(); }
+
+private:
+    bool m_set = false;
+    T m_value{};
+};
+
+struct KeepAlive
+{
+    bool enable = true;
+    std::chrono::seconds idle{ 0 };      // Idle time before the first probe. Zero keeps the system default.
+    std::chrono::seconds interval{ 0 };  // Time between probes. Zero keeps the system default.
+    unsigned count = 0;                  // Unanswered probes before the connection is dropped. Zero keeps the system default.
+};
+
+//! Typed socket options. Only the fields that are set are applied.
+//! Options set on a TcpListener are inherited by the sockets it accepts, except quickAck.
+//! Buffer sizes should be set before connecting (see ConnectOptions) or on the listener, since the
+//! TCP window scale is fixed during the handshake.
+//! Options marked Linux only are rejected with a ProgramError on Windows.
+struct SocketOptions
+{
+    SocketOption<bool> noDelay;                             // TCP_NODELAY: Send small writes immediately instead of coalescing them.
+    SocketOption<bool> cork;                                // TCP_CORK: Hold partial frames until uncorked. Linux only.
+    SocketOption<bool> quickAck;                            // TCP_QUICKACK: Leave delayed-ACK mode. Not sticky, and not inherited. Linux only.
+    SocketOption<int> sendBufferSize;                       // SO_SNDBUF in bytes. Linux doubles the value for bookkeeping.
+    SocketOption<int> receiveBufferSize;                    // SO_RCVBUF in bytes. Linux doubles the value for bookkeeping.
+    SocketOption<KeepAlive> keepAlive;                      // SO_KEEPALIVE and its timers.
+    SocketOption<std::chrono::milliseconds> userTimeout;    // TCP_USER_TIMEOUT: Drop the connection when sent data stays unacknowledged this long.
+    SocketOption<int> notSentLowWatermark;                  // TCP_NOTSENT_LOWAT in bytes: Limit unsent data queued in the kernel. Linux only.
+    SocketOption<int> tos;                                  // IP_TOS, or IPV6_TCLASS for IPv6: DSCP and ECN bits. Linux only.
+    SocketOption<int> maxSegmentSize;                       // TCP_MAXSEG in bytes: Upper bound on the MSS. Set before connecting. Linux only.
+};
+
+}}  // namespace strapper::net
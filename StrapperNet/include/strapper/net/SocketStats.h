@@ -0,0 +1,109 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Per-socket I/O counters cost two clock reads and a few relaxed atomic adds per system call.
+// Build with STRAPPER_NET_SOCKET_STATS=0 (the CMake option of the same name) to compile them out.
+#ifndef STRAPPER_NET_SOCKET_STATS
+    #define STRAPPER_NET_SOCKET_STATS 1
+#endif
+
+namespace strapper { namespace net {
+
+//! A snapshot of one socket's I/O counters. All zero when the counters are compiled out.
+struct SocketStats
+{
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t readCalls = 0;         //!< Receive system calls, including ones that failed.
+    uint64_t writeCalls = 0;        //!< Send system calls, including ones that failed.
+    uint64_t interruptedCalls = 0;  //!< Calls retried because a signal interrupted them.
+    uint64_t partialReads = 0;      //!< TCP receives that returned less than asked for and had to be continued.
+    uint64_t partialWrites = 0;     //!< TCP sends that took less than given and had to be continued.
+    uint64_t readNanoseconds = 0;   //!< Time spent in receive calls, which is mostly time blocked waiting for data.
+    uint64_t writeNanoseconds = 0;  //!< Time spent in send calls, which includes time blocked on a full send buffer.
+};
+
+//! The live counters behind SocketStats, owned by the basic sockets.
+//! Updated with relaxed atomics so a monitoring thread can take a snapshot while the socket is in use.
+//! The fields of such a snapshot may be slightly out of step with each other.
+class SocketStatsCounters
+{
+public:
+#if STRAPPER_NET_SOCKET_STATS
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    static TimePoint Now() { return std::chrono::steady_clock::now(); }
+
+    void RecordRead(size_t bytes, TimePoint start)
+    {
+        add(m_readNanoseconds, elapsed(start));
+        add(m_bytesRead, bytes);
+        add(m_readCalls, 1);
+    }
+
+    void RecordWrite(size_t bytes, TimePoint start)
+    {
+        add(m_writeNanoseconds, elapsed(start));
+        add(m_bytesWritten, bytes);
+        add(m_writeCalls, 1);
+    }
+
+    void RecordInterrupted() { add(m_interruptedCalls, 1); }
+    void RecordPartialRead() { add(m_partialReads, 1); }
+    void RecordPartialWrite() { add(m_partialWrites, 1); }
+#else
+    struct TimePoint
+    { };
+
+    static TimePoint Now() { return {}; }
+
+    void RecordRead(size_t, TimePoint) { }
+    void RecordWrite(size_t, TimePoint) { }
+    void RecordInterrupted() { }
+    void RecordPartialRead() { }
+    void RecordPartialWrite() { }
+#endif
+
+    SocketStats Snapshot() const;
+
+private:
+#if STRAPPER_NET_SOCKET_STATS
+    static void add(std::atomic<uint64_t>& counter, uint64_t value) { counter.fetch_add(value, std::memory_order_relaxed); }
+    static uint64_t elapsed(TimePoint start)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Now() - start).count());
+    }
+
+    std::atomic<uint64_t> m_bytesRead{ 0 };
+    std::atomic<uint64_t> m_bytesWritten{ 0 };
+    std::atomic<uint64_t> m_readCalls{ 0 };
+    std::atomic<uint64_t> m_writeCalls{ 0 };
+    std::atomic<uint64_t> m_interruptedCalls{ 0 };
+    std::atomic<uint64_t> m_partialReads{ 0 };
+    std::atomic<uint64_t> m_partialWrites{ 0 };
+    std::atomic<uint64_t> m_readNanoseconds{ 0 };
+    std::atomic<uint64_t> m_writeNanoseconds{ 0 };
+#endif
+};
+
+}}  // namespace strapper::net
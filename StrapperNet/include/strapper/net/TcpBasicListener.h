@@ -17,6 +17,7 @@
 #pragma once
 
 #include <strapper/net/SocketHandle.h>
+#include <strapper/net/SocketOptions.h>
 #include <strapper/net/SystemContext.h>
 #include <strapper/net/TcpBasicSocket.h>
 
@@ -33,6 +34,7 @@ public:
 
     TcpBasicListener() = default;
     explicit TcpBasicListener(uint16_t port);
+    TcpBasicListener(uint16_t port, SocketOptions const& options);
     TcpBasicListener(TcpBasicListener const&) = delete;
     TcpBasicListener(TcpBasicListener&&) = default;
     TcpBasicListener& operator=(TcpBasicListener const&) = delete;
@@ -40,6 +42,9 @@ public:
     ~TcpBasicListener();
 
     bool IsListening() const;
+    void SetOptions(SocketOptions const& options);
+    SocketOptions GetOptions() const;
+    uint16_t LocalPort() const;
 
     void Close() noexcept;
     TcpBasicSocket Accept();
@@ -16,14 +16,20 @@
 
 #pragma once
 
+#include <strapper/net/ConnectOptions.h>
+#include <strapper/net/ReceiveView.h>
 #include <strapper/net/SocketHandle.h>
+#include <strapper/net/SocketStats.h>
+#include <strapper/net/TcpInfo.h>
 #include <strapper/net/SystemContext.h>
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace strapper { namespace net {
 
@@ -32,8 +38,29 @@ struct TcpBasicSocketImpl;
 class TcpBasicSocket
 {
 public:
+    //! How a WriteZeroCopy ended.
+    enum class ZeroCopyStatus
+    {
+        SENT,      // Sent from the buffer without copying.
+        COPIED,    // Copied after all (small write, fallback, or the kernel chose to copy).
+        CANCELLED  // The socket was closed first. The kernel may still send from the buffer, so changing it may change what the peer receives.
+    };
+
+    //! Called once the system no longer references a buffer passed to WriteZeroCopy, so it can be reused.
+    //! It must not use the socket or throw.
+    using ZeroCopyCallback = std::function<void(ZeroCopyStatus status)>;
+
+    //! Release callbacks that are due, handed out instead of called so the caller can call them without holding its locks.
+    using ZeroCopyReleases = std::vector<std::pair<ZeroCopyCallback, ZeroCopyStatus>>;
+
+    static size_t constexpr c_zeroCopyThreshold = 10 * 1024;    // Smaller writes are cheaper to copy than to pin.
+    static int constexpr c_zeroCopyLingerMilliseconds = 1000;  // How long Close waits for outstanding completions.
+    static size_t constexpr c_receiveMapBytes = 2 * 1024 * 1024;  // Address space ReadView maps received pages into.
+    static size_t constexpr c_receiveCopyBytes = 256 * 1024;      // Most ReadView copies at once when pages cannot be mapped.
+
     TcpBasicSocket();  // = default
     TcpBasicSocket(std::string const& host, uint16_t port);
+    TcpBasicSocket(std::string const& host, uint16_t port, ConnectOptions const& options);
     TcpBasicSocket(TcpBasicSocket const&) = delete;
     TcpBasicSocket(TcpBasicSocket&&) noexcept;  // = default
     TcpBasicSocket& operator=(TcpBasicSocket const&) = delete;
@@ -42,16 +69,32 @@ public:
 
     bool IsOpen() const;
     void SetReadTimeout(unsigned milliseconds);
+    void SetOptions(SocketOptions const& options);
+    SocketOptions GetOptions() const;
 
     void ShutdownSend();
     void ShutdownReceive();
     void ShutdownBoth() noexcept;
-    void Close() noexcept;
+    void Close(ZeroCopyReleases* out_released = nullptr) noexcept;
 
     void Write(void const* src, size_t len);
     bool Read(void* dest, size_t len);
+    ReceiveView ReadView(size_t maxLen);
+
+    size_t SendFile(int fd, uint64_t offset, size_t len, size_t* out_sent = nullptr);
+    size_t SpliceRead(size_t maxLen);
+    void SpliceWrite(TcpBasicSocket& dest);
+
+    void WriteZeroCopy(void const* src, size_t len, ZeroCopyCallback onRelease, ZeroCopyReleases* out_released = nullptr);
+    size_t PollZeroCopy(int timeoutMilliseconds, ZeroCopyReleases* out_released = nullptr);
+    bool ZeroCopyEnabled() const;
+    static void CallReleases(ZeroCopyReleases* released) noexcept;
 
     unsigned DataAvailable();
+    SocketStats GetStats() const;
+    TcpInfo GetTcpInfo() const;
+
+    static size_t WaitReadable(std::vector<TcpBasicSocket const*> const& sockets, std::vector<bool>* ready, int timeoutMilliseconds);
 
     explicit operator bool() const;
 
@@ -67,6 +110,7 @@ private:
     SystemContext m_context;
     SocketHandle m_socket;
     std::unique_ptr<TcpBasicSocketImpl> m_impl;
+    std::unique_ptr<SocketStatsCounters> m_stats;
 };
 
 }}  // namespace strapper::net
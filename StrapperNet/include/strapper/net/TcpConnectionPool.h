@@ -0,0 +1,105 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <strapper/net/ConnectOptions.h>
+#include <strapper/net/TcpSocket.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace strapper { namespace net {
+
+class ErrorCode;
+
+struct ConnectionPoolStats
+{
+    uint64_t reused = 0;     // Acquires answered with an idle connection.
+    uint64_t connected = 0;  // Acquires that made a new connection.
+    uint64_t stale = 0;      // Idle connections dropped by the health check.
+    uint64_t expired = 0;    // Idle connections dropped for exceeding maxIdleTime.
+    uint64_t overflow = 0;   // Released connections dropped to stay within maxIdlePerHost.
+};
+
+//! Keeps idle client connections per host:port so request/response traffic can skip the handshake.
+//! Acquire hands out the most recently released connection first, after checking that the peer has not
+//! closed it and that no unread data is waiting. Connections with leftover data are dropped, since a
+//! half-read response would corrupt the next request.
+//! Hosts are spread over independently locked shards, and health checks and closes happen outside the locks.
+class TcpConnectionPool
+{
+public:
+    struct Options
+    {
+        size_t maxIdlePerHost = 8;                         // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        std::chrono::milliseconds maxIdleTime{ 30000 };   // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        ConnectOptions connectOptions;
+    };
+
+    static constexpr size_t c_shardCount = 16;
+
+    TcpConnectionPool();
+    explicit TcpConnectionPool(Options const& options);
+    TcpConnectionPool(TcpConnectionPool const&) = delete;
+    TcpConnectionPool& operator=(TcpConnectionPool const&) = delete;
+
+    //! Returns a healthy idle connection to host:port, or connects a new one.
+    TcpSocket Acquire(std::string const& host, uint16_t port, ErrorCode* ec = nullptr);
+    //! Hands a connection back for reuse. Only release a connection with no request in flight.
+    //! Closed connections are dropped.
+    void Release(std::string const& host, uint16_t port, TcpSocket socket);
+
+    //! Closes idle connections that have exceeded maxIdleTime. Acquire and Release also do this for their host.
+    void EvictExpired();
+    void Clear();
+
+    size_t IdleCount() const;
+    size_t IdleCount(std::string const& host, uint16_t port) const;
+    ConnectionPoolStats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Idle
+    {
+        TcpSocket socket;
+        Clock::time_point released;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex lock;
+        std::unordered_map<std::string, std::deque<Idle>> idle;  // Oldest at the front.
+        ConnectionPoolStats stats;
+    };
+
+    static std::string key(std::string const& host, uint16_t port);
+    Shard& shard(std::string const& key);
+    Shard const& shard(std::string const& key) const;
+    void expire(Shard& shard, std::deque<Idle>& idle, Clock::time_point now, std::deque<Idle>* out_dropped) const;
+
+    Options const m_options;
+    std::array<Shard, c_shardCount> m_shards;
+};
+
+}}  // namespace strapper::net
@@ -0,0 +1,43 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <cstdint>
+
+namespace strapper { namespace net {
+
+//! Kernel-level diagnostics for one TCP connection, as reported by TCP_INFO.
+//! Fields the running kernel does not report are left at 0.
+struct TcpInfo
+{
+    uint32_t rttMicroseconds = 0;          //!< Smoothed round-trip time.
+    uint32_t rttVarianceMicroseconds = 0;  //!< Mean deviation of the round-trip time.
+    uint32_t sendMss = 0;                  //!< Maximum segment size for sending.
+    uint64_t congestionWindowBytes = 0;    //!< Congestion window, in bytes (segments times the send MSS).
+    uint32_t slowStartThreshold = 0;       //!< In segments. Very large until the first loss.
+    uint32_t unackedSegments = 0;          //!< Segments sent but not yet acknowledged.
+    uint32_t lostSegments = 0;             //!< Segments currently presumed lost.
+    uint32_t retransmits = 0;              //!< Consecutive retransmission timeouts without progress.
+    uint32_t totalRetransmits = 0;         //!< Segments retransmitted over the life of the connection.
+    uint32_t receiveSpaceBytes = 0;        //!< Receive buffer space the kernel is autotuning towards.
+    uint64_t pacingRate = 0;               //!< Bytes per second the kernel is pacing sends at.
+    uint64_t deliveryRate = 0;             //!< Most recent estimate of bytes per second delivered to the peer.
+    uint64_t bytesAcked = 0;               //!< Bytes sent and acknowledged by the peer.
+    uint64_t bytesReceived = 0;            //!< Bytes received from the peer.
+};
+
+}}  // namespace strapper::net
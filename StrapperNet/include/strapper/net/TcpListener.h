@@ -16,9 +16,11 @@
 
 #pragma once
 
+#include <strapper/net/LatencyHistogram.h>
 #include <strapper/net/TcpBasicListener.h>
 #include <strapper/net/TcpSocket.h>
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <utility>
@@ -32,6 +34,7 @@ class TcpListener
 public:
     TcpListener() = default;
     explicit TcpListener(uint16_t port, ErrorCode* ec = nullptr);
+    TcpListener(uint16_t port, SocketOptions const& options, ErrorCode* ec = nullptr);
     TcpListener(TcpListener const&) = delete;
     TcpListener(TcpListener&& other) noexcept;
     TcpListener& operator=(TcpListener const&) = delete;
@@ -41,10 +44,16 @@ public:
     friend void swap(TcpListener& left, TcpListener& right);
 
     bool IsListening() const;
+    void SetOptions(SocketOptions const& options, ErrorCode* ec = nullptr);
+    SocketOptions GetOptions(ErrorCode* ec = nullptr) const;
+    uint16_t LocalPort(ErrorCode* ec = nullptr) const;
 
     void Close() noexcept;
     TcpSocket Accept(ErrorCode* ec = nullptr);
 
+    SocketLatency GetLatencyHistograms() const;
+    void SetLatencyHistograms(SocketLatency latency, ErrorCode* ec = nullptr);
+
     explicit operator bool() const;
 
 private:
@@ -62,6 +71,8 @@ private:
     std::condition_variable m_acceptCancel;
     TcpBasicListener m_listener;
     State m_state = State::CLOSED;
+    SocketLatency m_latency;
+    std::atomic<bool> m_timed{ false };  // Whether any histogram is attached. Checked before taking the lock.
 };
 
 }}  // namespace strapper::net
@@ -18,21 +18,62 @@
 
 #include <strapper/net/TcpSocket.h>
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <iosfwd>
 #include <string>
+#include <vector>
 
 namespace strapper { namespace net {
 
 class TcpSerializer
 {
 public:
+    //! Default limit for strings sent or received with Write/Read. Can be changed per instance.
     static constexpr int c_maxStringLen = 1024 * 1024;
+    //! Streams are never held in memory, so they are only limited by the size of the length prefix.
+    static constexpr int c_maxStreamLen = 0x7FFFFFFF;
+    //! Streams are transferred through a buffer of this size.
+    static constexpr size_t c_streamChunkSize = 64 * 1024;
+    //! With compression enabled, strings shorter than this are sent as-is by default.
+    static constexpr size_t c_defaultCompressionThreshold = 256;
 
-    explicit TcpSerializer(TcpSocket&& socket);
+    //! Fills dest with up to maxlen bytes. Returns the number of bytes written to dest.
+    using StreamSource = std::function<size_t(char* dest, size_t maxlen)>;
+    //! Consumes len bytes from src.
+    using StreamSink = std::function<void(char const* src, size_t len)>;
+
+    //! Counters for strings sent and received with compression enabled.
+    struct CompressionStats
+    {
+        uint64_t framesCompressed = 0;    //!< Strings written compressed.
+        uint64_t framesStored = 0;        //!< Strings written as-is because they were small or didn't compress.
+        uint64_t framesDecompressed = 0;  //!< Compressed strings read.
+        uint64_t bytesIn = 0;             //!< Length of all strings written.
+        uint64_t bytesOut = 0;            //!< Payload bytes of all strings written, after compression.
+        uint64_t compressNanoseconds = 0;
+        uint64_t decompressNanoseconds = 0;
+
+        //! bytesIn / bytesOut, or 1 if nothing has been written.
+        double Ratio() const;
+    };
+
+    explicit TcpSerializer(TcpSocket&& socket, int maxStringLen = c_maxStringLen);
 
     TcpSocket const& Socket() const;
     TcpSocket& Socket();
 
+    int MaxStringLength() const;
+    void SetMaxStringLength(int maxStringLen);
+
+    bool ChecksumsEnabled() const;
+    void EnableChecksums(bool enable);
+
+    bool CompressionEnabled() const;
+    void EnableCompression(bool enable, size_t threshold = c_defaultCompressionThreshold);
+    CompressionStats const& GetCompressionStats() const;
+
     void Write(char c, ErrorCode* ec = nullptr);
     void Write(bool b, ErrorCode* ec = nullptr);
     void Write(int32_t int32, ErrorCode* ec = nullptr);
@@ -45,8 +86,28 @@ public:
     bool Read(double* dest, ErrorCode* ec = nullptr);
     bool Read(std::string* dest, ErrorCode* ec = nullptr);
 
+    void WriteStream(size_t len, StreamSource const& source, ErrorCode* ec = nullptr);
+    void WriteStream(std::istream& in, size_t len, ErrorCode* ec = nullptr);
+    bool ReadStream(StreamSink const& sink, ErrorCode* ec = nullptr);
+    bool ReadStream(std::ostream& out, ErrorCode* ec = nullptr);
+
 private:
+    void writeValue(void const* src, size_t len, ErrorCode* ec);
+    bool readValue(void* dest, size_t len, ErrorCode* ec);
+    void writeFrame(void const* prefix, size_t prefixLen, void const* payload, size_t payloadLen);
+    void readTrailer(uint32_t crc);
+    void writeCompressed(std::string const& s);
+    bool readCompressed(int32_t header, std::string* dest);
+    bool readCompressedBody(int32_t header, uint32_t crc, std::string* dest);
+
     TcpSocket m_socket;
+    int m_maxStringLen = c_maxStringLen;
+    bool m_checksums = false;
+    bool m_compression = false;
+    size_t m_compressionThreshold = c_defaultCompressionThreshold;
+    CompressionStats m_compressionStats;
+    std::vector<char> m_compressionBuffer;
+    std::vector<char> m_writeBuffer;
 };
 
 }}  // namespace strapper::net
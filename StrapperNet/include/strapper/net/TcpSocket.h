@@ -16,12 +16,17 @@
 
 #pragma once
 
+#include <strapper/net/LatencyHistogram.h>
 #include <strapper/net/TcpBasicSocket.h>
 
+#include <atomic>
 #include <condition_variable>
+#include <functional>
+#include <future>
 #include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace strapper { namespace net {
 
@@ -30,8 +35,16 @@ class ErrorCode;
 class TcpSocket
 {
 public:
+    using ConnectCallback = std::function<void(TcpSocket socket, ErrorCode const& ec)>;
+    using ZeroCopyStatus = TcpBasicSocket::ZeroCopyStatus;
+    using ZeroCopyCallback = TcpBasicSocket::ZeroCopyCallback;
+
+    static constexpr unsigned c_connectThreads = 4;                      // Threads shared by every ConnectAsync.
+    static constexpr unsigned c_connectAsyncTimeoutMilliseconds = 10000;  // Used when the options leave the timeout at zero.
+
     TcpSocket() = default;
     TcpSocket(std::string const& host, uint16_t port, ErrorCode* ec = nullptr);
+    TcpSocket(std::string const& host, uint16_t port, ConnectOptions const& options, ErrorCode* ec = nullptr);
     TcpSocket(TcpSocket const&) = delete;
     TcpSocket(TcpSocket&& other) noexcept;
     TcpSocket& operator=(TcpSocket const&) = delete;
@@ -40,8 +53,13 @@ public:
 
     friend void swap(TcpSocket& left, TcpSocket& right);
 
+    static std::future<TcpSocket> ConnectAsync(std::string const& host, uint16_t port, ConnectOptions const& options = ConnectOptions());
+    static void ConnectAsync(std::string const& host, uint16_t port, ConnectOptions const& options, ConnectCallback callback);
+
     bool IsOpen() const;
     void SetReadTimeout(unsigned milliseconds, ErrorCode* ec = nullptr);
+    void SetOptions(SocketOptions const& options, ErrorCode* ec = nullptr);
+    SocketOptions GetOptions(ErrorCode* ec = nullptr) const;
 
     void ShutdownSend(ErrorCode* ec = nullptr);
     void ShutdownBoth();
@@ -49,8 +67,22 @@ public:
 
     void Write(void const* src, size_t len, ErrorCode* ec = nullptr);
     bool Read(void* dest, size_t len, ErrorCode* ec = nullptr);
+    ReceiveView ReadView(size_t maxLen, ErrorCode* ec = nullptr);
+
+    size_t SendFile(int fd, uint64_t offset, size_t len, ErrorCode* ec = nullptr);
+    size_t SpliceTo(TcpSocket& dest, size_t len, ErrorCode* ec = nullptr);
+
+    void WriteZeroCopy(void const* src, size_t len, ZeroCopyCallback onRelease, ErrorCode* ec = nullptr);
+    size_t PollZeroCopy(int timeoutMilliseconds, ErrorCode* ec = nullptr);
+    bool ZeroCopyEnabled() const;
 
     unsigned DataAvailable(ErrorCode* ec = nullptr);
+    SocketStats GetStats() const;
+    TcpInfo GetTcpInfo(ErrorCode* ec = nullptr) const;
+    SocketLatency GetLatencyHistograms() const;
+    void SetLatencyHistograms(SocketLatency latency, ErrorCode* ec = nullptr);
+
+    static size_t WaitReadable(std::vector<TcpSocket*> const& sockets, std::vector<bool>* ready, int timeoutMilliseconds, ErrorCode* ec = nullptr);
 
     explicit operator bool() const;
 
@@ -74,9 +106,12 @@ private:
     bool read(void* dest, size_t len);
 
     mutable std::mutex m_socketLock;
+    mutable std::mutex m_swapLock;  // Held only while m_socket is swapped, so monitoring calls don't wait behind blocking I/O.
     std::condition_variable m_readCancel;
     TcpBasicSocket m_socket;
     State m_state = State::CLOSED;
+    SocketLatency m_latency;
+    std::atomic<bool> m_timed{ false };  // Whether any histogram is attached. Checked before taking the lock.
 };
 
 }}  // namespace strapper::net
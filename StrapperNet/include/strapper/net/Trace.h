@@ -0,0 +1,91 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace strapper { namespace net {
+
+enum class TraceEvent : uint16_t
+{
+    TCP_CONNECT = 1,
+    TCP_ACCEPT,
+    TCP_READ_START,
+    TCP_READ_END,
+    TCP_WRITE_START,
+    TCP_WRITE_END,
+    TCP_CLOSE,
+    UDP_BIND,
+    UDP_READ_START,
+    UDP_READ_END,
+    UDP_WRITE_START,
+    UDP_WRITE_END,
+    UDP_CLOSE
+};
+
+//! One fixed-size trace record, stored and dumped in host byte order.
+struct TraceRecord
+{
+    uint64_t nanoseconds;  //!< Steady clock time.
+    int64_t socket;        //!< Native socket handle. Handles are reused, so a CLOSE event ends one socket's timeline.
+    int64_t value;         //!< Length asked for by a *_START, system call result for an *_END, port for CONNECT and BIND.
+    uint32_t thread;       //!< Small number given to each thread in the order it first records.
+    uint16_t event;        //!< A TraceEvent.
+    uint16_t reserved;
+};
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord is written to files as is.");
+
+//! A binary trace of every socket system call, for nanosecond-resolution timelines of connection behavior.
+//! Each thread records into its own fixed-size ring, which overwrites its oldest records when full.
+//! Recording is lock-free and allocation-free, apart from creating the ring on a thread's first record.
+//! Costs a relaxed load and a branch while disabled, which is the default.
+//! Dump writes the rings to a file that Read, WriteChromeJson and the TraceDecoder tool understand.
+class Trace
+{
+public:
+    static constexpr size_t c_defaultRingRecords = 16384;  // 512 KiB per thread.
+    static constexpr char c_magic[8] = { 'S', 'N', 'T', 'R', 'A', 'C', 'E', '1' };
+
+    static bool Enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void Enable(bool enable) { s_enabled.store(enable, std::memory_order_relaxed); }
+    static void SetRingRecords(size_t records);
+
+    static void Record(TraceEvent event, int64_t socket, int64_t value)
+    {
+        if (Enabled())
+            record(event, socket, value);
+    }
+
+    static size_t Dump(std::ostream& out);
+    static size_t Dump(std::string const& path);
+    static void Clear();
+
+    static std::vector<TraceRecord> Read(std::istream& in);
+    static void WriteChromeJson(std::vector<TraceRecord> records, std::ostream& out);
+
+private:
+    static void record(TraceEvent event, int64_t socket, int64_t value) noexcept;
+
+    static std::atomic<bool> s_enabled;
+};
+
+}}  // namespace strapper::net
@@ -18,10 +18,13 @@
 
 #include <strapper/net/IpAddress.h>
 #include <strapper/net/SocketHandle.h>
+#include <strapper/net/SocketOptions.h>
+#include <strapper/net/SocketStats.h>
 #include <strapper/net/SystemContext.h>
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 
 namespace strapper { namespace net {
 
@@ -38,20 +41,27 @@ public:
 
     bool IsOpen() const;
     void SetReadTimeout(unsigned milliseconds);
+    void SetOptions(SocketOptions const& options);
+    SocketOptions GetOptions() const;
 
     void Shutdown() noexcept;
     void Close() noexcept;
 
-    void Write(void const* src, size_t len, IpAddressV4 const& ipAddress, uint16_t port);
-    unsigned Read(void* dest, size_t maxlen, IpAddressV4* out_ipAddress, uint16_t* out_port);
+    //! IPv4 destinations are reached through the dual-stack socket as IPv4-mapped addresses.
+    void Write(void const* src, size_t len, IpAddress const& ipAddress, uint16_t port);
+    //! IPv4 senders are reported as IPv4 addresses.
+    unsigned Read(void* dest, size_t maxlen, IpAddress* out_ipAddress, uint16_t* out_port);
 
     unsigned DataAvailable() const;
+    SocketStats GetStats() const;
 
     explicit operator bool() const;
 
 private:
     SystemContext m_context;
+    int m_family = 0;  // AF_INET6 when dual-stack, AF_INET on hosts without IPv6. Filled in by m_socket's initializer.
     SocketHandle m_socket;
+    std::unique_ptr<SocketStatsCounters> m_stats;
 };
 
 }}  // namespace strapper::net
@@ -16,11 +16,15 @@
 
 #pragma once
 
+#include <strapper/net/LatencyHistogram.h>
 #include <strapper/net/UdpBasicSocket.h>
 
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 namespace strapper { namespace net {
 
@@ -41,13 +45,23 @@ public:
 
     bool IsOpen() const;
     void SetReadTimeout(unsigned milliseconds, ErrorCode* ec = nullptr);
+    void SetOptions(SocketOptions const& options, ErrorCode* ec = nullptr);
+    SocketOptions GetOptions(ErrorCode* ec = nullptr) const;
+
+    bool ChecksumsEnabled() const;
+    void EnableChecksums(bool enable);
 
     void Close() noexcept;
 
-    void Write(void const* src, size_t len, IpAddressV4 const& ipAddress, uint16_t port, ErrorCode* ec = nullptr);
+    void Write(void const* src, size_t len, IpAddress const& ipAddress, uint16_t port, ErrorCode* ec = nullptr);
+    unsigned Read(void* dest, size_t maxlen, IpAddress* out_ipAddress, uint16_t* out_port, ErrorCode* ec = nullptr);
     unsigned Read(void* dest, size_t maxlen, IpAddressV4* out_ipAddress, uint16_t* out_port, ErrorCode* ec = nullptr);
+    unsigned Read(void* dest, size_t maxlen, std::nullptr_t, uint16_t* out_port, ErrorCode* ec = nullptr);
 
     unsigned DataAvailable(ErrorCode* ec = nullptr) const;
+    SocketStats GetStats() const;
+    SocketLatency GetLatencyHistograms() const;
+    void SetLatencyHistograms(SocketLatency latency, ErrorCode* ec = nullptr);
 
     explicit operator bool() const;
 
@@ -60,12 +74,16 @@ private:
         CLOSED
     };
 
-    unsigned read(void* dest, size_t maxlen, IpAddressV4* out_ipAddress, uint16_t* out_port);
+    unsigned read(void* dest, size_t maxlen, IpAddress* out_ipAddress, uint16_t* out_port);
 
     mutable std::mutex m_socketLock;
     std::condition_variable m_readCancel;
     UdpBasicSocket m_socket;
     State m_state = State::CLOSED;
+    bool m_checksums = false;
+    std::vector<char> m_writeBuffer;
+    SocketLatency m_latency;
+    std::atomic<bool> m_timed{ false };  // Whether any histogram is attached. Checked before taking the lock.
 };
 
 }}  // namespace strapper::net
@@ -0,0 +1,167 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <strapper/net/Crc32c.h>
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define STRAPPER_CRC32C_X86
+    #include <nmmintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#endif
+
+#if defined(STRAPPER_CRC32C_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define STRAPPER_TARGET_SSE42 __attribute__((target("sse4.2")))
+#else
+    #define STRAPPER_TARGET_SSE42
+#endif
+
+namespace strapper { namespace net {
+
+namespace {
+
+uint32_t constexpr c_polynomial = 0x82F63B78;  // Reflected Castagnoli polynomial.
+
+using SliceTables = std::array<std::array<uint32_t, 256>, 8>;
+
+SliceTables MakeTables()
+{
+    SliceTables tables{};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? (crc >> 1) ^ c_polynomial : crc >> 1;
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        for (size_t slice = 1; slice < tables.size(); ++slice)
+        {
+            uint32_t const prev = tables[slice - 1][i];
+            tables[slice][i] = (prev >> 8) ^ tables[0][prev & 0xFF];
+        }
+    }
+    return tables;
+}
+
+SliceTables const& Tables()
+{
+    static SliceTables const tables = MakeTables();
+    return tables;
+}
+
+//! Works on the raw (non-inverted) register value.
+uint32_t Portable(unsigned char const* p, size_t len, uint32_t crc)
+{
+    SliceTables const& t = Tables();
+    while (len >= 8)
+    {
+        uint32_t lo = 0;
+        uint32_t hi = 0;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= crc;  // Assumes little endian, as do all the platforms this library supports.
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+              ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0)
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+#ifdef STRAPPER_CRC32C_X86
+
+bool DetectSse42()
+{
+    #ifdef _MSC_VER
+    int info[4] = {};
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+    #else
+    return __builtin_cpu_supports("sse4.2");
+    #endif
+}
+
+//! Works on the raw (non-inverted) register value.
+STRAPPER_TARGET_SSE42 uint32_t Hardware(unsigned char const* p, size_t len, uint32_t crc)
+{
+    // Bring the pointer to 8-byte alignment so the main loop does aligned loads.
+    while (len > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    {
+        crc = _mm_crc32_u8(crc, *p++);
+        --len;
+    }
+    #if defined(__x86_64__) || defined(_M_X64)
+    uint64_t crc64 = crc;
+    while (len >= 8)
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, p, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+        len -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+    #endif
+    while (len >= 4)
+    {
+        uint32_t word = 0;
+        std::memcpy(&word, p, 4);
+        crc = _mm_crc32_u32(crc, word);
+        p += 4;
+        len -= 4;
+    }
+    while (len-- > 0)
+        crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+#endif
+
+}  // namespace
+
+uint32_t Crc32c(void const* data, size_t len, uint32_t crc /* = 0 */)
+{
+#ifdef STRAPPER_CRC32C_X86
+    if (Crc32cIsHardwareAccelerated())
+        return ~Hardware(static_cast<unsigned char const*>(data), len, ~crc);
+#endif
+    return ~Portable(static_cast<unsigned char const*>(data), len, ~crc);
+}
+
+uint32_t Crc32cPortable(void const* data, size_t len, uint32_t crc /* = 0 */)
+{
+    return ~Portable(static_cast<unsigned char const*>(data), len, ~crc);
+}
+
+bool Crc32cIsHardwareAccelerated()
+{
+#ifdef STRAPPER_CRC32C_X86
+    static bool const supported = DetectSse42();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+}}  // namespace strapper::net
@@ -0,0 +1,272 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <strapper/net/FramedConnection.h>
+
+#include <strapper/net/Endian.h>
+#include <strapper/net/SocketError.h>
+
+#include <utility>
+
+namespace strapper { namespace net {
+
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t FramedConnection::c_headerLen;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr uint32_t FramedConnection::c_maxFrameLen;
+
+FramedConnection::FramedConnection(TcpSocket&& socket, uint32_t maxFrameLen /* = c_maxFrameLen */)
+    : m_socket(std::move(socket))
+    , m_maxFrameLen(maxFrameLen)
+{ }
+
+TcpSocket const& FramedConnection::Socket() const
+{
+    return m_socket;
+}
+
+TcpSocket& FramedConnection::Socket()
+{
+    return m_socket;
+}
+
+//! Appends a frame to dest without sending it. Lets callers batch many frames into one write.
+void FramedConnection::Encode(uint32_t sequence, std::string const& payload, std::string* dest) const
+{
+    if (!dest)
+        throw ProgramError("Null pointer.");
+    if (payload.length() > m_maxFrameLen)
+        throw ProgramError("Frame length exceeds max allowed.");
+
+    uint32_t const header[2] = { nton(sequence), nton(static_cast<uint32_t>(payload.length())) };
+    static_assert(sizeof(header) == c_headerLen, "Unexpected header size.");
+
+    dest->append(reinterpret_cast<char const*>(header), c_headerLen);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    dest->append(payload);
+}
+
+//! Sends a frame with the given sequence ID. Use this to reply to a request.
+void FramedConnection::Send(uint32_t sequence, std::string const& payload, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_writeLock);
+        send(sequence, payload);
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+}
+
+//! Reads the next frame in the order it arrived, without matching it to a request. Use this to receive requests.
+//! @return False if the other side gracefully closed the connection.
+bool FramedConnection::Receive(Frame* dest, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        if (!dest)
+            throw ProgramError("Null pointer.");
+        std::lock_guard<std::mutex> lock(m_readLock);
+        return receive(dest);
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return false;
+    }
+}
+
+//! Sends a request with the next sequence ID. Does not wait for the response.
+//! @return The sequence ID to pass to ReadResponse.
+uint32_t FramedConnection::SendRequest(std::string const& payload, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_writeLock);
+        uint32_t const sequence = m_nextSequence++;
+        {
+            // Register before sending so a fast response on the reading thread is recognized.
+            std::lock_guard<std::mutex> requestLock(m_requestLock);
+            if (!m_outstanding.insert(sequence).second)
+                throw ProgramError("Too many outstanding requests.");
+        }
+
+        try
+        {
+            send(sequence, payload);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> requestLock(m_requestLock);
+            m_outstanding.erase(sequence);
+            throw;
+        }
+        return sequence;
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return 0;
+    }
+}
+
+//! Blocks until the response to the given request arrives.
+//! Responses to other outstanding requests that arrive first are held until they are asked for.
+//! @return False if the other side gracefully closed the connection.
+bool FramedConnection::ReadResponse(uint32_t sequence, std::string* dest, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        if (!dest)
+            throw ProgramError("Null pointer.");
+
+        std::lock_guard<std::mutex> lock(m_readLock);
+        {
+            std::lock_guard<std::mutex> requestLock(m_requestLock);
+            if (m_outstanding.count(sequence) == 0)
+                throw ProgramError("No request is outstanding with that sequence ID.");
+        }
+        if (takeArrived(sequence, dest))
+            return true;
+
+        Frame frame;
+        while (true)
+        {
+            if (!receive(&frame))
+                return false;
+
+            std::lock_guard<std::mutex> requestLock(m_requestLock);
+            if (m_outstanding.count(frame.sequence) == 0 || m_arrived.count(frame.sequence) != 0)
+                throw ProgramError("Received a response to an unknown request.");
+            if (frame.sequence == sequence)
+            {
+                m_outstanding.erase(sequence);
+                *dest = std::move(frame.payload);
+                return true;
+            }
+            m_arrived.emplace(frame.sequence, std::move(frame.payload));
+        }
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return false;
+    }
+}
+
+//! Returns whichever response is available first, regardless of the order the requests were sent.
+//! @return False if the other side gracefully closed the connection.
+bool FramedConnection::ReadNextResponse(Frame* dest, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        if (!dest)
+            throw ProgramError("Null pointer.");
+
+        std::lock_guard<std::mutex> lock(m_readLock);
+        {
+            std::lock_guard<std::mutex> requestLock(m_requestLock);
+            if (m_outstanding.empty())
+                throw ProgramError("No requests are outstanding.");
+            if (!m_arrived.empty())
+            {
+                auto const iter = m_arrived.begin();
+                dest->sequence = iter->first;
+                dest->payload = std::move(iter->second);
+                m_outstanding.erase(iter->first);
+                m_arrived.erase(iter);
+                return true;
+            }
+        }
+
+        if (!receive(dest))
+            return false;
+
+        std::lock_guard<std::mutex> requestLock(m_requestLock);
+        if (m_outstanding.erase(dest->sequence) == 0)
+            throw ProgramError("Received a response to an unknown request.");
+        return true;
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return false;
+    }
+}
+
+//! @return The number of requests whose responses have not been read yet.
+size_t FramedConnection::Outstanding() const
+{
+    std::lock_guard<std::mutex> lock(m_requestLock);
+    return m_outstanding.size();
+}
+
+//! The header and payload are sent with one call so that a pipelined request isn't split across segments.
+//! Must be called with the write lock.
+void FramedConnection::send(uint32_t sequence, std::string const& payload)
+{
+    m_writeBuffer.clear();
+    Encode(sequence, payload, &m_writeBuffer);
+    m_socket.Write(m_writeBuffer.data(), m_writeBuffer.length());
+}
+
+//! Must be called with the read lock.
+bool FramedConnection::receive(Frame* dest)
+{
+    uint32_t header[2] = {};
+    if (!m_socket.Read(header, c_headerLen))
+        return false;
+
+    uint32_t const len = nton(header[1]);
+    if (len > m_maxFrameLen)
+    {
+        // Other end is corrupted or is not following the protocol. There is no way to find the next frame.
+        m_socket.Close();
+        throw ProgramError("Received bad frame size.");
+    }
+
+    dest->sequence = nton(header[0]);
+    dest->payload.resize(len);
+    if (len > 0 && !m_socket.Read(&dest->payload[0], len))
+        throw ProgramError("Other side closed before all bytes were received.");
+    return true;
+}
+
+//! Must be called with the read lock.
+bool FramedConnection::takeArrived(uint32_t sequence, std::string* dest)
+{
+    std::lock_guard<std::mutex> requestLock(m_requestLock);
+    auto const iter = m_arrived.find(sequence);
+    if (iter == m_arrived.end())
+        return false;
+    *dest = std::move(iter->second);
+    m_arrived.erase(iter);
+    m_outstanding.erase(sequence);
+    return true;
+}
+
+}}  // namespace strapper::net
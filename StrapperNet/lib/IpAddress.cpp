@@ -19,47 +19,168 @@
 #include <strapper/net/SocketError.h>
 
 #include <cstring>
-#include <limits>
-#include <regex>
-#include <sstream>
 
 namespace strapper { namespace net {
 
-IpAddressV4 const IpAddressV4::Any{};
-IpAddressV4 const IpAddressV4::Loopback{ "127.0.0.1" };
+namespace {
 
-IpAddressV4::IpAddressV4(std::string const& ip)
+// The parsers are hand-written rather than regex-based. Addresses are parsed on hot paths (e.g. per-datagram
+// endpoints), and std::regex costs on the order of 100 microseconds per call.
+
+bool IsDigit(char c)
 {
-    std::string const errorMsg = "Not a valid IPv4 address: '" + ip + "'";
-    if (!std::regex_match(ip, std::regex(R"(^(\d{1,3}[:\.]){3}\d{1,3}$)")))
-        throw ProgramError(errorMsg);
+    return c >= '0' && c <= '9';
+}
 
-    std::regex const r(R"(\d{1,3}(:|.|$))");
-    auto iter = std::sregex_iterator(ip.cbegin(), ip.cend(), r);
-    auto end = std::sregex_iterator();
+int HexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    return -1;
+}
 
-    std::array<uint8_t, 4> array{};
+// Parses four decimal octets of 1 to 3 digits. Each delimiter may be '.', or ':' if allowColon is set.
+bool ParseV4(char const* s, size_t len, bool allowColon, std::array<uint8_t, 4>* out)
+{
+    size_t i = 0;
+    for (size_t octet = 0; octet < 4; ++octet)
+    {
+        if (octet > 0)
+        {
+            if (i == len || !(s[i] == '.' || (allowColon && s[i] == ':')))
+                return false;
+            ++i;
+        }
+        unsigned val = 0;
+        size_t const begin = i;
+        while (i < len && IsDigit(s[i]) && i - begin < 3)
+            val = val * 10 + static_cast<unsigned>(s[i++] - '0');  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        if (i == begin || val > 255)  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+            return false;
+        (*out)[octet] = static_cast<uint8_t>(val);
+    }
+    return i == len;
+}
 
-    for (auto& e : array)
+// Parses RFC 4291 text: eight groups of 1 to 4 hex digits, at most one "::", and an optional dotted IPv4 tail.
+bool ParseV6(char const* s, size_t len, std::array<uint8_t, 16>* out)
+{
+    std::array<uint16_t, 8> groups{};
+    size_t count = 0;
+    size_t gap = groups.size();  // Index of the "::", if any.
+    size_t i = 0;
+
+    if (len >= 2 && s[0] == ':' && s[1] == ':')
     {
-        if (iter == end)
-            throw ProgramError(errorMsg);
-        unsigned long ul = 0;  // NOLINT: Matches return from stoul.
-        try
+        gap = 0;
+        i = 2;
+    }
+    else if (len > 0 && s[0] == ':')
+        return false;
+
+    while (i < len)
+    {
+        if (count == groups.size())
+            return false;
+
+        size_t end = i;
+        while (end < len && HexValue(s[end]) >= 0)
+            ++end;
+
+        if (end < len && s[end] == '.')
+        {
+            // The dotted IPv4 tail fills the last two groups.
+            std::array<uint8_t, 4> v4{};
+            if (count + 2 > groups.size() || !ParseV4(s + i, len - i, false, &v4))
+                return false;
+            groups[count++] = static_cast<uint16_t>((v4[0] << 8) | v4[1]);  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+            groups[count++] = static_cast<uint16_t>((v4[2] << 8) | v4[3]);  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+            i = len;
+            break;
+        }
+
+        if (end == i || end - i > 4)
+            return false;
+        unsigned val = 0;
+        for (; i < end; ++i)
+            val = (val << 4) | static_cast<unsigned>(HexValue(s[i]));
+        groups[count++] = static_cast<uint16_t>(val);
+
+        if (i == len)
+            break;
+        if (s[i] != ':')
+            return false;
+        if (++i == len)
+            return false;  // A single trailing colon.
+        if (s[i] == ':')
         {
-            ul = std::stoul((iter++)->str());
+            if (gap != groups.size() || count == groups.size())
+                return false;  // A second "::", or one after eight groups, where it would stand for no groups.
+            gap = count;
+            ++i;
         }
-        catch (std::logic_error const&)
+    }
+
+    if (gap == groups.size() ? count != groups.size() : count == groups.size())
+        return false;
+
+    // Expand the "::" by shifting the groups after it to the end.
+    if (gap != groups.size())
+    {
+        size_t const shift = groups.size() - count;
+        for (size_t g = count; g-- > gap;)
         {
-            throw ProgramError(errorMsg);
+            groups[g + shift] = groups[g];
+            groups[g] = 0;
         }
+    }
+
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        (*out)[2 * g] = static_cast<uint8_t>(groups[g] >> 8);  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        (*out)[2 * g + 1] = static_cast<uint8_t>(groups[g]);
+    }
+    return true;
+}
 
-        if (ul > std::numeric_limits<uint8_t>::max())
-            throw ProgramError(errorMsg);
+// Writes the decimal digits of an octet. Returns the number of characters written.
+size_t FormatOctet(uint8_t val, char* out)
+{
+    size_t n = 0;
+    if (val >= 100)  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        out[n++] = static_cast<char>('0' + val / 100);  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    if (val >= 10)  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        out[n++] = static_cast<char>('0' + val / 10 % 10);  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    out[n++] = static_cast<char>('0' + val % 10);  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    return n;
+}
 
-        e = static_cast<uint8_t>(ul);  // Big endian.
+size_t FormatV4(std::array<uint8_t, 4> const& array, char delim, char* out)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < array.size(); ++i)
+    {
+        if (i > 0)
+            out[n++] = delim;
+        n += FormatOctet(array[i], out + n);
     }
+    return n;
+}
+
+}  // namespace
+
+IpAddressV4 const IpAddressV4::Any{};
+IpAddressV4 const IpAddressV4::Loopback{ "127.0.0.1" };
 
+IpAddressV4::IpAddressV4(std::string const& ip)
+{
+    std::array<uint8_t, 4> array{};  // Big endian.
+    if (!ParseV4(ip.data(), ip.size(), true, &array))
+        throw ProgramError("Not a valid IPv4 address: '" + ip + "'");
     std::memcpy(&m_val, array.data(), 4);
 }
 
@@ -69,13 +190,9 @@ IpAddressV4::IpAddressV4(uint32_t val)
 
 std::string IpAddressV4::ToString(char delim /* = ':' */) const
 {
-    std::stringstream s;
-    auto const array = ToArray();
-    s << std::to_string(array[0]) << delim
-      << std::to_string(array[1]) << delim
-      << std::to_string(array[2]) << delim
-      << std::to_string(array[3]);
-    return s.str();
+    std::array<char, 16> buf{};  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    size_t const len = FormatV4(ToArray(), delim, buf.data());
+    return std::string(buf.data(), len);
 }
 
 std::array<uint8_t, 4> IpAddressV4::ToArray() const
@@ -100,4 +217,204 @@ bool IpAddressV4::operator!=(IpAddressV4 const& other) const
     return !(*this == other);
 }
 
+IpAddressV6 const IpAddressV6::Any{};
+IpAddressV6 const IpAddressV6::Loopback{ "::1" };
+
+IpAddressV6::IpAddressV6(std::string const& ip)
+{
+    if (!ParseV6(ip.data(), ip.size(), &m_bytes))
+        throw ProgramError("Not a valid IPv6 address: '" + ip + "'");
+}
+
+IpAddressV6::IpAddressV6(std::array<uint8_t, 16> const& bytes)
+    : m_bytes(bytes)
+{ }
+
+IpAddressV6 IpAddressV6::MapV4(IpAddressV4 const& ip)
+{
+    std::array<uint8_t, 16> bytes{};
+    bytes[10] = 0xff;  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    bytes[11] = 0xff;  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    auto const v4 = ip.ToArray();
+    std::memcpy(bytes.data() + 12, v4.data(), v4.size());  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    return IpAddressV6(bytes);
+}
+
+std::string IpAddressV6::ToString() const
+{
+    static char const* const hex = "0123456789abcdef";
+    std::array<char, 48> buf{};  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    size_t n = 0;
+
+    if (IsV4Mapped())
+    {
+        static char const prefix[] = "::ffff:";  // NOLINT(cppcoreguidelines-avoid-c-arrays, hicpp-avoid-c-arrays, modernize-avoid-c-arrays)
+        std::memcpy(buf.data(), prefix, sizeof(prefix) - 1);
+        n = sizeof(prefix) - 1;
+        n += FormatV4(ToV4().ToArray(), '.', buf.data() + n);
+        return std::string(buf.data(), n);
+    }
+
+    std::array<unsigned, 8> groups{};
+    for (size_t g = 0; g < groups.size(); ++g)
+        groups[g] = (static_cast<unsigned>(m_bytes[2 * g]) << 8) | m_bytes[2 * g + 1];  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+
+    // Find the longest run of two or more zero groups. The first one wins a tie.
+    size_t bestStart = groups.size();
+    size_t bestLen = 1;
+    for (size_t g = 0; g < groups.size();)
+    {
+        if (groups[g] != 0)
+        {
+            ++g;
+            continue;
+        }
+        size_t const start = g;
+        while (g < groups.size() && groups[g] == 0)
+            ++g;
+        if (g - start > bestLen)
+        {
+            bestStart = start;
+            bestLen = g - start;
+        }
+    }
+
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        if (g == bestStart)
+        {
+            buf[n++] = ':';
+            buf[n++] = ':';
+            g += bestLen - 1;
+            continue;
+        }
+        if (g > 0 && g != bestStart + bestLen)
+            buf[n++] = ':';
+        bool leading = true;
+        for (int shift = 12; shift >= 0; shift -= 4)  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        {
+            unsigned const digit = (groups[g] >> static_cast<unsigned>(shift)) & 0xfu;  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+            if (leading && digit == 0 && shift > 0)
+                continue;
+            leading = false;
+            buf[n++] = hex[digit];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+    }
+    return std::string(buf.data(), n);
+}
+
+std::array<uint8_t, 16> IpAddressV6::ToArray() const
+{
+    return m_bytes;
+}
+
+bool IpAddressV6::IsV4Mapped() const
+{
+    for (size_t i = 0; i < 10; ++i)  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    {
+        if (m_bytes[i] != 0)
+            return false;
+    }
+    return m_bytes[10] == 0xff && m_bytes[11] == 0xff;  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+}
+
+IpAddressV4 IpAddressV6::ToV4() const
+{
+    if (!IsV4Mapped())
+        throw ProgramError("Not an IPv4-mapped address: '" + ToString() + "'");
+    uint32_t val = 0;
+    std::memcpy(&val, m_bytes.data() + 12, 4);  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    return IpAddressV4(val);
+}
+
+bool IpAddressV6::operator==(IpAddressV6 const& other) const
+{
+    return m_bytes == other.m_bytes;
+}
+
+bool IpAddressV6::operator!=(IpAddressV6 const& other) const
+{
+    return !(*this == other);
+}
+
+IpAddress::IpAddress(IpAddressV4 const& ip)
+    : m_family(Family::V4)
+    , m_v4(ip)
+{ }
+
+IpAddress::IpAddress(IpAddressV6 const& ip)
+    : m_family(Family::V6)
+    , m_v6(ip)
+{ }
+
+//! Accepts either family. IPv4 is tried first, so "1:2:3:4" is the IPv4 address this library has always accepted.
+IpAddress::IpAddress(std::string const& ip)
+{
+    if (!TryParse(ip, this))
+        throw ProgramError("Not a valid IP address: '" + ip + "'");
+}
+
+bool IpAddress::TryParse(std::string const& text, IpAddress* out_ip)
+{
+    std::array<uint8_t, 4> v4{};
+    std::array<uint8_t, 16> v6{};
+    if (ParseV4(text.data(), text.size(), true, &v4))
+    {
+        uint32_t val = 0;
+        std::memcpy(&val, v4.data(), 4);
+        *out_ip = IpAddressV4(val);
+        return true;
+    }
+    if (ParseV6(text.data(), text.size(), &v6))
+    {
+        *out_ip = IpAddressV6(v6);
+        return true;
+    }
+    return false;
+}
+
+IpAddress::Family IpAddress::GetFamily() const
+{
+    return m_family;
+}
+
+bool IpAddress::IsV4() const
+{
+    return m_family == Family::V4;
+}
+
+bool IpAddress::IsV6() const
+{
+    return m_family == Family::V6;
+}
+
+IpAddressV4 const& IpAddress::V4() const
+{
+    if (!IsV4())
+        throw ProgramError("Not an IPv4 address: '" + ToString() + "'");
+    return m_v4;
+}
+
+IpAddressV6 const& IpAddress::V6() const
+{
+    if (!IsV6())
+        throw ProgramError("Not an IPv6 address: '" + ToString() + "'");
+    return m_v6;
+}
+
+std::string IpAddress::ToString() const
+{
+    return IsV4() ? m_v4.ToString('.') : m_v6.ToString();
+}
+
+bool IpAddress::operator==(IpAddress const& other) const
+{
+    return m_family == other.m_family && (IsV4() ? m_v4 == other.m_v4 : m_v6 == other.m_v6);
+}
+
+bool IpAddress::operator!=(IpAddress const& other) const
+{
+    return !(*this == other);
+}
+
 }}  // namespace strapper::net
@@ -0,0 +1,197 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <strapper/net/LatencyHistogram.h>
+
+#include <cmath>
+
+namespace strapper { namespace net {
+
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr unsigned LatencyHistogram::c_subBucketBits;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr uint64_t LatencyHistogram::c_subBuckets;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t LatencyHistogram::c_bucketCount;
+
+namespace {
+
+unsigned HighestBit(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned bit = 0;
+    for (unsigned shift = 32; shift > 0; shift /= 2)
+    {
+        if (value >> shift)
+        {
+            value >>= shift;
+            bit += shift;
+        }
+    }
+    return bit;
+#endif
+}
+
+void StoreMin(std::atomic<uint64_t>& target, uint64_t value)
+{
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    { }
+}
+
+void StoreMax(std::atomic<uint64_t>& target, uint64_t value)
+{
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    { }
+}
+
+}  // namespace
+
+//! Values below c_subBuckets get a bucket each. Above that, the highest set bit picks the
+//! power of two and the next c_subBucketBits bits pick the linear bucket within it.
+size_t LatencyHistogram::BucketIndex(uint64_t nanoseconds) noexcept
+{
+    if (nanoseconds < c_subBuckets)
+        return static_cast<size_t>(nanoseconds);
+    unsigned const highestBit = HighestBit(nanoseconds);
+    unsigned const shift = highestBit - c_subBucketBits;
+    uint64_t const subBucket = (nanoseconds >> shift) & (c_subBuckets - 1);
+    return static_cast<size_t>((shift + 1) * c_subBuckets + subBucket);
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(size_t index) noexcept
+{
+    if (index < c_subBuckets)
+        return index;
+    auto const shift = static_cast<unsigned>(index / c_subBuckets - 1);
+    uint64_t const subBucket = index % c_subBuckets;
+    return (c_subBuckets + subBucket) << shift;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) noexcept
+{
+    if (index < c_subBuckets)
+        return index;
+    auto const shift = static_cast<unsigned>(index / c_subBuckets - 1);
+    return BucketLowerBound(index) + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::Record(uint64_t nanoseconds) noexcept
+{
+    m_buckets[BucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    StoreMin(m_min, nanoseconds);
+    StoreMax(m_max, nanoseconds);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Record(std::chrono::nanoseconds duration) noexcept
+{
+    Record(duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0);
+}
+
+//! Adds other's samples to this histogram. Both may be in use by other threads.
+void LatencyHistogram::Merge(LatencyHistogram const& other) noexcept
+{
+    if (&other == this)
+        return;
+    uint64_t count = 0;
+    for (size_t i = 0; i < c_bucketCount; ++i)
+    {
+        uint64_t const bucketCount = other.m_buckets[i].load(std::memory_order_relaxed);
+        if (bucketCount == 0)
+            continue;
+        m_buckets[i].fetch_add(bucketCount, std::memory_order_relaxed);
+        count += bucketCount;
+    }
+    if (count == 0)
+        return;
+    m_sum.fetch_add(other.m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    StoreMin(m_min, other.m_min.load(std::memory_order_relaxed));
+    StoreMax(m_max, other.m_max.load(std::memory_order_relaxed));
+    m_count.fetch_add(count, std::memory_order_relaxed);
+}
+
+//! Not atomic as a whole. Samples recorded during a reset may be partly kept.
+void LatencyHistogram::Reset() noexcept
+{
+    for (auto& bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(UINT64_MAX, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Count() const noexcept
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+//! 0 if nothing has been recorded.
+uint64_t LatencyHistogram::Min() const noexcept
+{
+    uint64_t const min = m_min.load(std::memory_order_relaxed);
+    return min == UINT64_MAX && Count() == 0 ? 0 : min;
+}
+
+uint64_t LatencyHistogram::Max() const noexcept
+{
+    return m_max.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::Mean() const noexcept
+{
+    uint64_t const count = Count();
+    if (count == 0)
+        return 0;
+    return static_cast<double>(m_sum.load(std::memory_order_relaxed)) / static_cast<double>(count);
+}
+
+//! @param[in] percentile In [0, 100]. 50 is the median.
+//! @return The largest value that falls in the same bucket as the sample at that rank, capped at Max().
+//!         0 if nothing has been recorded.
+uint64_t LatencyHistogram::Percentile(double percentile) const noexcept
+{
+    uint64_t total = 0;
+    for (auto const& bucket : m_buckets)
+        total += bucket.load(std::memory_order_relaxed);
+    if (total == 0)
+        return 0;
+
+    double const clamped = percentile < 0 ? 0 : (percentile > 100 ? 100 : percentile);
+    auto rank = static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total)));
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < c_bucketCount; ++i)
+    {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            uint64_t const max = Max();
+            uint64_t const upper = BucketUpperBound(i);
+            return upper < max ? upper : max;
+        }
+    }
+    return Max();
+}
+
+}}  // namespace strapper::net
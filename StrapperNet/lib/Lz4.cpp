@@ -0,0 +1,230 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <strapper/net/Lz4.h>
+
+#include <strapper/net/SocketError.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace strapper { namespace net {
+
+namespace {
+
+// Constants from the LZ4 block format specification.
+size_t constexpr c_minMatch = 4;
+size_t constexpr c_lastLiterals = 5;  // The last 5 bytes are always literals.
+size_t constexpr c_matchSearchLimit = 12;  // The last match must start at least 12 bytes before the end.
+size_t constexpr c_maxOffset = 65535;
+unsigned constexpr c_runMask = 15;
+
+unsigned constexpr c_hashLog = 12;
+unsigned constexpr c_skipTrigger = 6;  // Search faster through data that isn't compressing.
+
+uint32_t Read32(uint8_t const* p)
+{
+    uint32_t value = 0;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - c_hashLog);
+}
+
+//! Writes the extra length bytes that follow a token when a length doesn't fit in 4 bits.
+uint8_t* WriteLength(uint8_t* op, size_t len)
+{
+    while (len >= 255)
+    {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = static_cast<uint8_t>(len);
+    return op;
+}
+
+uint8_t* WriteSequence(uint8_t* op, uint8_t const* literals, size_t literalLen, size_t offset, size_t matchLen)
+{
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>(std::min<size_t>(literalLen, c_runMask) << 4);
+    if (literalLen >= c_runMask)
+        op = WriteLength(op, literalLen - c_runMask);
+    std::memcpy(op, literals, literalLen);
+    op += literalLen;
+
+    if (matchLen == 0)  // Last sequence.
+        return op;
+
+    *op++ = static_cast<uint8_t>(offset & 0xFF);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    size_t const matchCode = matchLen - c_minMatch;
+    *token = static_cast<uint8_t>(*token | std::min<size_t>(matchCode, c_runMask));
+    if (matchCode >= c_runMask)
+        op = WriteLength(op, matchCode - c_runMask);
+    return op;
+}
+
+//! Reads the extra length bytes that follow a token.
+size_t ReadLength(uint8_t const*& ip, uint8_t const* end)
+{
+    size_t len = 0;
+    uint8_t byte = 255;
+    while (byte == 255)
+    {
+        if (ip >= end)
+            throw ProgramError("Malformed LZ4 block.");
+        byte = *ip++;
+        len += byte;
+    }
+    return len;
+}
+
+}  // namespace
+
+size_t Lz4CompressBound(size_t len)
+{
+    return len + len / 255 + 16;
+}
+
+size_t Lz4Compress(void const* src, size_t len, void* dest, size_t destCapacity)
+{
+    if ((!src && len > 0) || !dest)
+        throw ProgramError("Null pointer.");
+    if (destCapacity < Lz4CompressBound(len))
+        throw ProgramError("Destination is smaller than the compress bound.");
+
+    auto const* const base = static_cast<uint8_t const*>(src);
+    auto* const out = static_cast<uint8_t*>(dest);
+    uint8_t* op = out;
+
+    if (len <= c_matchSearchLimit)
+        return static_cast<size_t>(WriteSequence(op, base, len, 0, 0) - out);
+
+    // Positions of recently seen 4-byte sequences.
+    std::array<uint32_t, size_t{ 1 } << c_hashLog> table{};
+
+    size_t const searchEnd = len - c_matchSearchLimit;
+    size_t const matchEnd = len - c_lastLiterals;
+    size_t anchor = 0;
+    size_t ip = 0;
+    unsigned misses = 0;
+
+    while (ip < searchEnd)
+    {
+        uint32_t const sequence = Read32(base + ip);
+        uint32_t& entry = table[Hash(sequence)];
+        size_t const candidate = entry;
+        entry = static_cast<uint32_t>(ip);
+
+        if (candidate >= ip || ip - candidate > c_maxOffset || Read32(base + candidate) != sequence)
+        {
+            ip += 1 + (misses++ >> c_skipTrigger);
+            continue;
+        }
+        misses = 0;
+
+        size_t start = ip;
+        size_t ref = candidate;
+        // Extend backwards into pending literals.
+        while (start > anchor && ref > 0 && base[start - 1] == base[ref - 1])
+        {
+            --start;
+            --ref;
+        }
+        size_t end = ip + c_minMatch;
+        while (end < matchEnd && base[end] == base[ref + (end - start)])
+            ++end;
+
+        op = WriteSequence(op, base + anchor, start - anchor, start - ref, end - start);
+        ip = end;
+        anchor = end;
+
+        // Index a position inside the match to help find the next one.
+        if (ip - 2 < searchEnd)
+            table[Hash(Read32(base + ip - 2))] = static_cast<uint32_t>(ip - 2);
+    }
+
+    op = WriteSequence(op, base + anchor, len - anchor, 0, 0);
+    return static_cast<size_t>(op - out);
+}
+
+size_t Lz4Decompress(void const* src, size_t len, void* dest, size_t destCapacity)
+{
+    if ((!src && len > 0) || (!dest && destCapacity > 0))
+        throw ProgramError("Null pointer.");
+
+    auto const* ip = static_cast<uint8_t const*>(src);
+    uint8_t const* const ipEnd = ip + len;
+    auto* const out = static_cast<uint8_t*>(dest);
+    uint8_t* op = out;
+    uint8_t* const opEnd = out + destCapacity;
+
+    while (true)
+    {
+        if (ip >= ipEnd)
+            throw ProgramError("Malformed LZ4 block.");
+        unsigned const token = *ip++;
+
+        size_t literalLen = token >> 4;
+        if (literalLen == c_runMask)
+            literalLen += ReadLength(ip, ipEnd);
+        if (literalLen > static_cast<size_t>(ipEnd - ip) || literalLen > static_cast<size_t>(opEnd - op))
+            throw ProgramError("Malformed LZ4 block.");
+        if (literalLen > 0)
+            std::memcpy(op, ip, literalLen);
+        ip += literalLen;
+        op += literalLen;
+
+        if (ip == ipEnd)  // The last sequence has no match.
+            break;
+
+        if (ipEnd - ip < 2)
+            throw ProgramError("Malformed LZ4 block.");
+        size_t const offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - out))
+            throw ProgramError("Malformed LZ4 block.");
+
+        size_t matchLen = token & c_runMask;
+        if (matchLen == c_runMask)
+            matchLen += ReadLength(ip, ipEnd);
+        matchLen += c_minMatch;
+        if (matchLen > static_cast<size_t>(opEnd - op))
+            throw ProgramError("Malformed LZ4 block.");
+
+        uint8_t const* match = op - offset;
+        if (offset >= matchLen)
+        {
+            std::memcpy(op, match, matchLen);
+            op += matchLen;
+        }
+        else
+        {
+            // Overlapping copy repeats the last offset bytes.
+            for (size_t i = 0; i < matchLen; ++i)
+                *op++ = *match++;
+        }
+    }
+
+    return static_cast<size_t>(op - out);
+}
+
+}}  // namespace strapper::net
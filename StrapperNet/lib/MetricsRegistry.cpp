@@ -0,0 +1,130 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <strapper/net/MetricsRegistry.h>
+
+#include <strapper/net/ErrorCode.h>
+
+#include <sstream>
+
+namespace strapper { namespace net {
+
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t MetricsRegistry::c_counterCount;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t MetricsRegistry::c_shardCount;
+
+std::atomic<bool> MetricsRegistry::s_enabled{ false };
+
+namespace {
+
+//! Threads are spread over the shards in the order they first count something.
+size_t ThisThreadShard()
+{
+    static std::atomic<size_t> nextShard{ 0 };
+    thread_local size_t const shard = nextShard.fetch_add(1, std::memory_order_relaxed) % MetricsRegistry::c_shardCount;
+    return shard;
+}
+
+struct CounterInfo
+{
+    char const* name;
+    char const* help;
+};
+
+// In the same order as MetricsRegistry::Counter.
+CounterInfo const c_counterInfo[MetricsRegistry::c_counterCount] = {
+    { "strapper_net_tcp_connects_total", "Outgoing TCP connections established." },
+    { "strapper_net_tcp_accepts_total", "Incoming TCP connections accepted." },
+    { "strapper_net_tcp_closes_total", "TCP connections closed." },
+    { "strapper_net_tcp_bytes_read_total", "Bytes received over TCP." },
+    { "strapper_net_tcp_bytes_written_total", "Bytes sent over TCP." },
+    { "strapper_net_udp_datagrams_read_total", "UDP datagrams received." },
+    { "strapper_net_udp_datagrams_written_total", "UDP datagrams sent." },
+    { "strapper_net_udp_bytes_read_total", "Bytes received over UDP." },
+    { "strapper_net_udp_bytes_written_total", "Bytes sent over UDP." },
+};
+
+}  // namespace
+
+MetricsRegistry& MetricsRegistry::Global()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+void MetricsRegistry::Add(Counter counter, uint64_t value) noexcept
+{
+    m_shards[ThisThreadShard()].counters[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+//! Errors are rare, so they are kept in one map behind a lock.
+void MetricsRegistry::AddError(int nativeErrorCode)
+{
+    std::lock_guard<std::mutex> lock(m_errorLock);
+    ++m_errors[nativeErrorCode];
+}
+
+uint64_t MetricsRegistry::Get(Counter counter) const noexcept
+{
+    uint64_t total = 0;
+    for (auto const& shard : m_shards)
+        total += shard.counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t MetricsRegistry::OpenConnections() const noexcept
+{
+    uint64_t const opened = Get(Counter::TCP_CONNECTS) + Get(Counter::TCP_ACCEPTS);
+    uint64_t const closed = Get(Counter::TCP_CLOSES);
+    return opened > closed ? opened - closed : 0;
+}
+
+std::map<int, uint64_t> MetricsRegistry::GetErrors() const
+{
+    std::lock_guard<std::mutex> lock(m_errorLock);
+    return m_errors;
+}
+
+//! Renders every metric in the Prometheus text exposition format (version 0.0.4).
+//! Rates such as accepts or bytes per second are left to the scraper.
+std::string MetricsRegistry::RenderPrometheus() const
+{
+    std::ostringstream out;
+    out << "# HELP strapper_net_tcp_connections_open TCP connections currently open.\n"
+        << "# TYPE strapper_net_tcp_connections_open gauge\n"
+        << "strapper_net_tcp_connections_open " << OpenConnections() << "\n";
+
+    for (size_t i = 0; i < c_counterCount; ++i)
+    {
+        out << "# HELP " << c_counterInfo[i].name << " " << c_counterInfo[i].help << "\n"
+            << "# TYPE " << c_counterInfo[i].name << " counter\n"
+            << c_counterInfo[i].name << " " << Get(static_cast<Counter>(i)) << "\n";
+    }
+
+    out << "# HELP strapper_net_socket_errors_total Failed socket API calls by native error code.\n"
+        << "# TYPE strapper_net_socket_errors_total counter\n";
+    for (auto const& error : GetErrors())
+    {
+        // GetErrorName gives "NAME (code)" for known codes and just the code otherwise.
+        std::string name = ErrorCode::GetErrorName(error.first);
+        name = name.substr(0, name.find(' '));
+        out << "strapper_net_socket_errors_total{code=\"" << error.first << "\",name=\"" << name << "\"} " << error.second << "\n";
+    }
+    return out.str();
+}
+
+}}  // namespace strapper::net
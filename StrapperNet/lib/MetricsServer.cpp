@@ -0,0 +1,127 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <strapper/net/MetricsServer.h>
+
+#include <strapper/net/MetricsRegistry.h>
+#include <strapper/net/SocketError.h>
+
+#include <algorithm>
+#include <string>
+
+namespace strapper { namespace net {
+
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t MetricsServer::c_maxRequestLen;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr unsigned MetricsServer::c_clientTimeoutMs;
+
+namespace {
+
+std::string Response(char const* status, std::string const& body)
+{
+    return std::string("HTTP/1.1 ") + status + "\r\n"
+           + "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+           + "Content-Length: " + std::to_string(body.length()) + "\r\n"
+           + "Connection: close\r\n"
+           + "\r\n"
+           + body;
+}
+
+}  // namespace
+
+MetricsServer::MetricsServer(uint16_t port, ErrorCode* ec /* = nullptr */)
+    : m_listener(port, ec)
+{
+    if (!m_listener)
+        return;
+    MetricsRegistry::Enable(true);
+    m_acceptor = std::thread(&MetricsServer::acceptLoop, this);
+}
+
+MetricsServer::~MetricsServer()
+{
+    Close();
+}
+
+bool MetricsServer::IsListening() const
+{
+    return m_listener.IsListening();
+}
+
+//! Stops listening and waits for the client being served, if any.
+void MetricsServer::Close() noexcept
+{
+    m_listener.Close();
+    if (m_acceptor.joinable())
+        m_acceptor.join();
+}
+
+void MetricsServer::acceptLoop()
+{
+    for (;;)
+    {
+        ErrorCode ec;
+        TcpSocket client = m_listener.Accept(&ec);
+        if (ec)
+            return;  // Closed.
+        try
+        {
+            serve(client);
+        }
+        catch (ProgramError const&)
+        {
+            // A misbehaving client only loses its own connection.
+        }
+    }
+}
+
+void MetricsServer::serve(TcpSocket& client)
+{
+    client.SetReadTimeout(c_clientTimeoutMs);
+
+    // Only the request head is needed. Scrapers do not send a body with GET.
+    std::string request;
+    char buffer[512];
+    while (request.find("\r\n\r\n") == std::string::npos)
+    {
+        if (request.length() >= c_maxRequestLen)
+            throw ProgramError("HTTP request is too long.");
+        size_t const wanted = std::min<size_t>({ sizeof(buffer), c_maxRequestLen - request.length(), std::max(client.DataAvailable(), 1u) });
+        if (!client.Read(buffer, wanted))
+            return;
+        request.append(buffer, wanted);
+    }
+
+    std::string const requestLine = request.substr(0, request.find("\r\n"));
+    size_t const methodEnd = requestLine.find(' ');
+    size_t const targetEnd = requestLine.find(' ', methodEnd + 1);
+    std::string const method = requestLine.substr(0, methodEnd);
+    std::string const target = methodEnd == std::string::npos ? "" : requestLine.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+
+    std::string response;
+    if (method != "GET")
+        response = Response("405 Method Not Allowed", "Only GET is supported.\n");
+    else if (target != "/metrics" && target.compare(0, 9, "/metrics?") != 0)
+        response = Response("404 Not Found", "Metrics are served at /metrics.\n");
+    else
+        response = Response("200 OK", MetricsRegistry::Global().RenderPrometheus());
+
+    client.Write(response.data(), response.length());
+    client.ShutdownSend();
+}
+
+}}  // namespace strapper::net
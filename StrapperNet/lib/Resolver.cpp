@@ -0,0 +1,254 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <strapper/net/Resolver.h>
+
+#include <strapper/net/ErrorCode.h>
+#include <strapper/net/SocketError.h>
+#include "WorkerPool.h"
+
+#include <memory>
+#include <utility>
+
+namespace strapper { namespace net {
+
+Resolver& Resolver::Global()
+{
+    static Resolver resolver;
+    return resolver;
+}
+
+Resolver::Addresses Resolver::InterleaveFamilies(Addresses const& addresses)
+{
+    if (addresses.empty())
+        return {};
+
+    Addresses first;
+    Addresses second;
+    for (auto const& ip : addresses)
+        (ip.GetFamily() == addresses.front().GetFamily() ? first : second).push_back(ip);
+
+    Addresses result;
+    result.reserve(addresses.size());
+    for (size_t i = 0; i < first.size() || i < second.size(); ++i)
+    {
+        if (i < first.size())
+            result.push_back(first[i]);
+        if (i < second.size())
+            result.push_back(second[i]);
+    }
+    return result;
+}
+
+Resolver::Resolver()
+    : Resolver(Options())
+{ }
+
+Resolver::Resolver(Options options, LookupFunction lookup /* = SystemLookup */)
+    : m_options(options)
+    , m_lookup(std::move(lookup))
+    , m_pool(new WorkerPool(options.workerThreads))
+{
+    if (!m_lookup)
+        throw ProgramError("Lookup function is empty.");
+}
+
+Resolver::~Resolver() = default;
+
+Resolver::Addresses Resolver::Resolve(std::string const& host, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        Addresses addresses;
+        if (tryNumeric(host, &addresses))
+            return addresses;
+
+        Answer const answer = resolve(host);
+        if (answer.error)
+            std::rethrow_exception(answer.error);
+        return answer.addresses;
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return {};
+    }
+}
+
+std::future<Resolver::Addresses> Resolver::ResolveAsync(std::string const& host)
+{
+    auto promise = std::make_shared<std::promise<Addresses>>();
+    std::future<Addresses> future = promise->get_future();
+
+    Addresses addresses;
+    Answer answer;
+    if (tryNumeric(host, &addresses))
+        promise->set_value(std::move(addresses));
+    else if (tryCache(host, &answer))
+    {
+        if (answer.error)
+            promise->set_exception(answer.error);
+        else
+            promise->set_value(std::move(answer.addresses));
+    }
+    else
+    {
+        m_pool->Post([this, host, promise]() {
+            Answer const result = resolve(host);
+            if (result.error)
+                promise->set_exception(result.error);
+            else
+                promise->set_value(result.addresses);
+        });
+    }
+    return future;
+}
+
+void Resolver::ResolveAsync(std::string const& host, Callback callback)
+{
+    if (!callback)
+        throw ProgramError("Callback is empty.");
+
+    Addresses addresses;
+    Answer answer;
+    if (tryNumeric(host, &addresses))
+        callback(addresses, ErrorCode());
+    else if (tryCache(host, &answer))
+        callback(answer.addresses, answer.error ? ErrorCode(answer.error) : ErrorCode());
+    else
+    {
+        m_pool->Post([this, host, callback]() {
+            Answer const result = resolve(host);
+            callback(result.addresses, result.error ? ErrorCode(result.error) : ErrorCode());
+        });
+    }
+}
+
+void Resolver::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_cacheLock);
+    m_cache.clear();
+    m_lru.clear();
+}
+
+size_t Resolver::Size() const
+{
+    std::lock_guard<std::mutex> lock(m_cacheLock);
+    return m_cache.size();
+}
+
+ResolverStats Resolver::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_cacheLock);
+    return m_stats;
+}
+
+// Numeric addresses skip the cache. IPv4 must be dotted here, since a ':' delimiter would be mistaken for IPv6.
+bool Resolver::tryNumeric(std::string const& host, Addresses* out_addresses) const
+{
+    IpAddress ip;
+    if (!IpAddress::TryParse(host, &ip) || (ip.IsV4() && host.find(':') != std::string::npos))
+        return false;
+    out_addresses->assign(1, ip);
+    return true;
+}
+
+bool Resolver::tryCache(std::string const& host, Answer* out_answer)
+{
+    std::lock_guard<std::mutex> lock(m_cacheLock);
+    auto const iter = m_cache.find(host);
+    if (iter == m_cache.end() || iter->second.expires <= Clock::now())
+        return false;
+
+    m_lru.splice(m_lru.begin(), m_lru, iter->second.lru);
+    ++(iter->second.answer.error ? m_stats.negativeHits : m_stats.hits);
+    *out_answer = iter->second.answer;
+    return true;
+}
+
+Resolver::Answer Resolver::resolve(std::string const& host)
+{
+    Answer answer;
+    if (tryCache(host, &answer))
+        return answer;
+
+    std::promise<Answer> promise;
+    {
+        std::unique_lock<std::mutex> lock(m_cacheLock);
+        ++m_stats.misses;
+        auto const iter = m_inFlight.find(host);
+        if (iter != m_inFlight.end())
+        {
+            ++m_stats.coalesced;
+            std::shared_future<Answer> const pending = iter->second;
+            lock.unlock();
+            return pending.get();
+        }
+        m_inFlight.emplace(host, promise.get_future().share());
+    }
+
+    try
+    {
+        answer.addresses = m_lookup(host);
+        if (answer.addresses.empty())
+            throw ProgramError("No addresses found for host: '" + host + "'");
+    }
+    catch (...)
+    {
+        answer.addresses.clear();
+        answer.error = std::current_exception();
+    }
+
+    store(host, answer);
+    promise.set_value(answer);
+    return answer;
+}
+
+void Resolver::store(std::string const& host, Answer const& answer)
+{
+    std::lock_guard<std::mutex> lock(m_cacheLock);
+    m_inFlight.erase(host);
+    if (m_options.maxEntries == 0)
+        return;
+
+    auto const ttl = answer.error ? m_options.negativeTtl : m_options.positiveTtl;
+    auto const expires = Clock::now() + ttl;
+
+    auto iter = m_cache.find(host);
+    if (iter != m_cache.end())
+    {
+        iter->second.answer = answer;
+        iter->second.expires = expires;
+        m_lru.splice(m_lru.begin(), m_lru, iter->second.lru);
+        return;
+    }
+
+    while (m_cache.size() >= m_options.maxEntries)
+    {
+        auto const victim = m_cache.find(m_lru.back());
+        if (victim->second.expires > Clock::now())
+            ++m_stats.evictions;
+        m_cache.erase(victim);
+        m_lru.pop_back();
+    }
+
+    m_lru.push_front(host);
+    m_cache.emplace(host, Entry{ answer, expires, m_lru.begin() });
+}
+
+}}  // namespace strapper::net
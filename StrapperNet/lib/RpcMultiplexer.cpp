@@ -0,0 +1,181 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <strapper/net/RpcMultiplexer.h>
+
+#include <strapper/net/SocketError.h>
+
+#include <utility>
+
+namespace strapper { namespace net {
+
+RpcMultiplexer::RpcMultiplexer(TcpSocket&& socket, uint32_t maxFrameLen /* = FramedConnection::c_maxFrameLen */)
+    : m_connection(std::move(socket), maxFrameLen)
+{
+    if (!m_connection.Socket().IsOpen())
+        throw ProgramError("Socket is not connected.");
+    m_reader = std::thread(&RpcMultiplexer::readLoop, this);
+}
+
+RpcMultiplexer::~RpcMultiplexer()
+{
+    Close();
+}
+
+bool RpcMultiplexer::IsOpen() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return !m_error;
+}
+
+//! Closes the connection. Calls that haven't received a response are failed.
+//! May be called from any thread. Called on the reader thread, it cannot wait for that thread, so it detaches it instead.
+void RpcMultiplexer::Close() noexcept
+{
+    // Unblocks the reader thread, which fails any pending calls on its way out.
+    m_connection.Socket().Close();
+    if (!m_reader.joinable())
+        return;
+    if (m_reader.get_id() == std::this_thread::get_id())
+        m_reader.detach();  // Otherwise ~thread would terminate. The thread finishes once it returns from the loop.
+    else
+        m_reader.join();
+}
+
+//! Sends a request and returns without waiting for the response.
+//! If the connection fails before the response arrives, the future holds the error.
+std::future<std::string> RpcMultiplexer::Call(std::string const& request, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        std::promise<std::string> promise;
+        std::future<std::string> response = promise.get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_error)
+                throw ProgramError("Connection is closed.");
+
+            uint32_t const stream = m_nextStream;
+            if (m_pending.count(stream) != 0)
+                throw ProgramError("Too many pending calls.");
+            m_connection.Encode(stream, request, &m_outgoing);
+            m_pending.emplace(stream, std::move(promise));
+            ++m_nextStream;
+
+            // Whoever is already writing will pick up this call.
+            if (m_flushing)
+                return response;
+            m_flushing = true;
+        }
+
+        flush();
+        return response;
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return {};
+    }
+}
+
+//! @return The number of calls waiting for a response.
+size_t RpcMultiplexer::Pending() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_pending.size();
+}
+
+//! Writes everything queued, including calls queued by other threads while this thread was writing.
+void RpcMultiplexer::flush()
+{
+    std::string batch;
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_outgoing.empty() || m_error)
+            {
+                m_flushing = false;
+                return;
+            }
+            batch.swap(m_outgoing);
+            m_outgoing.clear();
+        }
+
+        try
+        {
+            m_connection.Socket().Write(batch.data(), batch.length());
+        }
+        catch (...)
+        {
+            // Part of a frame may have been sent, so the connection can't be used anymore.
+            // m_flushing must be reset for any exception, or later calls would queue behind a writer that is gone.
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_flushing = false;
+            }
+            fail(std::current_exception());
+            m_connection.Socket().Close();
+            throw;
+        }
+    }
+}
+
+void RpcMultiplexer::readLoop()
+{
+    try
+    {
+        FramedConnection::Frame frame;
+        while (m_connection.Receive(&frame))
+        {
+            std::promise<std::string> promise;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto const iter = m_pending.find(frame.sequence);
+                if (iter == m_pending.end())
+                    throw ProgramError("Received a response to an unknown call.");
+                promise = std::move(iter->second);
+                m_pending.erase(iter);
+            }
+            promise.set_value(std::move(frame.payload));
+        }
+        throw ProgramError("Other side closed the connection.");
+    }
+    catch (...)
+    {
+        fail(std::current_exception());
+        m_connection.Socket().Close();
+    }
+}
+
+//! Fails all pending calls and stops new ones from being made.
+void RpcMultiplexer::fail(std::exception_ptr error) noexcept
+{
+    std::unordered_map<uint32_t, std::promise<std::string>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (!m_error)
+            m_error = error;
+        pending.swap(m_pending);
+        m_outgoing.clear();
+    }
+    for (auto& entry : pending)
+        entry.second.set_exception(error);
+}
+
+}}  // namespace strapper::net
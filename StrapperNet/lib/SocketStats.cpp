@@ -0,0 +1,39 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <strapper/net/SocketStats.h>
+
+namespace strapper { namespace net {
+
+SocketStats SocketStatsCounters::Snapshot() const
+{
+    SocketStats stats;
+#if STRAPPER_NET_SOCKET_STATS
+    auto const load = [](std::atomic<uint64_t> const& counter) { return counter.load(std::memory_order_relaxed); };
+    stats.bytesRead = load(m_bytesRead);
+    stats.bytesWritten = load(m_bytesWritten);
+    stats.readCalls = load(m_readCalls);
+    stats.writeCalls = load(m_writeCalls);
+    stats.interruptedCalls = load(m_interruptedCalls);
+    stats.partialReads = load(m_partialReads);
+    stats.partialWrites = load(m_partialWrites);
+    stats.readNanoseconds = load(m_readNanoseconds);
+    stats.writeNanoseconds = load(m_writeNanoseconds);
+#endif
+    return stats;
+}
+
+}}  // namespace strapper::net
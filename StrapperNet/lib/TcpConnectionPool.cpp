@@ -0,0 +1,207 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <strapper/net/TcpConnectionPool.h>
+
+#include <strapper/net/ErrorCode.h>
+#include <strapper/net/SocketError.h>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace strapper { namespace net {
+
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t TcpConnectionPool::c_shardCount;
+
+namespace {
+
+// Checks an idle connection without blocking. Any readiness means the peer closed it, it failed, or it has
+// unread data, and none of those can be handed to a new request.
+bool IsHealthy(TcpSocket& socket)
+{
+    if (!socket.IsOpen())
+        return false;
+    std::vector<bool> ready;
+    ErrorCode ec;
+    size_t const count = TcpSocket::WaitReadable({ &socket }, &ready, 0, &ec);
+    return !ec && count == 0;
+}
+
+}  // namespace
+
+TcpConnectionPool::TcpConnectionPool()
+    : TcpConnectionPool(Options())
+{ }
+
+TcpConnectionPool::TcpConnectionPool(Options const& options)
+    : m_options(options)
+{ }
+
+TcpSocket TcpConnectionPool::Acquire(std::string const& host, uint16_t port, ErrorCode* ec /* = nullptr */)
+{
+    std::string const k = key(host, port);
+    Shard& s = shard(k);
+
+    for (;;)
+    {
+        std::deque<Idle> dropped;  // Closed after the lock is released.
+        TcpSocket candidate;
+        {
+            std::lock_guard<std::mutex> lock(s.lock);
+            auto const iter = s.idle.find(k);
+            if (iter == s.idle.end())
+                break;
+            expire(s, iter->second, Clock::now(), &dropped);
+            if (iter->second.empty())
+            {
+                s.idle.erase(iter);
+                break;
+            }
+            candidate = std::move(iter->second.back().socket);
+            iter->second.pop_back();
+        }
+
+        if (IsHealthy(candidate))
+        {
+            std::lock_guard<std::mutex> lock(s.lock);
+            ++s.stats.reused;
+            return candidate;
+        }
+        std::lock_guard<std::mutex> lock(s.lock);
+        ++s.stats.stale;
+    }
+
+    TcpSocket socket(host, port, m_options.connectOptions, ec);
+    if (socket.IsOpen())
+    {
+        std::lock_guard<std::mutex> lock(s.lock);
+        ++s.stats.connected;
+    }
+    return socket;
+}
+
+void TcpConnectionPool::Release(std::string const& host, uint16_t port, TcpSocket socket)
+{
+    if (!socket.IsOpen() || m_options.maxIdlePerHost == 0)
+        return;
+
+    std::string const k = key(host, port);
+    Shard& s = shard(k);
+    std::deque<Idle> dropped;  // Closed after the lock is released.
+
+    std::lock_guard<std::mutex> lock(s.lock);
+    auto const now = Clock::now();
+    auto& idle = s.idle[k];
+    expire(s, idle, now, &dropped);
+    while (idle.size() >= m_options.maxIdlePerHost)
+    {
+        dropped.push_back(std::move(idle.front()));
+        idle.pop_front();
+        ++s.stats.overflow;
+    }
+    idle.push_back(Idle{ std::move(socket), now });
+}
+
+void TcpConnectionPool::EvictExpired()
+{
+    auto const now = Clock::now();
+    for (auto& s : m_shards)
+    {
+        std::deque<Idle> dropped;
+        std::lock_guard<std::mutex> lock(s.lock);
+        for (auto iter = s.idle.begin(); iter != s.idle.end();)
+        {
+            expire(s, iter->second, now, &dropped);
+            iter = iter->second.empty() ? s.idle.erase(iter) : std::next(iter);
+        }
+    }
+}
+
+void TcpConnectionPool::Clear()
+{
+    for (auto& s : m_shards)
+    {
+        std::unordered_map<std::string, std::deque<Idle>> dropped;
+        std::lock_guard<std::mutex> lock(s.lock);
+        dropped.swap(s.idle);
+    }
+}
+
+size_t TcpConnectionPool::IdleCount() const
+{
+    size_t count = 0;
+    for (auto const& s : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(s.lock);
+        for (auto const& entry : s.idle)
+            count += entry.second.size();
+    }
+    return count;
+}
+
+size_t TcpConnectionPool::IdleCount(std::string const& host, uint16_t port) const
+{
+    std::string const k = key(host, port);
+    Shard const& s = shard(k);
+    std::lock_guard<std::mutex> lock(s.lock);
+    auto const iter = s.idle.find(k);
+    return iter == s.idle.end() ? 0 : iter->second.size();
+}
+
+ConnectionPoolStats TcpConnectionPool::GetStats() const
+{
+    ConnectionPoolStats total;
+    for (auto const& s : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(s.lock);
+        total.reused += s.stats.reused;
+        total.connected += s.stats.connected;
+        total.stale += s.stats.stale;
+        total.expired += s.stats.expired;
+        total.overflow += s.stats.overflow;
+    }
+    return total;
+}
+
+std::string TcpConnectionPool::key(std::string const& host, uint16_t port)
+{
+    return host + '|' + std::to_string(port);  // '|' cannot appear in a host name or an IPv6 address.
+}
+
+TcpConnectionPool::Shard& TcpConnectionPool::shard(std::string const& key)
+{
+    return m_shards[std::hash<std::string>()(key) % c_shardCount];
+}
+
+TcpConnectionPool::Shard const& TcpConnectionPool::shard(std::string const& key) const
+{
+    return m_shards[std::hash<std::string>()(key) % c_shardCount];
+}
+
+// Moves connections idle for longer than maxIdleTime into out_dropped. Call with the shard locked.
+void TcpConnectionPool::expire(Shard& shard, std::deque<Idle>& idle, Clock::time_point now, std::deque<Idle>* out_dropped) const
+{
+    while (!idle.empty() && now - idle.front().released > m_options.maxIdleTime)
+    {
+        out_dropped->push_back(std::move(idle.front()));
+        idle.pop_front();
+        ++shard.stats.expired;
+    }
+}
+
+}}  // namespace strapper::net
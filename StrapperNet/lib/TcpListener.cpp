@@ -39,6 +39,21 @@ TcpListener::TcpListener(uint16_t port, ErrorCode* ec /* = nullptr */)
     }
 }
 
+TcpListener::TcpListener(uint16_t port, SocketOptions const& options, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        m_listener = TcpBasicListener(port, options);
+        m_state = State::OPEN;
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+}
+
 TcpListener::TcpListener(TcpListener&& other) noexcept
     : TcpListener()
 {
@@ -76,6 +91,8 @@ void swap(TcpListener& left, TcpListener& right)
     using std::swap;
     swap(left.m_listener, right.m_listener);
     swap(left.m_state, right.m_state);
+    swap(left.m_latency, right.m_latency);
+    left.m_timed.store(right.m_timed.exchange(left.m_timed.load()));
 }
 
 bool TcpListener::IsListening() const
@@ -84,6 +101,70 @@ bool TcpListener::IsListening() const
     return m_state != State::CLOSED;
 }
 
+//! May be called while another thread is accepting. Only sockets accepted afterwards inherit the options.
+void TcpListener::SetOptions(SocketOptions const& options, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_state == State::CLOSED)
+            throw ProgramError("Listener is closed.");
+        if (m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Listener was closed from another thread.");
+
+        m_listener.SetOptions(options);
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+}
+
+SocketOptions TcpListener::GetOptions(ErrorCode* ec /* = nullptr */) const
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_state == State::CLOSED)
+            throw ProgramError("Listener is closed.");
+        if (m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Listener was closed from another thread.");
+
+        return m_listener.GetOptions();
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return {};
+    }
+}
+
+//! Can be called while another thread is accepting.
+uint16_t TcpListener::LocalPort(ErrorCode* ec /* = nullptr */) const
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_state == State::CLOSED)
+            throw ProgramError("Listener is closed.");
+        if (m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Listener was closed from another thread.");
+
+        return m_listener.LocalPort();
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return 0;
+    }
+}
+
 void TcpListener::Close() noexcept
 {
     std::unique_lock<std::mutex> lock(m_lock);
@@ -125,6 +206,33 @@ TcpSocket TcpListener::Accept(ErrorCode* ec /* = nullptr*/)
     }
 }
 
+SocketLatency TcpListener::GetLatencyHistograms() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_latency;
+}
+
+//! Attaches histograms that Accept records into. Accept times go in the read histogram; write is unused.
+//! Accepted sockets do not inherit them. Cannot be changed while another thread is accepting.
+void TcpListener::SetLatencyHistograms(SocketLatency latency, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_state == State::ACCEPTING || m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Listener is already accepting.");
+
+        m_timed.store(latency.read || latency.lockWait, std::memory_order_relaxed);
+        m_latency = std::move(latency);
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+}
+
 TcpListener::operator bool() const
 {
     return IsListening();
@@ -132,18 +240,25 @@ TcpListener::operator bool() const
 
 TcpSocket TcpListener::accept()
 {
+    // Safe to use without the lock while accepting, since the histograms cannot be changed until the accept finishes.
+    LatencyHistogram* acceptHistogram = nullptr;
     {
+        LatencyTimer const lockTimer(m_timed.load(std::memory_order_relaxed));
         std::lock_guard<std::mutex> lock(m_lock);
+        lockTimer.Stop(m_latency.lockWait.get());
         if (m_state == State::ACCEPTING || m_state == State::SHUTTING_DOWN)
             throw ProgramError("Listener is already accepting.");
         if (m_state == State::CLOSED)
             throw ProgramError("Listener is closed.");
         m_state = State::ACCEPTING;
+        acceptHistogram = m_latency.read.get();
     }
 
     try
     {
+        LatencyTimer const acceptTimer(acceptHistogram != nullptr);
         TcpBasicSocket newClient = m_listener.Accept();
+        acceptTimer.Stop(acceptHistogram);
 
         std::unique_lock<std::mutex> lock(m_lock);
         if (m_state == State::SHUTTING_DOWN)
@@ -16,17 +16,55 @@
 
 #include <strapper/net/TcpSerializer.h>
 
+#include <strapper/net/Crc32c.h>
 #include <strapper/net/Endian.h>
+#include <strapper/net/Lz4.h>
 #include <strapper/net/SocketError.h>
 
 #include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
 #include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
 
 namespace strapper { namespace net {
 
-TcpSerializer::TcpSerializer(TcpSocket&& socket)
+namespace {
+
+//! Flags byte that follows the length of a string when compression is enabled.
+uint8_t constexpr c_flagCompressed = 0x01;
+
+uint64_t NanosecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr int TcpSerializer::c_maxStringLen;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr int TcpSerializer::c_maxStreamLen;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t TcpSerializer::c_streamChunkSize;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t TcpSerializer::c_defaultCompressionThreshold;
+
+double TcpSerializer::CompressionStats::Ratio() const
+{
+    if (bytesOut == 0)
+        return 1.0;
+    return static_cast<double>(bytesIn) / static_cast<double>(bytesOut);
+}
+
+TcpSerializer::TcpSerializer(TcpSocket&& socket, int maxStringLen /* = c_maxStringLen */)
     : m_socket(std::move(socket))
-{ }
+{
+    SetMaxStringLength(maxStringLen);
+}
 
 TcpSocket const& TcpSerializer::Socket() const
 {
@@ -38,44 +76,91 @@ TcpSocket& TcpSerializer::Socket()
     return m_socket;
 }
 
+int TcpSerializer::MaxStringLength() const
+{
+    return m_maxStringLen;
+}
+
+//! Applies to Write(std::string) and Read(std::string*). Both sides should agree on the limit.
+void TcpSerializer::SetMaxStringLength(int maxStringLen)
+{
+    if (maxStringLen < 0)
+        throw ProgramError("Max string length cannot be less than 0.");
+    if (static_cast<size_t>(maxStringLen) > std::string().max_size())
+        throw ProgramError("Max string length exceeds std::string max size.");
+    m_maxStringLen = maxStringLen;
+}
+
+bool TcpSerializer::ChecksumsEnabled() const
+{
+    return m_checksums;
+}
+
+//! When enabled, every value is followed by a CRC32C of its wire bytes, which is verified on read.
+//! A mismatch is reported as an IntegrityError. Both sides must agree on the setting.
+void TcpSerializer::EnableChecksums(bool enable)
+{
+    m_checksums = enable;
+}
+
+bool TcpSerializer::CompressionEnabled() const
+{
+    return m_compression;
+}
+
+//! When enabled, strings of at least threshold bytes are LZ4 compressed, and are sent compressed if that makes them smaller.
+//! Each string carries a flag saying whether it was compressed. Both sides must agree on the setting, but not the threshold.
+//! Streams are never compressed, but carry the same flag so strings and streams stay interchangeable.
+void TcpSerializer::EnableCompression(bool enable, size_t threshold /* = c_defaultCompressionThreshold */)
+{
+    m_compression = enable;
+    m_compressionThreshold = threshold;
+}
+
+//! The stats are not synchronized. Read them from the thread using the serializer.
+TcpSerializer::CompressionStats const& TcpSerializer::GetCompressionStats() const
+{
+    return m_compressionStats;
+}
+
 void TcpSerializer::Write(char c, ErrorCode* ec /* = nullptr */)
 {
-    m_socket.Write(&c, 1, ec);
+    writeValue(&c, 1, ec);
 }
 
 void TcpSerializer::Write(bool b, ErrorCode* ec /* = nullptr */)
 {
     uint8_t const buf = b ? 1 : 0;
-    m_socket.Write(&buf, 1, ec);
+    writeValue(&buf, 1, ec);
 }
 
 void TcpSerializer::Write(int32_t int32, ErrorCode* ec /* = nullptr */)
 {
     nton(&int32);
-    m_socket.Write(&int32, sizeof(int32), ec);
+    writeValue(&int32, sizeof(int32), ec);
 }
 
 void TcpSerializer::Write(double d, ErrorCode* ec /* = nullptr */)
 {
     nton(&d);
-    m_socket.Write(&d, sizeof(double), ec);
+    writeValue(&d, sizeof(double), ec);
 }
 
 void TcpSerializer::Write(std::string const& s, ErrorCode* ec /* = nullptr */)
 {
     try
     {
-        static_assert(c_maxStringLen >= 0, "Max string length cannot be less than 0.");
-        if (static_cast<size_t>(c_maxStringLen) > s.max_size())
-            throw ProgramError("Max string length exceeds std::string max size.");
-        if (s.length() > static_cast<size_t>(c_maxStringLen))
+        if (s.length() > static_cast<size_t>(m_maxStringLen))
             throw ProgramError("String length exceeds max allowed.");
 
-        int const len = static_cast<int>(s.length());
+        if (m_compression)
+        {
+            writeCompressed(s);
+            return;
+        }
 
-        Write(len);
-        if (len > 0)
-            m_socket.Write(s.c_str(), static_cast<size_t>(len));
+        int32_t const header = nton(static_cast<int32_t>(s.length()));
+        writeFrame(&header, sizeof(header), s.data(), s.length());
     }
     catch (ProgramError const&)
     {
@@ -89,13 +174,13 @@ void TcpSerializer::Write(std::string const& s, ErrorCode* ec /* = nullptr */)
 
 bool TcpSerializer::Read(char* dest, ErrorCode* ec /* = nullptr */)
 {
-    return m_socket.Read(dest, 1, ec);
+    return readValue(dest, 1, ec);
 }
 
 bool TcpSerializer::Read(bool* dest, ErrorCode* ec /* = nullptr */)
 {
     uint8_t buf = 0;
-    if (!m_socket.Read(&buf, 1, ec))
+    if (!readValue(&buf, 1, ec))
         return false;
 
     *dest = (buf == 0 ? false : true);  // NOLINT(readability-simplify-boolean-expr): This is more readable.
@@ -104,7 +189,7 @@ bool TcpSerializer::Read(bool* dest, ErrorCode* ec /* = nullptr */)
 
 bool TcpSerializer::Read(int32_t* dest, ErrorCode* ec /* = nullptr */)
 {
-    if (!m_socket.Read(dest, sizeof(*dest), ec))
+    if (!readValue(dest, sizeof(*dest), ec))
         return false;
 
     nton(dest);
@@ -115,7 +200,7 @@ bool TcpSerializer::Read(double* dest, ErrorCode* ec /* = nullptr */)
 {
     static_assert(sizeof(double) == sizeof(uint64_t), "This function is designed for 64-bit doubles.");
 
-    if (!m_socket.Read(dest, sizeof(*dest), ec))
+    if (!readValue(dest, sizeof(*dest), ec))
         return false;
 
     nton(dest);
@@ -128,25 +213,181 @@ bool TcpSerializer::Read(std::string* dest, ErrorCode* ec /* = nullptr */)
 {
     try
     {
-        static_assert(c_maxStringLen >= 0, "Max string length cannot be less than 0.");
-        if (static_cast<size_t>(c_maxStringLen) > dest->max_size())
-            throw ProgramError("Max string length exceeds std::string max size.");
-
-        int len = 0;
-        if (!Read(&len))
+        int32_t header = 0;
+        if (!m_socket.Read(&header, sizeof(header)))
             return false;
 
-        if (len < 0 || len > c_maxStringLen)  // Other end is corrupted or is not following the protocol.
+        int32_t const len = nton(header);
+        if (len < 0 || len > m_maxStringLen)  // Other end is corrupted or is not following the protocol.
             throw ProgramError("Received bad string size.");
 
-        if (len == 0)
+        if (m_compression)
+            return readCompressed(header, dest);
+
+        dest->resize(static_cast<size_t>(len));
+        if (len > 0 && !m_socket.Read(&*(dest->begin()), static_cast<size_t>(len)))
+            return false;
+
+        if (m_checksums)
+            readTrailer(Crc32c(dest->data(), dest->length(), Crc32c(&header, sizeof(header))));
+        return true;
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return false;
+    }
+}
+
+//----------------------------------------------------------------------------
+
+//! Sends len bytes pulled from source in chunks of at most c_streamChunkSize.
+//! The wire format is the same as Write(std::string), including the flags byte when compression is enabled (the stream
+//! is sent as-is), so small streams can be received with Read(std::string*).
+//! If the transfer fails part-way through, the socket is closed since the other side can no longer find the next value.
+void TcpSerializer::WriteStream(size_t len, StreamSource const& source, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        if (!source)
+            throw ProgramError("Stream source is empty.");
+        if (len > static_cast<size_t>(c_maxStreamLen))
+            throw ProgramError("Stream length exceeds max allowed.");
+
+        // The header goes out with the first chunk and the checksum with the last, so no small writes are held back by Nagle's algorithm.
+        int32_t const header = nton(static_cast<int32_t>(len));
+        std::vector<char> chunk(sizeof(header) + 1 + std::min(len, c_streamChunkSize) + c_checksumLen);
+        std::memcpy(chunk.data(), &header, sizeof(header));
+        size_t used = sizeof(header);
+        if (m_compression)
+            chunk[used++] = 0;  // Flags: Not compressed.
+        bool started = false;
+
+        try
         {
-            *dest = "";
-            return true;
+            uint32_t crc = 0;
+            size_t remaining = len;
+            do
+            {
+                if (remaining > 0)
+                {
+                    size_t const requested = std::min(remaining, c_streamChunkSize);
+                    size_t const supplied = source(chunk.data() + used, requested);
+                    if (supplied == 0 || supplied > requested)
+                        throw ProgramError("Stream source did not supply the promised number of bytes.");
+                    used += supplied;
+                    remaining -= supplied;
+                }
+                if (m_checksums)
+                {
+                    crc = Crc32c(chunk.data(), used, crc);
+                    if (remaining == 0)
+                    {
+                        uint32_t const trailer = nton(crc);
+                        std::memcpy(chunk.data() + used, &trailer, sizeof(trailer));
+                        used += sizeof(trailer);
+                    }
+                }
+                started = true;
+                m_socket.Write(chunk.data(), used);
+                used = 0;
+            } while (remaining > 0);
         }
+        catch (...)
+        {
+            if (started)
+                m_socket.Close();
+            throw;
+        }
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+}
 
-        dest->resize(static_cast<size_t>(len));
-        return m_socket.Read(&*(dest->begin()), static_cast<size_t>(len));
+//! Sends the next len bytes of the input stream.
+void TcpSerializer::WriteStream(std::istream& in, size_t len, ErrorCode* ec /* = nullptr */)
+{
+    WriteStream(
+        len,
+        [&in](char* dest, size_t maxlen) {
+            in.read(dest, static_cast<std::streamsize>(maxlen));
+            return static_cast<size_t>(in.gcount());
+        },
+        ec);
+}
+
+//! Receives a value sent with WriteStream (or Write(std::string)) and passes it to sink in chunks of at most c_streamChunkSize.
+//! The max string length does not apply, since the payload is never held in memory. The exception is a string that was
+//! sent compressed, which is decompressed in memory and so is limited like Read(std::string*).
+//! With checksums enabled, the sink sees all the data before the checksum is verified.
+//! @return False if the other side gracefully closed the connection before the stream started.
+bool TcpSerializer::ReadStream(StreamSink const& sink, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        if (!sink)
+            throw ProgramError("Stream sink is empty.");
+
+        int32_t header = 0;
+        if (!m_socket.Read(&header, sizeof(header)))
+            return false;
+
+        int32_t const len = nton(header);
+        if (len < 0)  // Other end is corrupted or is not following the protocol.
+            throw ProgramError("Received bad stream size.");
+
+        uint32_t crc = Crc32c(&header, sizeof(header));
+        try
+        {
+            if (m_compression)
+            {
+                uint8_t flags = 0;
+                if (!m_socket.Read(&flags, sizeof(flags)))
+                    throw ProgramError("Other side closed before all bytes were received.");
+                crc = Crc32c(&flags, sizeof(flags), crc);
+                if ((flags & ~c_flagCompressed) != 0)
+                    throw ProgramError("Received unknown string flags.");
+                if ((flags & c_flagCompressed) != 0)
+                {
+                    if (len > m_maxStringLen)
+                        throw ProgramError("Received bad string size.");
+                    std::string decompressed;
+                    if (!readCompressedBody(header, crc, &decompressed))
+                        throw ProgramError("Other side closed before all bytes were received.");
+                    for (size_t offset = 0; offset < decompressed.length(); offset += c_streamChunkSize)
+                        sink(decompressed.data() + offset, std::min(decompressed.length() - offset, c_streamChunkSize));
+                    return true;
+                }
+            }
+
+            std::vector<char> chunk(std::min(static_cast<size_t>(len), c_streamChunkSize));
+            auto remaining = static_cast<size_t>(len);
+            while (remaining > 0)
+            {
+                size_t const amount = std::min(remaining, chunk.size());
+                if (!m_socket.Read(chunk.data(), amount))
+                    throw ProgramError("Other side closed before all bytes were received.");
+                if (m_checksums)
+                    crc = Crc32c(chunk.data(), amount, crc);
+                sink(chunk.data(), amount);
+                remaining -= amount;
+            }
+        }
+        catch (...)
+        {
+            m_socket.Close();
+            throw;
+        }
+
+        if (m_checksums)
+            readTrailer(crc);
+        return true;
     }
     catch (ProgramError const&)
     {
@@ -157,4 +398,205 @@ bool TcpSerializer::Read(std::string* dest, ErrorCode* ec /* = nullptr */)
     }
 }
 
+//! Receives a stream and writes it to the output stream.
+bool TcpSerializer::ReadStream(std::ostream& out, ErrorCode* ec /* = nullptr */)
+{
+    return ReadStream(
+        [&out](char const* src, size_t len) {
+            if (!out.write(src, static_cast<std::streamsize>(len)))
+                throw ProgramError("Unable to write to output stream.");
+        },
+        ec);
+}
+
+//----------------------------------------------------------------------------
+
+//! Sends a fixed-size value, followed by its checksum if enabled, in one write.
+void TcpSerializer::writeValue(void const* src, size_t len, ErrorCode* ec)
+{
+    if (!m_checksums)
+    {
+        m_socket.Write(src, len, ec);
+        return;
+    }
+
+    std::array<char, sizeof(double) + c_checksumLen> buf{};
+    assert(len <= sizeof(double));
+    uint32_t const crc = nton(Crc32c(src, len));
+    std::memcpy(buf.data(), src, len);
+    std::memcpy(buf.data() + len, &crc, c_checksumLen);
+    m_socket.Write(buf.data(), len + c_checksumLen, ec);
+}
+
+//! Reads a fixed-size value, and its checksum if enabled.
+bool TcpSerializer::readValue(void* dest, size_t len, ErrorCode* ec)
+{
+    if (!m_checksums)
+        return m_socket.Read(dest, len, ec);
+
+    try
+    {
+        std::array<char, sizeof(double) + c_checksumLen> buf{};
+        assert(len <= sizeof(double));
+        if (!m_socket.Read(buf.data(), len + c_checksumLen))
+            return false;
+
+        uint32_t crc = 0;
+        std::memcpy(&crc, buf.data() + len, c_checksumLen);
+        if (nton(crc) != Crc32c(buf.data(), len))
+            throw IntegrityError();
+
+        std::memcpy(dest, buf.data(), len);
+        return true;
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return false;
+    }
+}
+
+//! Writes a string in the compressed format: [int32 length][uint8 flags][int32 compressed length, if compressed][payload].
+void TcpSerializer::writeCompressed(std::string const& s)
+{
+    std::array<char, sizeof(int32_t) + 1 + sizeof(int32_t)> prefix{};
+    int32_t const header = nton(static_cast<int32_t>(s.length()));
+    std::memcpy(prefix.data(), &header, sizeof(header));
+    size_t prefixLen = sizeof(header) + 1;
+
+    char const* payload = s.data();
+    size_t payloadLen = s.length();
+    if (s.length() >= m_compressionThreshold && !s.empty())
+    {
+        auto const start = std::chrono::steady_clock::now();
+        m_compressionBuffer.resize(Lz4CompressBound(s.length()));
+        size_t const compressedLen = Lz4Compress(s.data(), s.length(), m_compressionBuffer.data(), m_compressionBuffer.size());
+        m_compressionStats.compressNanoseconds += NanosecondsSince(start);
+
+        // Incompressible data is sent as-is.
+        if (compressedLen < s.length())
+        {
+            prefix[sizeof(header)] = static_cast<char>(c_flagCompressed);
+            int32_t const compressedHeader = nton(static_cast<int32_t>(compressedLen));
+            std::memcpy(prefix.data() + prefixLen, &compressedHeader, sizeof(compressedHeader));
+            prefixLen += sizeof(compressedHeader);
+            payload = m_compressionBuffer.data();
+            payloadLen = compressedLen;
+        }
+    }
+
+    if (payload == s.data())
+        ++m_compressionStats.framesStored;
+    else
+        ++m_compressionStats.framesCompressed;
+    m_compressionStats.bytesIn += s.length();
+    m_compressionStats.bytesOut += payloadLen;
+
+    writeFrame(prefix.data(), prefixLen, payload, payloadLen);
+}
+
+//! Reads the rest of a string sent by writeCompressed. The checksum is verified before decompressing.
+bool TcpSerializer::readCompressed(int32_t header, std::string* dest)
+{
+    auto const len = static_cast<size_t>(nton(header));
+    uint32_t crc = Crc32c(&header, sizeof(header));
+
+    uint8_t flags = 0;
+    if (!m_socket.Read(&flags, sizeof(flags)))
+        return false;
+    crc = Crc32c(&flags, sizeof(flags), crc);
+    if ((flags & ~c_flagCompressed) != 0)
+        throw ProgramError("Received unknown string flags.");
+
+    if ((flags & c_flagCompressed) == 0)
+    {
+        dest->resize(len);
+        if (len > 0 && !m_socket.Read(&*(dest->begin()), len))
+            return false;
+        if (m_checksums)
+            readTrailer(Crc32c(dest->data(), dest->length(), crc));
+        return true;
+    }
+    return readCompressedBody(header, crc, dest);
+}
+
+//! Reads the compressed length and payload that follow the flags of a compressed string, and decompresses it.
+//! crc covers the bytes read so far.
+bool TcpSerializer::readCompressedBody(int32_t header, uint32_t crc, std::string* dest)
+{
+    auto const len = static_cast<size_t>(nton(header));
+    int32_t compressedHeader = 0;
+    if (!m_socket.Read(&compressedHeader, sizeof(compressedHeader)))
+        return false;
+    crc = Crc32c(&compressedHeader, sizeof(compressedHeader), crc);
+    int32_t const compressedLen = nton(compressedHeader);
+    if (len == 0 || compressedLen <= 0 || static_cast<size_t>(compressedLen) > Lz4CompressBound(len))
+        throw ProgramError("Received bad compressed string size.");
+
+    m_compressionBuffer.resize(static_cast<size_t>(compressedLen));
+    if (!m_socket.Read(m_compressionBuffer.data(), m_compressionBuffer.size()))
+        return false;
+    if (m_checksums)
+        readTrailer(Crc32c(m_compressionBuffer.data(), m_compressionBuffer.size(), crc));
+
+    auto const start = std::chrono::steady_clock::now();
+    dest->resize(len);
+    if (Lz4Decompress(m_compressionBuffer.data(), m_compressionBuffer.size(), &*(dest->begin()), len) != len)
+        throw ProgramError("Decompressed string size does not match.");
+    m_compressionStats.decompressNanoseconds += NanosecondsSince(start);
+    ++m_compressionStats.framesDecompressed;
+    return true;
+}
+
+//! Sends a prefix and payload, followed by their checksum if enabled, in one write.
+//! Separate small writes would be held back by Nagle's algorithm until the other side acknowledges the first one.
+//! Large payloads are written in place, with only their ends copied next to the prefix and the checksum.
+void TcpSerializer::writeFrame(void const* prefix, size_t prefixLen, void const* payload, size_t payloadLen)
+{
+    size_t const len = prefixLen + payloadLen;
+    if (payloadLen > 2 * c_streamChunkSize)
+    {
+        auto const* const bytes = static_cast<char const*>(payload);
+        size_t const middleLen = payloadLen - 2 * c_streamChunkSize;
+        m_writeBuffer.resize(prefixLen + c_streamChunkSize);
+        std::memcpy(m_writeBuffer.data(), prefix, prefixLen);
+        std::memcpy(m_writeBuffer.data() + prefixLen, bytes, c_streamChunkSize);
+        uint32_t crc = m_checksums ? Crc32c(bytes, payloadLen, Crc32c(prefix, prefixLen)) : 0;
+        m_socket.Write(m_writeBuffer.data(), m_writeBuffer.size());
+        m_socket.Write(bytes + c_streamChunkSize, middleLen);
+        m_writeBuffer.resize(c_streamChunkSize + (m_checksums ? c_checksumLen : 0));
+        std::memcpy(m_writeBuffer.data(), bytes + c_streamChunkSize + middleLen, c_streamChunkSize);
+        if (m_checksums)
+        {
+            crc = nton(crc);
+            std::memcpy(m_writeBuffer.data() + c_streamChunkSize, &crc, c_checksumLen);
+        }
+        m_socket.Write(m_writeBuffer.data(), m_writeBuffer.size());
+        return;
+    }
+
+    m_writeBuffer.resize(len + (m_checksums ? c_checksumLen : 0));
+    std::memcpy(m_writeBuffer.data(), prefix, prefixLen);
+    if (payloadLen > 0)
+        std::memcpy(m_writeBuffer.data() + prefixLen, payload, payloadLen);
+    if (m_checksums)
+    {
+        uint32_t const crc = nton(Crc32c(m_writeBuffer.data(), len));
+        std::memcpy(m_writeBuffer.data() + len, &crc, c_checksumLen);
+    }
+    m_socket.Write(m_writeBuffer.data(), m_writeBuffer.size());
+}
+
+//! @throws IntegrityError If the received checksum doesn't match the given one.
+void TcpSerializer::readTrailer(uint32_t crc)
+{
+    uint32_t received = 0;
+    if (!m_socket.Read(&received, sizeof(received)))
+        throw ProgramError("Other side closed before all bytes were received.");
+    if (nton(received) != crc)
+        throw IntegrityError();
+}
+
 }}  // namespace strapper::net
@@ -17,18 +17,47 @@
 #include <strapper/net/TcpSocket.h>
 
 #include <strapper/net/SocketError.h>
+#include "WorkerPool.h"
 
 #include <cassert>
 #include <cstring>
+#include <memory>
 
 namespace strapper { namespace net {
 
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr unsigned TcpSocket::c_connectAsyncTimeoutMilliseconds;
+
+namespace {
+
+//! Runs async connects. Each one holds a thread until it completes, which its timeout bounds.
+WorkerPool& ConnectPool()
+{
+    static WorkerPool pool(TcpSocket::c_connectThreads);
+    return pool;
+}
+
+//! Async connects always have a timeout, so a few unreachable hosts cannot starve the pool.
+ConnectOptions BoundAsync(ConnectOptions options)
+{
+    if (options.timeout.count() == 0)
+        options.timeout = std::chrono::milliseconds(TcpSocket::c_connectAsyncTimeoutMilliseconds);
+    return options;
+}
+
+}  // namespace
+
 // constructor connects to host:port
 TcpSocket::TcpSocket(std::string const& host, uint16_t port, ErrorCode* ec /*= nullptr */)
+    : TcpSocket(host, port, ConnectOptions(), ec)
+{ }
+
+//! Connects to host:port. See ConnectOptions for how the resolved addresses are tried and the connect is bounded.
+TcpSocket::TcpSocket(std::string const& host, uint16_t port, ConnectOptions const& options, ErrorCode* ec /*= nullptr */)
 {
     try
     {
-        m_socket = TcpBasicSocket(host, port);
+        m_socket = TcpBasicSocket(host, port, options);
         m_state = State::CONNECTED;
     }
     catch (ProgramError const&)
@@ -80,8 +109,66 @@ void swap(TcpSocket& left, TcpSocket& right)
         right.m_readCancel.wait(rightLock, [&right]() { return right.m_state == State::CLOSED; });
 
     using std::swap;
-    swap(left.m_socket, right.m_socket);
+    {
+        std::lock(left.m_swapLock, right.m_swapLock);
+        std::lock_guard<std::mutex> leftSwapLock(left.m_swapLock, std::adopt_lock);
+        std::lock_guard<std::mutex> rightSwapLock(right.m_swapLock, std::adopt_lock);
+        swap(left.m_socket, right.m_socket);
+    }
     swap(left.m_state, right.m_state);
+    swap(left.m_latency, right.m_latency);
+    left.m_timed.store(right.m_timed.exchange(left.m_timed.load()));
+}
+
+//! Connects on a background thread. The future holds the socket, or the error if the connect failed.
+//! A zero timeout in the options is replaced by c_connectAsyncTimeoutMilliseconds, so a black-holed host cannot hold
+//! one of the c_connectThreads for the system's whole retry schedule.
+std::future<TcpSocket> TcpSocket::ConnectAsync(std::string const& host, uint16_t port, ConnectOptions const& options /* = ConnectOptions() */)
+{
+    auto promise = std::make_shared<std::promise<TcpSocket>>();
+    std::future<TcpSocket> future = promise->get_future();
+    ConnectOptions const bounded = BoundAsync(options);
+    ConnectPool().Post([host, port, bounded, promise]() {
+        try
+        {
+            promise->set_value(TcpSocket(host, port, bounded));
+        }
+        catch (...)
+        {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+//! Connects on a background thread and calls back from it with the socket, or with the error and a closed socket.
+//! The timeout is bounded like the future version. Any exception from the connect, not only a ProgramError, is
+//! passed to the callback. The callback must not throw. If it does, the exception is discarded.
+//! A reactor would typically hand the socket over to its own thread from here.
+void TcpSocket::ConnectAsync(std::string const& host, uint16_t port, ConnectOptions const& options, ConnectCallback callback)
+{
+    if (!callback)
+        throw ProgramError("Callback is empty.");
+    ConnectOptions const bounded = BoundAsync(options);
+    ConnectPool().Post([host, port, bounded, callback]() {
+        // Nothing may escape into the pool's thread, which would terminate the process.
+        ErrorCode ec;
+        TcpSocket socket;
+        try
+        {
+            socket = TcpSocket(host, port, bounded, &ec);
+        }
+        catch (...)
+        {
+            ec = ErrorCode(std::current_exception());
+        }
+        try
+        {
+            callback(std::move(socket), ec);
+        }
+        catch (...)
+        { }
+    });
 }
 
 bool TcpSocket::IsOpen() const
@@ -116,6 +203,48 @@ void TcpSocket::SetReadTimeout(unsigned milliseconds, ErrorCode* ec /* = nullptr
     }
 }
 
+//! Unlike SetReadTimeout, this may be called while another thread is reading, e.g. to uncork.
+void TcpSocket::SetOptions(SocketOptions const& options, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_socketLock);
+        if (m_state == State::CLOSED)
+            throw ProgramError("Socket is not connected.");
+        if (m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Socket was closed from another thread.");
+
+        m_socket.SetOptions(options);
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+}
+
+SocketOptions TcpSocket::GetOptions(ErrorCode* ec /* = nullptr */) const
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_socketLock);
+        if (m_state == State::CLOSED)
+            throw ProgramError("Socket is not connected.");
+        if (m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Socket was closed from another thread.");
+
+        return m_socket.GetOptions();
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return {};
+    }
+}
+
 void TcpSocket::ShutdownSend(ErrorCode* ec /* = nullptr */)
 {
     try
@@ -150,6 +279,7 @@ void TcpSocket::ShutdownBoth()
 // Shutdown and close the socket.
 void TcpSocket::Close() noexcept
 {
+    TcpBasicSocket::ZeroCopyReleases released;
     std::unique_lock<std::mutex> lock(m_socketLock);
     switch (m_state)
     {
@@ -162,7 +292,7 @@ void TcpSocket::Close() noexcept
 
     case State::CONNECTED:
         m_state = State::CLOSED;
-        m_socket.Close();
+        m_socket.Close(&released);
         break;
 
     case State::READING:
@@ -172,19 +302,25 @@ void TcpSocket::Close() noexcept
         m_readCancel.wait(lock, [this]() { return m_state == State::CLOSED; });
         break;
     }
+    lock.unlock();
+    TcpBasicSocket::CallReleases(&released);
 }
 
 void TcpSocket::Write(void const* src, size_t len, ErrorCode* ec /* = nullptr */)
 {
     try
     {
+        LatencyTimer const lockTimer(m_timed.load(std::memory_order_relaxed));
         std::unique_lock<std::mutex> lock(m_socketLock);
+        lockTimer.Stop(m_latency.lockWait.get());
         if (m_state == State::CLOSED)
             throw ProgramError("Socket is not connected.");
         if (m_state == State::SHUTTING_DOWN)
             throw ProgramError("Socket was closed from another thread.");
 
+        LatencyTimer const writeTimer(!!m_latency.write);
         m_socket.Write(src, len);
+        writeTimer.Stop(m_latency.write.get());
     }
     catch (ProgramError const&)
     {
@@ -209,6 +345,217 @@ bool TcpSocket::Read(void* dest, size_t len, ErrorCode* ec /* = nullptr */)
     }
 }
 
+//! Receives up to maxLen bytes in place, mapping whole pages from the kernel where the system allows.
+//! See TcpBasicSocket::ReadView. Can be cancelled by closing from another thread, like Read.
+//! @return The received bytes, valid until the next ReadView or Close. Empty if the other side closed.
+ReceiveView TcpSocket::ReadView(size_t maxLen, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        LatencyHistogram* readHistogram = nullptr;
+        {
+            LatencyTimer const lockTimer(m_timed.load(std::memory_order_relaxed));
+            std::lock_guard<std::mutex> lock(m_socketLock);
+            lockTimer.Stop(m_latency.lockWait.get());
+            if (m_state == State::READING || m_state == State::SHUTTING_DOWN)
+                throw ProgramError("Socket is already reading.");
+            if (m_state == State::CLOSED)
+                throw ProgramError("Socket is not connected.");
+            m_state = State::READING;
+            readHistogram = m_latency.read.get();
+        }
+
+        try
+        {
+            LatencyTimer const readTimer(readHistogram != nullptr);
+            ReceiveView const view = m_socket.ReadView(maxLen);
+            readTimer.Stop(readHistogram);
+
+            std::unique_lock<std::mutex> lock(m_socketLock);
+            if (m_state == State::SHUTTING_DOWN)
+                throw ProgramError("Socket was closed from another thread.");
+
+            m_state = State::CONNECTED;
+            return view;
+        }
+        catch (...)
+        {
+            std::unique_lock<std::mutex> lock(m_socketLock);
+            m_state = State::CLOSED;
+            m_readCancel.notify_all();
+            throw;
+        }
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return {};
+    }
+}
+
+//! Sends len bytes of the file, starting at offset, without copying them through user space where the system allows.
+//! Holds the socket for writing like Write.
+//! @return The number of bytes sent. Less than len if the end of the file was reached, or, with ec, if an error occurred.
+size_t TcpSocket::SendFile(int fd, uint64_t offset, size_t len, ErrorCode* ec /* = nullptr */)
+{
+    size_t sent = 0;
+    try
+    {
+        LatencyTimer const lockTimer(m_timed.load(std::memory_order_relaxed));
+        std::unique_lock<std::mutex> lock(m_socketLock);
+        lockTimer.Stop(m_latency.lockWait.get());
+        if (m_state == State::CLOSED)
+            throw ProgramError("Socket is not connected.");
+        if (m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Socket was closed from another thread.");
+
+        LatencyTimer const writeTimer(!!m_latency.write);
+        m_socket.SendFile(fd, offset, len, &sent);
+        writeTimer.Stop(m_latency.write.get());
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+    return sent;
+}
+
+//! Moves up to len bytes arriving on this socket to dest, e.g. for proxying, without copying them through user space where the system allows.
+//! This socket is read like Read, so it can be closed from another thread to stop the transfer.
+//! dest is held for writing one chunk at a time, so the opposite direction can be spliced at the same time.
+//! @return The number of bytes delivered to dest. Less than len if this socket's other side closed, or, with ec, if an error occurred.
+size_t TcpSocket::SpliceTo(TcpSocket& dest, size_t len, ErrorCode* ec /* = nullptr */)
+{
+    size_t moved = 0;
+    try
+    {
+        if (&dest == this)
+            throw ProgramError("Cannot splice a socket to itself.");
+        if (len == 0)
+            throw ProgramError("Length must be greater than 0.");
+
+        {
+            std::lock_guard<std::mutex> lock(m_socketLock);
+            if (m_state == State::READING || m_state == State::SHUTTING_DOWN)
+                throw ProgramError("Socket is already reading.");
+            if (m_state == State::CLOSED)
+                throw ProgramError("Socket is not connected.");
+            m_state = State::READING;
+        }
+
+        try
+        {
+            while (moved < len)
+            {
+                size_t const amount = m_socket.SpliceRead(len - moved);
+                if (amount == 0)
+                    break;
+
+                std::lock_guard<std::mutex> destLock(dest.m_socketLock);
+                if (dest.m_state == State::CLOSED)
+                    throw ProgramError("Destination socket is not connected.");
+                if (dest.m_state == State::SHUTTING_DOWN)
+                    throw ProgramError("Destination socket was closed from another thread.");
+                m_socket.SpliceWrite(dest.m_socket);
+                moved += amount;
+            }
+
+            std::unique_lock<std::mutex> lock(m_socketLock);
+            if (m_state == State::SHUTTING_DOWN)
+                throw ProgramError("Socket was closed from another thread.");
+
+            m_state = State::CONNECTED;
+        }
+        catch (...)
+        {
+            // Spliced data that was not delivered is lost, so this socket cannot be used again.
+            TcpBasicSocket::ZeroCopyReleases released;
+            std::unique_lock<std::mutex> lock(m_socketLock);
+            m_socket.Close(&released);
+            m_state = State::CLOSED;
+            m_readCancel.notify_all();
+            lock.unlock();
+            TcpBasicSocket::CallReleases(&released);
+            throw;
+        }
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+    return moved;
+}
+
+//! Writes len bytes without copying them into the kernel where the system allows. See TcpBasicSocket::WriteZeroCopy.
+//! Release callbacks are called once the socket is unlocked.
+void TcpSocket::WriteZeroCopy(void const* src, size_t len, ZeroCopyCallback onRelease, ErrorCode* ec /* = nullptr */)
+{
+    TcpBasicSocket::ZeroCopyReleases released;
+    try
+    {
+        LatencyTimer const lockTimer(m_timed.load(std::memory_order_relaxed));
+        std::unique_lock<std::mutex> lock(m_socketLock);
+        lockTimer.Stop(m_latency.lockWait.get());
+        if (m_state == State::CLOSED)
+            throw ProgramError("Socket is not connected.");
+        if (m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Socket was closed from another thread.");
+
+        LatencyTimer const writeTimer(!!m_latency.write);
+        m_socket.WriteZeroCopy(src, len, std::move(onRelease), &released);
+        writeTimer.Stop(m_latency.write.get());
+    }
+    catch (ProgramError const&)
+    {
+        TcpBasicSocket::CallReleases(&released);
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+    TcpBasicSocket::CallReleases(&released);
+}
+
+//! Calls the release callback of every completed WriteZeroCopy, waiting up to timeoutMilliseconds for the rest.
+//! Holds the socket for writing while it waits, and calls the callbacks once it is unlocked.
+//! @return The number of writes still outstanding.
+size_t TcpSocket::PollZeroCopy(int timeoutMilliseconds, ErrorCode* ec /* = nullptr */)
+{
+    TcpBasicSocket::ZeroCopyReleases released;
+    size_t outstanding = 0;
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_socketLock);
+        if (m_state == State::CLOSED)
+            throw ProgramError("Socket is not connected.");
+        if (m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Socket was closed from another thread.");
+
+        outstanding = m_socket.PollZeroCopy(timeoutMilliseconds, &released);
+    }
+    catch (ProgramError const&)
+    {
+        TcpBasicSocket::CallReleases(&released);
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return 0;
+    }
+    TcpBasicSocket::CallReleases(&released);
+    return outstanding;
+}
+
+bool TcpSocket::ZeroCopyEnabled() const
+{
+    std::lock_guard<std::mutex> lock(m_socketLock);
+    return m_socket.ZeroCopyEnabled();
+}
+
 // returns the amount of bytes available in the stream
 // guaranteed not to be bigger than the actual number
 // you can read this many bytes without blocking
@@ -236,6 +583,93 @@ unsigned TcpSocket::DataAvailable(ErrorCode* ec /* = nullptr */)
     }
 }
 
+//! Waits until at least one of the sockets can be read without blocking, so one thread can serve many connections.
+//! A socket is also ready when the other side has closed the connection, in which case Read returns false.
+//! Pending WriteZeroCopy completions do not make a socket ready.
+//! The sockets must not be read, closed or moved by other threads while waiting.
+//! @param[in] timeoutMilliseconds Negative waits forever.
+//! @param[out] ready Resized to match sockets. Set to true for each socket that is ready.
+//! @return The number of ready sockets. 0 if the timeout was reached.
+size_t TcpSocket::WaitReadable(std::vector<TcpSocket*> const& sockets, std::vector<bool>* ready, int timeoutMilliseconds, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        std::vector<TcpBasicSocket const*> basicSockets;
+        basicSockets.reserve(sockets.size());
+        for (TcpSocket* socket : sockets)
+        {
+            if (!socket)
+                throw ProgramError("Null pointer.");
+            std::lock_guard<std::mutex> lock(socket->m_socketLock);
+            if (socket->m_state != State::CONNECTED)
+                throw ProgramError("Socket is not connected.");
+            basicSockets.push_back(&socket->m_socket);
+        }
+
+        return TcpBasicSocket::WaitReadable(basicSockets, ready, timeoutMilliseconds);
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return 0;
+    }
+}
+
+//! The counters survive Close, so they can still be read after the connection fails.
+//! Does not wait for a Read or Write in progress, since the counters are atomic.
+SocketStats TcpSocket::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_swapLock);
+    return m_socket.GetStats();
+}
+
+//! Samples the kernel's view of the connection. Cheap enough to poll from a monitoring thread.
+//! Does not wait for a Read or Write in progress.
+TcpInfo TcpSocket::GetTcpInfo(ErrorCode* ec /* = nullptr */) const
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_swapLock);
+        return m_socket.GetTcpInfo();
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return {};
+    }
+}
+
+SocketLatency TcpSocket::GetLatencyHistograms() const
+{
+    std::lock_guard<std::mutex> lock(m_socketLock);
+    return m_latency;
+}
+
+//! Attaches histograms that Read and Write record into. Pass an empty SocketLatency to stop recording.
+//! Cannot be changed while another thread is reading.
+void TcpSocket::SetLatencyHistograms(SocketLatency latency, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_socketLock);
+        if (m_state == State::READING || m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Socket is already reading.");
+
+        m_timed.store(latency.read || latency.write || latency.lockWait, std::memory_order_relaxed);
+        m_latency = std::move(latency);
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+}
+
 TcpSocket::operator bool() const
 {
     return IsOpen();
@@ -243,18 +677,25 @@ TcpSocket::operator bool() const
 
 bool TcpSocket::read(void* dest, size_t len)
 {
+    // Safe to use without the lock while reading, since the histograms cannot be changed until the read finishes.
+    LatencyHistogram* readHistogram = nullptr;
     {
+        LatencyTimer const lockTimer(m_timed.load(std::memory_order_relaxed));
         std::lock_guard<std::mutex> lock(m_socketLock);
+        lockTimer.Stop(m_latency.lockWait.get());
         if (m_state == State::READING || m_state == State::SHUTTING_DOWN)
             throw ProgramError("Socket is already reading.");
         if (m_state == State::CLOSED)
             throw ProgramError("Socket is not connected.");
         m_state = State::READING;
+        readHistogram = m_latency.read.get();
     }
 
     try
     {
+        LatencyTimer const readTimer(readHistogram != nullptr);
         bool const stillConnected = m_socket.Read(dest, len);
+        readTimer.Stop(readHistogram);
 
         std::unique_lock<std::mutex> lock(m_socketLock);
         if (m_state == State::SHUTTING_DOWN)
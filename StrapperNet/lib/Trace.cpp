@@ -0,0 +1,284 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <strapper/net/Trace.h>
+
+#include <strapper/net/SocketError.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+namespace strapper { namespace net {
+
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t Trace::c_defaultRingRecords;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr char Trace::c_magic[8];
+
+std::atomic<bool> Trace::s_enabled{ false };
+
+namespace {
+
+//! Written only by its own thread. m_written only grows, so a reader can tell which records are valid.
+struct TraceRing
+{
+    TraceRing(size_t capacity, uint32_t thread)
+        : m_records(capacity)
+        , m_thread(thread)
+    { }
+
+    std::vector<TraceRecord> m_records;
+    std::atomic<uint64_t> m_written{ 0 };
+    uint32_t const m_thread;
+};
+
+struct TraceRings
+{
+    std::mutex m_lock;
+    std::vector<std::shared_ptr<TraceRing>> m_rings;
+    size_t m_ringRecords = Trace::c_defaultRingRecords;
+    uint32_t m_nextThread = 1;
+};
+
+TraceRings& Rings()
+{
+    static TraceRings rings;
+    return rings;
+}
+
+uint32_t const c_version = 1;
+uint32_t const c_recordSize = sizeof(TraceRecord);
+
+char const* EventName(uint16_t event)
+{
+    switch (static_cast<TraceEvent>(event))
+    {
+    case TraceEvent::TCP_CONNECT: return "tcp_connect";
+    case TraceEvent::TCP_ACCEPT: return "tcp_accept";
+    case TraceEvent::TCP_READ_START:
+    case TraceEvent::TCP_READ_END: return "tcp_read";
+    case TraceEvent::TCP_WRITE_START:
+    case TraceEvent::TCP_WRITE_END: return "tcp_write";
+    case TraceEvent::TCP_CLOSE: return "tcp_close";
+    case TraceEvent::UDP_BIND: return "udp_bind";
+    case TraceEvent::UDP_READ_START:
+    case TraceEvent::UDP_READ_END: return "udp_read";
+    case TraceEvent::UDP_WRITE_START:
+    case TraceEvent::UDP_WRITE_END: return "udp_write";
+    case TraceEvent::UDP_CLOSE: return "udp_close";
+    }
+    return "unknown";
+}
+
+bool IsStart(uint16_t event)
+{
+    auto const e = static_cast<TraceEvent>(event);
+    return e == TraceEvent::TCP_READ_START || e == TraceEvent::TCP_WRITE_START || e == TraceEvent::UDP_READ_START || e == TraceEvent::UDP_WRITE_START;
+}
+
+bool IsEnd(uint16_t event)
+{
+    auto const e = static_cast<TraceEvent>(event);
+    return e == TraceEvent::TCP_READ_END || e == TraceEvent::TCP_WRITE_END || e == TraceEvent::UDP_READ_END || e == TraceEvent::UDP_WRITE_END;
+}
+
+//! Microseconds, keeping nanosecond resolution.
+void WriteMicroseconds(std::ostream& out, uint64_t nanoseconds)
+{
+    char fraction[4];
+    std::snprintf(fraction, sizeof(fraction), "%03u", static_cast<unsigned>(nanoseconds % 1000));
+    out << nanoseconds / 1000 << '.' << fraction;
+}
+
+void WriteEvent(std::ostream& out, bool& first, TraceRecord const& record, uint64_t origin, TraceRecord const* end)
+{
+    out << (first ? "\n" : ",\n");
+    first = false;
+    auto const e = static_cast<TraceEvent>(record.event);
+    char const* category = e >= TraceEvent::UDP_BIND ? "udp" : "tcp";
+    out << R"({"name":")" << EventName(record.event) << R"(","cat":")" << category << R"(","pid":1,"tid":)" << record.thread << R"(,"ts":)";
+    WriteMicroseconds(out, record.nanoseconds - origin);
+    if (end)
+    {
+        out << R"(,"ph":"X","dur":)";
+        WriteMicroseconds(out, end->nanoseconds - record.nanoseconds);
+        out << R"(,"args":{"socket":)" << record.socket << R"(,"requested":)" << record.value << R"(,"result":)" << end->value << "}}";
+        return;
+    }
+    out << R"(,"ph":"i","s":"t","args":{"socket":)" << record.socket;
+    if (IsStart(record.event))
+        out << R"(,"requested":)" << record.value << R"(,"incomplete":true)";
+    else if (IsEnd(record.event))
+        out << R"(,"result":)" << record.value << R"(,"incomplete":true)";
+    else if (e == TraceEvent::TCP_CONNECT || e == TraceEvent::UDP_BIND)
+        out << R"(,"port":)" << record.value;
+    out << "}}";
+}
+
+}  // namespace
+
+//! Sets the size of rings created from now on, which only affects threads that have not recorded yet.
+//! A thread keeps the ring it already has, at its old size, for as long as it runs.
+void Trace::SetRingRecords(size_t records)
+{
+    if (records == 0)
+        throw ProgramError("Ring must hold at least one record.");
+    std::lock_guard<std::mutex> lock(Rings().m_lock);
+    Rings().m_ringRecords = records;
+}
+
+void Trace::record(TraceEvent event, int64_t socket, int64_t value) noexcept
+{
+    thread_local std::shared_ptr<TraceRing> ring;
+    if (!ring)
+    {
+        try
+        {
+            TraceRings& rings = Rings();
+            std::lock_guard<std::mutex> lock(rings.m_lock);
+            ring = std::make_shared<TraceRing>(rings.m_ringRecords, rings.m_nextThread++);
+            rings.m_rings.push_back(ring);
+        }
+        catch (std::exception const&)
+        {
+            return;  // Out of memory. Tracing is best effort.
+        }
+    }
+
+    uint64_t const written = ring->m_written.load(std::memory_order_relaxed);
+    TraceRecord& record = ring->m_records[written % ring->m_records.size()];
+    record.nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    record.socket = socket;
+    record.value = value;
+    record.thread = ring->m_thread;
+    record.event = static_cast<uint16_t>(event);
+    record.reserved = 0;
+    ring->m_written.store(written + 1, std::memory_order_release);
+}
+
+//! Writes every thread's ring, oldest record first.
+//! Disable tracing first for an exact dump. Otherwise the newest records of busy threads may be torn.
+//! @return The number of records written.
+size_t Trace::Dump(std::ostream& out)
+{
+    out.write(c_magic, sizeof(c_magic));
+    out.write(reinterpret_cast<char const*>(&c_version), sizeof(c_version));        // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    out.write(reinterpret_cast<char const*>(&c_recordSize), sizeof(c_recordSize));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+    size_t total = 0;
+    TraceRings& rings = Rings();
+    std::lock_guard<std::mutex> lock(rings.m_lock);
+    for (auto const& ring : rings.m_rings)
+    {
+        uint64_t const written = ring->m_written.load(std::memory_order_acquire);
+        uint64_t const capacity = ring->m_records.size();
+        uint64_t const count = std::min(written, capacity);
+        for (uint64_t i = written - count; i < written; ++i)
+            out.write(reinterpret_cast<char const*>(&ring->m_records[i % capacity]), sizeof(TraceRecord));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        total += count;
+    }
+    if (!out)
+        throw ProgramError("Failed to write trace.");
+    return total;
+}
+
+size_t Trace::Dump(std::string const& path)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        throw ProgramError("Could not open " + path + " for writing.");
+    return Dump(out);
+}
+
+//! Discards all records, and the rings of threads that have exited. Call while tracing is disabled.
+void Trace::Clear()
+{
+    TraceRings& rings = Rings();
+    std::lock_guard<std::mutex> lock(rings.m_lock);
+    auto const exited = [](std::shared_ptr<TraceRing> const& ring) { return ring.use_count() == 1; };
+    rings.m_rings.erase(std::remove_if(rings.m_rings.begin(), rings.m_rings.end(), exited), rings.m_rings.end());
+    for (auto const& ring : rings.m_rings)
+        ring->m_written.store(0, std::memory_order_relaxed);
+}
+
+//! Parses a file written by Dump.
+std::vector<TraceRecord> Trace::Read(std::istream& in)
+{
+    char magic[sizeof(c_magic)] = {};
+    uint32_t version = 0;
+    uint32_t recordSize = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));        // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    in.read(reinterpret_cast<char*>(&recordSize), sizeof(recordSize));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (!in || std::memcmp(magic, c_magic, sizeof(c_magic)) != 0)
+        throw ProgramError("Not a StrapperNet trace.");
+    if (version != c_version || recordSize != c_recordSize)
+        throw ProgramError("Unsupported trace version.");
+
+    std::vector<TraceRecord> records;
+    TraceRecord record{};
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record)))  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        records.push_back(record);
+    if (in.gcount() != 0)
+        throw ProgramError("Trace ends with a partial record.");
+    return records;
+}
+
+//! Writes records in the Chrome trace event format, for chrome://tracing or Perfetto.
+//! Each thread is a track. A system call's start and end records become one complete event.
+//! Times are relative to the earliest record.
+void Trace::WriteChromeJson(std::vector<TraceRecord> records, std::ostream& out)
+{
+    std::stable_sort(records.begin(), records.end(), [](TraceRecord const& left, TraceRecord const& right) { return left.nanoseconds < right.nanoseconds; });
+    uint64_t const origin = records.empty() ? 0 : records.front().nanoseconds;
+
+    // A thread is in at most one system call at a time, so a start is matched by that thread's next record.
+    std::unordered_map<uint32_t, TraceRecord> started;
+    bool first = true;
+    out << R"({"displayTimeUnit":"ns","traceEvents":[)";
+    for (TraceRecord const& record : records)
+    {
+        auto const pending = started.find(record.thread);
+        if (pending != started.end())
+        {
+            TraceRecord const start = pending->second;
+            started.erase(pending);
+            if (IsEnd(record.event) && record.event == start.event + 1 && record.socket == start.socket)
+            {
+                WriteEvent(out, first, start, origin, &record);
+                continue;
+            }
+            WriteEvent(out, first, start, origin, nullptr);
+        }
+        if (IsStart(record.event))
+            started[record.thread] = record;
+        else
+            WriteEvent(out, first, record, origin, nullptr);
+    }
+    for (auto const& pending : started)
+        WriteEvent(out, first, pending.second, origin, nullptr);
+    out << "\n]}\n";
+}
+
+}}  // namespace strapper::net
@@ -16,9 +16,12 @@
 
 #include <strapper/net/UdpSocket.h>
 
+#include <strapper/net/Crc32c.h>
+#include <strapper/net/Endian.h>
 #include <strapper/net/SocketError.h>
 
 #include <cassert>
+#include <cstring>
 
 namespace strapper { namespace net {
 
@@ -74,6 +77,9 @@ void swap(UdpSocket& left, UdpSocket& right)
     using std::swap;
     swap(left.m_socket, right.m_socket);
     swap(left.m_state, right.m_state);
+    swap(left.m_checksums, right.m_checksums);
+    swap(left.m_latency, right.m_latency);
+    left.m_timed.store(right.m_timed.exchange(left.m_timed.load()));
 }
 
 bool UdpSocket::IsOpen() const
@@ -108,6 +114,63 @@ void UdpSocket::SetReadTimeout(unsigned milliseconds, ErrorCode* ec /* = nullptr
     }
 }
 
+//! Unlike SetReadTimeout, this may be called while another thread is reading.
+void UdpSocket::SetOptions(SocketOptions const& options, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_socketLock);
+        if (m_state == State::CLOSED)
+            throw ProgramError("Socket is not open.");
+        if (m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Socket was closed from another thread.");
+
+        m_socket.SetOptions(options);
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+}
+
+SocketOptions UdpSocket::GetOptions(ErrorCode* ec /* = nullptr */) const
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_socketLock);
+        if (m_state == State::CLOSED)
+            throw ProgramError("Socket is not open.");
+        if (m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Socket was closed from another thread.");
+
+        return m_socket.GetOptions();
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return {};
+    }
+}
+
+bool UdpSocket::ChecksumsEnabled() const
+{
+    std::lock_guard<std::mutex> lock(m_socketLock);
+    return m_checksums;
+}
+
+//! When enabled, each datagram carries a CRC32C trailer that is verified and removed on read.
+//! A mismatch is reported as an IntegrityError. The read buffer must have room for the trailer (c_checksumLen bytes).
+//! Both sides must agree on the setting.
+void UdpSocket::EnableChecksums(bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_socketLock);
+    m_checksums = enable;
+}
+
 // Shutdown and close the socket.
 void UdpSocket::Close() noexcept
 {
@@ -135,17 +198,33 @@ void UdpSocket::Close() noexcept
     }
 }
 
-void UdpSocket::Write(void const* src, size_t len, IpAddressV4 const& ipAddress, uint16_t port, ErrorCode* ec /* = nullptr */)
+void UdpSocket::Write(void const* src, size_t len, IpAddress const& ipAddress, uint16_t port, ErrorCode* ec /* = nullptr */)
 {
     try
     {
+        LatencyTimer const lockTimer(m_timed.load(std::memory_order_relaxed));
         std::unique_lock<std::mutex> lock(m_socketLock);
+        lockTimer.Stop(m_latency.lockWait.get());
         if (m_state == State::CLOSED)
             throw ProgramError("Socket is not open.");
         if (m_state == State::SHUTTING_DOWN)
             throw ProgramError("Socket was closed from another thread.");
 
-        return m_socket.Write(src, len, ipAddress, port);
+        if (m_checksums)
+        {
+            if (!src)
+                throw ProgramError("Null pointer.");
+            uint32_t const crc = nton(Crc32c(src, len));
+            m_writeBuffer.resize(len + c_checksumLen);
+            std::memcpy(m_writeBuffer.data(), src, len);
+            std::memcpy(m_writeBuffer.data() + len, &crc, c_checksumLen);
+            src = m_writeBuffer.data();
+            len = m_writeBuffer.size();
+        }
+
+        LatencyTimer const writeTimer(!!m_latency.write);
+        m_socket.Write(src, len, ipAddress, port);
+        writeTimer.Stop(m_latency.write.get());
     }
     catch (ProgramError const&)
     {
@@ -155,7 +234,7 @@ void UdpSocket::Write(void const* src, size_t len, IpAddressV4 const& ipAddress,
     }
 }
 
-unsigned UdpSocket::Read(void* dest, size_t maxlen, IpAddressV4* out_ipAddress, uint16_t* out_port, ErrorCode* ec /* = nullptr */)
+unsigned UdpSocket::Read(void* dest, size_t maxlen, IpAddress* out_ipAddress, uint16_t* out_port, ErrorCode* ec /* = nullptr */)
 {
     try
     {
@@ -170,6 +249,36 @@ unsigned UdpSocket::Read(void* dest, size_t maxlen, IpAddressV4* out_ipAddress,
     }
 }
 
+//! For IPv4-only callers. A datagram from an IPv6 sender is consumed and reported as an error.
+unsigned UdpSocket::Read(void* dest, size_t maxlen, IpAddressV4* out_ipAddress, uint16_t* out_port, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        IpAddress ip;
+        unsigned const amountRead = read(dest, maxlen, out_ipAddress ? &ip : nullptr, out_port);
+        if (out_ipAddress)
+        {
+            if (!ip.IsV4())
+                throw ProgramError("Sender has an IPv6 address: '" + ip.ToString() + "'. Use the IpAddress overload.");
+            *out_ipAddress = ip.V4();
+        }
+        return amountRead;
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+        return 0;
+    }
+}
+
+//! Resolves the ambiguity between the address overloads when the sender's address isn't wanted.
+unsigned UdpSocket::Read(void* dest, size_t maxlen, std::nullptr_t, uint16_t* out_port, ErrorCode* ec /* = nullptr */)
+{
+    return Read(dest, maxlen, static_cast<IpAddress*>(nullptr), out_port, ec);
+}
+
 // returns the total amount of data in the buffer.
 // A call to Read will not necessarily return this much data, since the buffer may contain many datagrams
 unsigned UdpSocket::DataAvailable(ErrorCode* ec /* = nullptr */) const
@@ -195,32 +304,75 @@ unsigned UdpSocket::DataAvailable(ErrorCode* ec /* = nullptr */) const
     }
 }
 
+//! The counters survive Close, so they can still be read after the socket fails.
+SocketStats UdpSocket::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_socketLock);
+    return m_socket.GetStats();
+}
+
+SocketLatency UdpSocket::GetLatencyHistograms() const
+{
+    std::lock_guard<std::mutex> lock(m_socketLock);
+    return m_latency;
+}
+
+//! Attaches histograms that Read and Write record into. Pass an empty SocketLatency to stop recording.
+//! Cannot be changed while another thread is reading.
+void UdpSocket::SetLatencyHistograms(SocketLatency latency, ErrorCode* ec /* = nullptr */)
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_socketLock);
+        if (m_state == State::READING || m_state == State::SHUTTING_DOWN)
+            throw ProgramError("Socket is already reading.");
+
+        m_timed.store(latency.read || latency.write || latency.lockWait, std::memory_order_relaxed);
+        m_latency = std::move(latency);
+    }
+    catch (ProgramError const&)
+    {
+        if (!ec)
+            throw;
+        *ec = ErrorCode(std::current_exception());
+    }
+}
+
 UdpSocket::operator bool() const
 {
     return IsOpen();
 }
 
-unsigned UdpSocket::read(void* dest, size_t maxlen, IpAddressV4* out_ipAddress, uint16_t* out_port)
+unsigned UdpSocket::read(void* dest, size_t maxlen, IpAddress* out_ipAddress, uint16_t* out_port)
 {
+    bool checksums = false;
+    // Safe to use without the lock while reading, since the histograms cannot be changed until the read finishes.
+    LatencyHistogram* readHistogram = nullptr;
     {
+        LatencyTimer const lockTimer(m_timed.load(std::memory_order_relaxed));
         std::lock_guard<std::mutex> lock(m_socketLock);
+        lockTimer.Stop(m_latency.lockWait.get());
         if (m_state == State::READING || m_state == State::SHUTTING_DOWN)
             throw ProgramError("Socket is already reading.");
         if (m_state == State::CLOSED)
             throw ProgramError("Socket is not open.");
         m_state = State::READING;
+        checksums = m_checksums;
+        readHistogram = m_latency.read.get();
     }
 
+    unsigned amountRead = 0;
     try
     {
-        auto amountRead = m_socket.Read(dest, maxlen, out_ipAddress, out_port);
+        LatencyTimer const readTimer(readHistogram != nullptr);
+        amountRead = m_socket.Read(dest, maxlen, out_ipAddress, out_port);
+        readTimer.Stop(readHistogram);
 
         std::unique_lock<std::mutex> lock(m_socketLock);
         if (m_state == State::SHUTTING_DOWN)
             throw ProgramError("Socket was closed from another thread.");
 
         m_state = State::OPEN;
-        return amountRead;
     }
     catch (...)
     {
@@ -235,6 +387,18 @@ unsigned UdpSocket::read(void* dest, size_t maxlen, IpAddressV4* out_ipAddress,
             m_state = State::OPEN;
         throw;
     }
+
+    if (checksums)
+    {
+        if (amountRead < c_checksumLen)
+            throw IntegrityError("Datagram is too short to hold a checksum.");
+        amountRead -= static_cast<unsigned>(c_checksumLen);
+        uint32_t crc = 0;
+        std::memcpy(&crc, static_cast<char const*>(dest) + amountRead, c_checksumLen);
+        if (nton(crc) != Crc32c(dest, amountRead))
+            throw IntegrityError();
+    }
+    return amountRead;
 }
 
 }}  // namespace strapper::net
@@ -0,0 +1,74 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include "WorkerPool.h"
+
+#include <strapper/net/SocketError.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace strapper { namespace net {
+
+WorkerPool::WorkerPool(unsigned threads)
+    : m_threadCount(std::max(1u, threads))
+{ }
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueLock);
+        m_stopping = true;
+    }
+    m_queueReady.notify_all();
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+void WorkerPool::Post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueLock);
+        if (m_stopping)
+            throw ProgramError("Worker pool is shutting down.");
+        m_queue.push_back(std::move(task));
+        if (m_workers.empty())
+        {
+            for (unsigned i = 0; i < m_threadCount; ++i)
+                m_workers.emplace_back(&WorkerPool::work, this);
+        }
+    }
+    m_queueReady.notify_one();
+}
+
+void WorkerPool::work()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_queueLock);
+            m_queueReady.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty())
+                return;
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        task();
+    }
+}
+
+}}  // namespace strapper::net
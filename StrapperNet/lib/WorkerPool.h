@@ -0,0 +1,53 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace strapper { namespace net {
+
+//! A fixed set of threads that run posted tasks in order.
+//! The threads are started by the first Post, so an unused pool costs nothing.
+class WorkerPool
+{
+public:
+    explicit WorkerPool(unsigned threads);
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+    //! Runs the tasks still queued, then joins the threads.
+    ~WorkerPool();
+
+    //! Tasks must not throw.
+    void Post(std::function<void()> task);
+
+private:
+    void work();
+
+    unsigned const m_threadCount;
+    std::mutex m_queueLock;
+    std::condition_variable m_queueReady;
+    std::deque<std::function<void()>> m_queue;
+    std::vector<std::thread> m_workers;
+    bool m_stopping = false;
+};
+
+}}  // namespace strapper::net
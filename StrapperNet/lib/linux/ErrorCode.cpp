@@ -22,6 +22,7 @@
 #include <sys/socket.h>
 
 #include <cassert>
+#include <exception>
 
 namespace strapper { namespace net {
 
@@ -108,10 +109,23 @@ ErrorCode::ErrorCode(std::exception_ptr exception)
             m_nativeErrorCode = e.NativeCode();
             m_what = e.what();
         }
+        catch (IntegrityError const& e)
+        {
+            m_integrityError = true;
+            m_what = e.what();
+        }
         catch (ProgramError const& e)
         {
             m_what = e.what();
         }
+        catch (std::exception const& e)
+        {
+            m_what = e.what();
+        }
+        catch (...)
+        {
+            m_what = "Unknown exception.";
+        }
     }
 }
 
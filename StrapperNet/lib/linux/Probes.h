@@ -0,0 +1,87 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+// Static USDT probe points for bpftrace, perf and SystemTap, in the format of <sys/sdt.h>.
+// Written out here so there is no build or runtime dependency on systemtap-sdt-dev.
+// Each probe is a single nop plus an ELF note describing where its arguments live.
+// Nothing runs unless a tracer attaches, which replaces the nop with a breakpoint.
+//
+// Probes, all in provider strapper_net. Every argument is a signed 64-bit integer.
+//   tcp_connect(fd, port)                 tcp_shutdown(fd, how)      tcp_close(fd)
+//   tcp_read_start(fd, len)               tcp_read_end(fd, result)
+//   tcp_write_start(fd, len)              tcp_write_end(fd, result)
+//   udp_bind(fd, port)                    udp_shutdown(fd)           udp_close(fd)
+//   udp_read_start(fd, maxlen)            udp_read_end(fd, result)
+//   udp_write_start(fd, len, port)        udp_write_end(fd, result)
+//   listener_listen(fd, port)             listener_shutdown(fd)      listener_close(fd)
+//   listener_accept_start(fd)             listener_accept_end(fd, result)
+// result is the system call's return value: a byte count or new fd, or -1 on error.
+// The *_start/*_end pairs bracket each system call, so a retried or continued call fires them again.
+//
+// e.g. bpftrace -e 'usdt:./EchoServer:strapper_net:tcp_read_end { @bytes = hist(arg1); }'
+
+#pragma once
+
+#include <cstdint>
+
+#if STRAPPER_NET_USDT && defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__)) && (defined(__GNUC__) || defined(__clang__))
+
+    // The note layout is that of SystemTap's sdt.h, version 3. Operands are formatted as "-8@<location>", a signed
+    // 8-byte value in whatever register, memory location or immediate the compiler chose.
+    #define STRAPPER_NET_SDT_PROBE(name, argFormat, ...)                                                  \
+        __asm__ __volatile__("990: nop\n"                                                                 \
+                             ".pushsection .note.stapsdt,\"\",\"note\"\n"                                 \
+                             ".balign 4\n"                                                                \
+                             ".4byte 992f-991f, 994f-993f, 3\n"                                           \
+                             "991: .asciz \"stapsdt\"\n"                                                  \
+                             "992: .balign 4\n"                                                           \
+                             "993: .8byte 990b\n"                                                         \
+                             ".8byte _.stapsdt.base\n"                                                    \
+                             ".8byte 0\n"                                                                 \
+                             ".asciz \"strapper_net\"\n"                                                  \
+                             ".asciz \"" #name "\"\n"                                                     \
+                             ".asciz \"" argFormat "\"\n"                                                 \
+                             "994: .balign 4\n"                                                           \
+                             ".popsection\n"                                                              \
+                             ".ifndef _.stapsdt.base\n"                                                   \
+                             ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"      \
+                             ".weak _.stapsdt.base\n"                                                     \
+                             ".hidden _.stapsdt.base\n"                                                   \
+                             "_.stapsdt.base: .space 1\n"                                                 \
+                             ".size _.stapsdt.base, 1\n"                                                  \
+                             ".popsection\n"                                                              \
+                             ".endif\n"                                                                   \
+                             :                                                                            \
+                             : __VA_ARGS__)
+
+    #define STRAPPER_NET_PROBE1(name, arg1) \
+        STRAPPER_NET_SDT_PROBE(name, "-8@%[p1]", [p1] "nor"(static_cast<int64_t>(arg1)))
+    #define STRAPPER_NET_PROBE2(name, arg1, arg2)          \
+        STRAPPER_NET_SDT_PROBE(name, "-8@%[p1] -8@%[p2]", \
+                               [p1] "nor"(static_cast<int64_t>(arg1)), [p2] "nor"(static_cast<int64_t>(arg2)))
+    #define STRAPPER_NET_PROBE3(name, arg1, arg2, arg3)               \
+        STRAPPER_NET_SDT_PROBE(name, "-8@%[p1] -8@%[p2] -8@%[p3]",   \
+                               [p1] "nor"(static_cast<int64_t>(arg1)), \
+                               [p2] "nor"(static_cast<int64_t>(arg2)), \
+                               [p3] "nor"(static_cast<int64_t>(arg3)))
+
+#else
+
+    #define STRAPPER_NET_PROBE1(name, arg1) static_cast<void>(0)
+    #define STRAPPER_NET_PROBE2(name, arg1, arg2) static_cast<void>(0)
+    #define STRAPPER_NET_PROBE3(name, arg1, arg2, arg3) static_cast<void>(0)
+
+#endif
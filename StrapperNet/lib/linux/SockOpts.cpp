@@ -0,0 +1,134 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include "SockOpts.h"
+
+#include <strapper/net/SocketError.h>
+#include "SocketFd.h"
+
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <chrono>
+#include <limits>
+
+namespace strapper { namespace net {
+
+namespace {
+
+void SetInt(SocketHandle const& socket, int level, int name, int value)
+{
+    if (setsockopt(**socket, level, name, &value, sizeof(value)) == SocketFd::SOCKET_ERROR)
+        throw SocketError(errno);
+}
+
+int GetInt(SocketHandle const& socket, int level, int name)
+{
+    int value = 0;
+    socklen_t len = sizeof(value);
+    if (getsockopt(**socket, level, name, &value, &len) == SocketFd::SOCKET_ERROR)
+        throw SocketError(errno);
+    return value;
+}
+
+int Family(SocketHandle const& socket)
+{
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (getsockname(**socket, reinterpret_cast<sockaddr*>(&addr), &len) == SocketFd::SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        throw SocketError(errno);
+    return addr.ss_family;
+}
+
+template <typename Rep, typename Period>
+int ToInt(std::chrono::duration<Rep, Period> value)
+{
+    if (value.count() < 0 || value.count() > std::numeric_limits<int>::max())
+        throw ProgramError("Socket option duration is out of range.");
+    return static_cast<int>(value.count());
+}
+
+}  // namespace
+
+void ApplySocketOptions(SocketHandle const& socket, SocketOptions const& options)
+{
+    if (options.noDelay.IsSet())
+        SetInt(socket, IPPROTO_TCP, TCP_NODELAY, options.noDelay.Get() ? 1 : 0);
+    if (options.cork.IsSet())
+        SetInt(socket, IPPROTO_TCP, TCP_CORK, options.cork.Get() ? 1 : 0);
+    if (options.quickAck.IsSet())
+        SetInt(socket, IPPROTO_TCP, TCP_QUICKACK, options.quickAck.Get() ? 1 : 0);
+    if (options.sendBufferSize.IsSet())
+        SetInt(socket, SOL_SOCKET, SO_SNDBUF, options.sendBufferSize.Get());
+    if (options.receiveBufferSize.IsSet())
+        SetInt(socket, SOL_SOCKET, SO_RCVBUF, options.receiveBufferSize.Get());
+    if (options.keepAlive.IsSet())
+    {
+        KeepAlive const& keepAlive = options.keepAlive.Get();
+        SetInt(socket, SOL_SOCKET, SO_KEEPALIVE, keepAlive.enable ? 1 : 0);
+        if (keepAlive.idle.count() > 0)
+            SetInt(socket, IPPROTO_TCP, TCP_KEEPIDLE, ToInt(keepAlive.idle));
+        if (keepAlive.interval.count() > 0)
+            SetInt(socket, IPPROTO_TCP, TCP_KEEPINTVL, ToInt(keepAlive.interval));
+        if (keepAlive.count > 0)
+            SetInt(socket, IPPROTO_TCP, TCP_KEEPCNT, static_cast<int>(keepAlive.count));
+    }
+    if (options.userTimeout.IsSet())
+        SetInt(socket, IPPROTO_TCP, TCP_USER_TIMEOUT, ToInt(options.userTimeout.Get()));
+    if (options.notSentLowWatermark.IsSet())
+        SetInt(socket, IPPROTO_TCP, TCP_NOTSENT_LOWAT, options.notSentLowWatermark.Get());
+    if (options.maxSegmentSize.IsSet())
+        SetInt(socket, IPPROTO_TCP, TCP_MAXSEG, options.maxSegmentSize.Get());
+    if (options.tos.IsSet())
+    {
+        if (Family(socket) == AF_INET6)
+        {
+            SetInt(socket, IPPROTO_IPV6, IPV6_TCLASS, options.tos.Get());
+            // A dual-stack socket carrying IPv4 traffic marks it with IP_TOS instead. Best effort.
+            setsockopt(**socket, IPPROTO_IP, IP_TOS, &options.tos.Get(), sizeof(int));
+        }
+        else
+            SetInt(socket, IPPROTO_IP, IP_TOS, options.tos.Get());
+    }
+}
+
+SocketOptions QuerySocketOptions(SocketHandle const& socket)
+{
+    SocketOptions options;
+    options.sendBufferSize = GetInt(socket, SOL_SOCKET, SO_SNDBUF);
+    options.receiveBufferSize = GetInt(socket, SOL_SOCKET, SO_RCVBUF);
+    options.tos = Family(socket) == AF_INET6 ? GetInt(socket, IPPROTO_IPV6, IPV6_TCLASS) : GetInt(socket, IPPROTO_IP, IP_TOS);
+    if (GetInt(socket, SOL_SOCKET, SO_TYPE) != SOCK_STREAM)
+        return options;
+
+    options.noDelay = GetInt(socket, IPPROTO_TCP, TCP_NODELAY) != 0;
+    options.cork = GetInt(socket, IPPROTO_TCP, TCP_CORK) != 0;
+    options.quickAck = GetInt(socket, IPPROTO_TCP, TCP_QUICKACK) != 0;
+    KeepAlive keepAlive;
+    keepAlive.enable = GetInt(socket, SOL_SOCKET, SO_KEEPALIVE) != 0;
+    keepAlive.idle = std::chrono::seconds(GetInt(socket, IPPROTO_TCP, TCP_KEEPIDLE));
+    keepAlive.interval = std::chrono::seconds(GetInt(socket, IPPROTO_TCP, TCP_KEEPINTVL));
+    keepAlive.count = static_cast<unsigned>(GetInt(socket, IPPROTO_TCP, TCP_KEEPCNT));
+    options.keepAlive = keepAlive;
+    options.userTimeout = std::chrono::milliseconds(GetInt(socket, IPPROTO_TCP, TCP_USER_TIMEOUT));
+    options.notSentLowWatermark = GetInt(socket, IPPROTO_TCP, TCP_NOTSENT_LOWAT);
+    options.maxSegmentSize = GetInt(socket, IPPROTO_TCP, TCP_MAXSEG);
+    return options;
+}
+
+}}  // namespace strapper::net
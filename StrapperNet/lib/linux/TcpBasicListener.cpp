@@ -17,52 +17,42 @@
 #include <strapper/net/TcpBasicListener.h>
 
 #include <strapper/net/SocketError.h>
+#include "Probes.h"
+#include "SockAddr.h"
+#include "SockOpts.h"
 #include "SocketFd.h"
 
-#include <netdb.h>
 #include <sys/socket.h>
 
 #include <cassert>
-#include <memory>
 
 namespace strapper { namespace net {
 
 namespace {
 
-SocketHandle Start(uint16_t port)
+// Listens on all interfaces. The socket is dual-stack, so IPv4 clients are accepted as IPv4-mapped peers.
+SocketHandle Start(uint16_t port, SocketOptions const& options)
 {
-    addrinfo hostInfo{};
-    hostInfo.ai_family = AF_INET;
-    hostInfo.ai_socktype = SOCK_STREAM;
-    hostInfo.ai_protocol = IPPROTO_TCP;  // todo: confirm
-    hostInfo.ai_flags = AI_PASSIVE;
-
-    auto lFreeList = [](addrinfo* p) { freeaddrinfo(p); };
-    std::unique_ptr<addrinfo, decltype(lFreeList)> hostInfoList(nullptr, lFreeList);
-
-    {
-        addrinfo* hil = nullptr;
-        std::string const portString = std::to_string(port);
-        int const error = getaddrinfo(nullptr, portString.c_str(), &hostInfo, &hil);
-        if (error != 0)
-            throw SocketError(error);
-        if (!hil)
-            throw ProgramError("getaddrinfo returned empty list.");
-        hostInfoList.reset(hil);
-    }
-
-    SocketHandle socket = SocketHandle(hostInfoList->ai_family, hostInfoList->ai_socktype, hostInfoList->ai_protocol);
+    int family = 0;
+    SocketHandle socket = MakeDualStackSocket(SOCK_STREAM, IPPROTO_TCP, &family);
     assert(socket);
 
+    sockaddr_storage myInfo{};
+    IpAddress const any = family == AF_INET6 ? IpAddress(IpAddressV6::Any) : IpAddress(IpAddressV4::Any);
+    socklen_t const myInfoLen = ToSockAddr(any, port, family, &myInfo);
+
     int const yes = 1;
     if (setsockopt(**socket, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) == SocketFd::SOCKET_ERROR)
         throw SocketError(errno);
 
-    if (bind(**socket, hostInfoList->ai_addr, hostInfoList->ai_addrlen) == SocketFd::SOCKET_ERROR)
+    ApplySocketOptions(socket, options);
+
+    if (bind(**socket, reinterpret_cast<sockaddr*>(&myInfo), myInfoLen) == SocketFd::SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
         throw SocketError(errno);
 
     if (listen(**socket, TcpBasicListener::c_backlog) == SocketFd::SOCKET_ERROR)
         throw SocketError(errno);
+    STRAPPER_NET_PROBE2(listener_listen, **socket, port);
 
     return socket;
 }
@@ -70,7 +60,13 @@ SocketHandle Start(uint16_t port)
 }  // namespace
 
 TcpBasicListener::TcpBasicListener(uint16_t port)
-    : m_socket(Start(port))
+    : TcpBasicListener(port, SocketOptions())
+{ }
+
+//! The options are applied before listening, so no connection is accepted without them.
+//! Accepted sockets inherit them from the listener, except quickAck.
+TcpBasicListener::TcpBasicListener(uint16_t port, SocketOptions const& options)
+    : m_socket(Start(port, options))
 { }
 
 TcpBasicListener::~TcpBasicListener()
@@ -84,9 +80,36 @@ bool TcpBasicListener::IsListening() const
     return !!m_socket;
 }
 
+//! Applies every option that is set. Only sockets accepted afterwards inherit them.
+void TcpBasicListener::SetOptions(SocketOptions const& options)
+{
+    ApplySocketOptions(m_socket, options);
+}
+
+SocketOptions TcpBasicListener::GetOptions() const
+{
+    return QuerySocketOptions(m_socket);
+}
+
+//! The port the listener is bound to. Useful after listening on port 0, which lets the system choose.
+uint16_t TcpBasicListener::LocalPort() const
+{
+    if (!m_socket)
+        throw ProgramError("Listener is not open.");
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (getsockname(**m_socket, reinterpret_cast<sockaddr*>(&addr), &len) == SocketFd::SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        throw SocketError(errno);
+    uint16_t port = 0;
+    FromSockAddr(addr, &port);
+    return port;
+}
+
 void TcpBasicListener::Close() noexcept
 {
     shutdown();
+    if (m_socket)
+        STRAPPER_NET_PROBE1(listener_close, **m_socket);
     m_socket.Close();
 }
 
@@ -96,7 +119,9 @@ TcpBasicSocket TcpBasicListener::Accept()
     {
         while (true)
         {
+            STRAPPER_NET_PROBE1(listener_accept_start, **m_socket);
             int clientId = accept(**m_socket, nullptr, nullptr);  // NOLINT(android-cloexec-accept): Doesn't seem to be an issue at the moment. todo: implement args 2 and 3
+            STRAPPER_NET_PROBE2(listener_accept_end, **m_socket, clientId);
             if (clientId != SocketFd::INVALID_SOCKET)
                 return TcpBasicSocket::Attorney::accept(SocketHandle(SocketFd{ clientId }));
             if (errno != ECONNABORTED && errno != EINTR)
@@ -118,7 +143,10 @@ TcpBasicListener::operator bool() const
 void TcpBasicListener::shutdown() noexcept
 {
     if (m_socket)
+    {
+        STRAPPER_NET_PROBE1(listener_shutdown, **m_socket);
         ::shutdown(**m_socket, SHUT_RDWR);
+    }
 }
 
 }}  // namespace strapper::net
@@ -16,51 +16,306 @@
 
 #include <strapper/net/TcpBasicSocket.h>
 
+#include <strapper/net/MetricsRegistry.h>
+#include <strapper/net/Resolver.h>
 #include <strapper/net/SocketError.h>
+#include <strapper/net/Trace.h>
+#include "Probes.h"
+#include "SockAddr.h"
+#include "SockOpts.h"
 #include "SocketFd.h"
 
-#include <netdb.h>
+#include <fcntl.h>
+#include <linux/errqueue.h>
+#include <linux/tcp.h>
+#include <poll.h>
+#include <pthread.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <exception>
 #include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace strapper { namespace net {
 
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t TcpBasicSocket::c_zeroCopyThreshold;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr int TcpBasicSocket::c_zeroCopyLingerMilliseconds;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t TcpBasicSocket::c_receiveMapBytes;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t TcpBasicSocket::c_receiveCopyBytes;
+
 namespace {
 
-//! Connects to host:port
-SocketHandle Connect(std::string const& host, uint16_t port)
+// Linux 4.14. Missing from older C library headers.
+#ifndef SO_ZEROCOPY
+    #define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+    #define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+    #define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+    #define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+
+unsigned constexpr c_zeroCopyCopiedLimit = 8;  // Consecutive sends the kernel copied before WriteZeroCopy stops asking.
+int constexpr c_zeroCopyPollMilliseconds = 10;  // Longest PollZeroCopy sleeps between checks for completions.
+
+//! Collects the release callbacks that come due during a zero-copy call, and calls them when the call ends unless
+//! the caller asked to be handed them instead.
+class ReleaseGuard
+{
+public:
+    explicit ReleaseGuard(TcpBasicSocket::ZeroCopyReleases* out_released)
+        : m_out(out_released ? out_released : &m_released)
+    { }
+    ReleaseGuard(ReleaseGuard const&) = delete;
+    ReleaseGuard& operator=(ReleaseGuard const&) = delete;
+    ~ReleaseGuard()
+    {
+        TcpBasicSocket::CallReleases(&m_released);
+    }
+
+    TcpBasicSocket::ZeroCopyReleases* Get() const { return m_out; }
+
+private:
+    TcpBasicSocket::ZeroCopyReleases m_released;
+    TcpBasicSocket::ZeroCopyReleases* m_out;
+};
+
+ReceiveView MakeView(char const* data, size_t size, bool mapped)
 {
-    addrinfo hostInfo{};
-    hostInfo.ai_family = AF_UNSPEC;      // Can be IPv4 or IPv6
-    hostInfo.ai_socktype = SOCK_STREAM;  // TCP
+    ReceiveView view;
+    view.data = data;
+    view.size = size;
+    view.mapped = mapped;
+    return view;
+}
 
-    auto lFreeList = [](addrinfo* p) { freeaddrinfo(p); };
-    std::unique_ptr<addrinfo, decltype(lFreeList)> hostInfoList(nullptr, lFreeList);
+size_t constexpr c_spliceChunk = 64 * 1024;  // Default pipe capacity. A larger splice would block on the full pipe.
 
+//! Blocks SIGPIPE on the calling thread while alive, and discards one raised in the meantime.
+//! sendfile and splice have no MSG_NOSIGNAL, so writing to a reset connection would otherwise kill the process.
+class SigPipeGuard
+{
+public:
+    SigPipeGuard()
     {
-        addrinfo* hil = nullptr;
-        std::string const portString = std::to_string(port);
-        int const error = getaddrinfo(host.c_str(), portString.c_str(), &hostInfo, &hil);
-        if (error != 0)
-            throw SocketError(error);
-        if (!hil)
-            throw ProgramError("getaddrinfo returned empty list.");
-        hostInfoList.reset(hil);
+        sigemptyset(&m_set);
+        sigaddset(&m_set, SIGPIPE);
+        sigset_t pending{};
+        sigpending(&pending);
+        m_wasPending = sigismember(&pending, SIGPIPE) == 1;
+        pthread_sigmask(SIG_BLOCK, &m_set, &m_old);
+    }
+    SigPipeGuard(SigPipeGuard const&) = delete;
+    SigPipeGuard& operator=(SigPipeGuard const&) = delete;
+    ~SigPipeGuard()
+    {
+        if (!m_wasPending)
+        {
+            sigset_t pending{};
+            sigpending(&pending);
+            timespec const noWait{};
+            if (sigismember(&pending, SIGPIPE) == 1)
+                sigtimedwait(&m_set, nullptr, &noWait);
+        }
+        pthread_sigmask(SIG_SETMASK, &m_old, nullptr);
     }
 
-    SocketHandle socket(hostInfoList->ai_family, hostInfoList->ai_socktype, hostInfoList->ai_protocol);
-    assert(socket);
+private:
+    sigset_t m_set{};
+    sigset_t m_old{};
+    bool m_wasPending = false;
+};
+
+using Clock = std::chrono::steady_clock;
+
+int RemainingMilliseconds(Clock::time_point until)
+{
+    auto const remaining = std::chrono::duration_cast<std::chrono::milliseconds>(until - Clock::now()).count();
+    return static_cast<int>(std::max<decltype(remaining)>(0, std::min<decltype(remaining)>(remaining, std::numeric_limits<int>::max())));
+}
 
-    while (connect(**socket, hostInfoList->ai_addr, hostInfoList->ai_addrlen) == SocketFd::SOCKET_ERROR)
+void SetNonBlocking(SocketHandle const& socket, bool enable)
+{
+    int const flags = fcntl(**socket, F_GETFL);  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    if (flags == SocketFd::SOCKET_ERROR)
+        throw SocketError(errno);
+    int const newFlags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);  // NOLINT(hicpp-signed-bitwise)
+    if (fcntl(**socket, F_SETFL, newFlags) == SocketFd::SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+        throw SocketError(errno);
+}
+
+#ifndef IP_BIND_ADDRESS_NO_PORT
+    #define IP_BIND_ADDRESS_NO_PORT 24  // Linux 4.2. Missing from older C library headers.
+#endif
+
+bool HasLocalBind(ConnectOptions const& options)
+{
+    return options.localPort != 0 || options.localAddress != IpAddress(IpAddressV4::Any);
+}
+
+//! Applies the local device and address of the options to a socket that has not connected yet.
+void BindLocal(SocketHandle const& socket, int family, ConnectOptions const& options)
+{
+    if (!options.device.empty())
     {
-        if (errno != EINTR)
+        if (setsockopt(**socket, SOL_SOCKET, SO_BINDTODEVICE, options.device.c_str(), static_cast<socklen_t>(options.device.size())) == SocketFd::SOCKET_ERROR)
             throw SocketError(errno);
     }
 
-    return socket;
+    if (!HasLocalBind(options))
+        return;
+
+    int const yes = 1;
+    if (options.localPort == 0)
+    {
+        // Best effort. Without it the bind still works, but reserves a port for the life of the socket.
+        setsockopt(**socket, IPPROTO_IP, IP_BIND_ADDRESS_NO_PORT, &yes, sizeof(yes));
+    }
+    else
+    {
+        // Lets a fixed port be reused while an earlier connection from it is in TIME_WAIT.
+        if (setsockopt(**socket, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) == SocketFd::SOCKET_ERROR)
+            throw SocketError(errno);
+    }
+
+    sockaddr_storage addr{};
+    socklen_t const addrLen = ToSockAddr(options.localAddress, options.localPort, family, &addr);
+    if (bind(**socket, reinterpret_cast<sockaddr*>(&addr), addrLen) == SocketFd::SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        throw SocketError(errno);
+}
+
+//! Keeps only the addresses that can be reached from the local address of the options, if one is set.
+Resolver::Addresses MatchLocalFamily(Resolver::Addresses addresses, ConnectOptions const& options)
+{
+    if (!HasLocalBind(options))
+        return addresses;
+    auto const family = options.localAddress.GetFamily();
+    addresses.erase(std::remove_if(addresses.begin(), addresses.end(), [family](IpAddress const& ip) { return ip.GetFamily() != family; }),
+                    addresses.end());
+    if (addresses.empty())
+        throw ProgramError("No resolved address has the family of the local address: '" + options.localAddress.ToString() + "'");
+    return addresses;
+}
+
+//! Connects to host:port. The host is resolved through the resolver cache, then the addresses are raced
+//! with staggered non-blocking connects. The first to complete is returned in blocking mode.
+SocketHandle Connect(std::string const& host, uint16_t port, ConnectOptions const& options)
+{
+    Resolver& resolver = options.resolver ? *options.resolver : Resolver::Global();
+    Resolver::Addresses const addresses = Resolver::InterleaveFamilies(MatchLocalFamily(resolver.Resolve(host), options));
+
+    bool const bounded = options.timeout.count() > 0;
+    auto const deadline = Clock::now() + options.timeout;
+
+    std::vector<SocketHandle> attempts;
+    std::vector<pollfd> fds;
+    size_t next = 0;
+    auto nextStart = Clock::now();
+    std::exception_ptr lastFailure = std::make_exception_ptr(SocketError(ETIMEDOUT));
+
+    for (;;)
+    {
+        if (next < addresses.size() && (attempts.empty() || Clock::now() >= nextStart))
+        {
+            IpAddress const& ip = addresses[next++];
+            try
+            {
+                int const family = ip.IsV4() ? AF_INET : AF_INET6;
+                sockaddr_storage addr{};
+                socklen_t const addrLen = ToSockAddr(ip, port, family, &addr);
+
+                SocketHandle socket(family, SOCK_STREAM, IPPROTO_TCP);
+                assert(socket);
+                BindLocal(socket, family, options);
+                ApplySocketOptions(socket, options.socketOptions);
+                SetNonBlocking(socket, true);
+                if (connect(**socket, reinterpret_cast<sockaddr*>(&addr), addrLen) == 0)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                {
+                    SetNonBlocking(socket, false);
+                    return socket;
+                }
+                if (errno == EINPROGRESS || errno == EINTR)  // An interrupted connect carries on asynchronously.
+                {
+                    fds.push_back(pollfd{ **socket, POLLOUT, 0 });
+                    attempts.push_back(std::move(socket));
+                    nextStart = Clock::now() + options.attemptDelay;
+                }
+                else
+                    lastFailure = std::make_exception_ptr(SocketError(errno));  // Failed outright. Move on to the next address right away.
+            }
+            catch (ProgramError const&)
+            {
+                // Setting up this attempt failed, e.g. binding to the local address. Like a failed connect, move on.
+                lastFailure = std::current_exception();
+            }
+            continue;
+        }
+
+        if (attempts.empty())
+            std::rethrow_exception(lastFailure);
+        if (bounded && Clock::now() >= deadline)
+            throw SocketError(ETIMEDOUT);
+
+        int wait = -1;
+        if (next < addresses.size())
+            wait = RemainingMilliseconds(nextStart);
+        if (bounded)
+            wait = wait < 0 ? RemainingMilliseconds(deadline) : std::min(wait, RemainingMilliseconds(deadline));
+
+        int const count = poll(fds.data(), static_cast<nfds_t>(fds.size()), wait);
+        if (count == SocketFd::SOCKET_ERROR)
+        {
+            if (errno != EINTR)
+                throw SocketError(errno);
+            continue;
+        }
+
+        for (size_t i = 0; i < fds.size();)
+        {
+            if (fds[i].revents == 0)
+            {
+                ++i;
+                continue;
+            }
+            int error = 0;
+            socklen_t errorLen = sizeof(error);
+            if (getsockopt(fds[i].fd, SOL_SOCKET, SO_ERROR, &error, &errorLen) == SocketFd::SOCKET_ERROR)
+                error = errno;
+            if (error == 0)
+            {
+                SocketHandle socket = std::move(attempts[i]);
+                SetNonBlocking(socket, false);
+                return socket;  // The other attempts are closed as they go out of scope.
+            }
+            lastFailure = std::make_exception_ptr(SocketError(error));
+            attempts.erase(attempts.begin() + static_cast<std::ptrdiff_t>(i));
+            fds.erase(fds.begin() + static_cast<std::ptrdiff_t>(i));
+            nextStart = Clock::now();  // A failed attempt hands over to the next address immediately.
+        }
+    }
 }
 
 }  // namespace
@@ -68,8 +323,132 @@ SocketHandle Connect(std::string const& host, uint16_t port)
 //! Provide additional data members specific to an implementation.
 struct TcpBasicSocketImpl
 {
+    //! A WriteZeroCopy whose buffer the kernel may still reference.
+    //! Each zero-copy send is numbered by the kernel, and a write takes consecutive numbers starting at first.
+    struct ZeroCopyWrite
+    {
+        uint32_t first = 0;
+        uint32_t sends = 0;        // Zero-copy sends made for this write.
+        uint32_t outstanding = 0;  // Sends not yet completed.
+        bool copied = false;
+        TcpBasicSocket::ZeroCopyCallback onRelease;
+    };
+
+    //! Sends first through last, as reported on the error queue.
+    struct ZeroCopyCompletion
+    {
+        uint32_t first;
+        uint32_t last;
+        bool copied;
+    };
+
+    TcpBasicSocketImpl() = default;
+    TcpBasicSocketImpl(TcpBasicSocketImpl const&) = delete;
+    TcpBasicSocketImpl& operator=(TcpBasicSocketImpl const&) = delete;
+    ~TcpBasicSocketImpl()
+    {
+        if (m_pipe[0] != SocketFd::INVALID_SOCKET)
+        {
+            close(m_pipe[0]);
+            close(m_pipe[1]);
+        }
+        if (m_receiveRegion)
+            munmap(m_receiveRegion, TcpBasicSocket::c_receiveMapBytes);
+    }
+
     bool m_sendEnabled = true;
     bool m_receiveEnabled = true;
+    std::array<int, 2> m_pipe{ { SocketFd::INVALID_SOCKET, SocketFd::INVALID_SOCKET } };  // Created by the first SpliceRead.
+    size_t m_piped = 0;                                                                     // Bytes in the pipe waiting for SpliceWrite.
+
+    enum class ZeroCopy
+    {
+        UNTRIED,
+        ENABLED,
+        DISABLED
+    };
+    ZeroCopy m_zeroCopy = ZeroCopy::UNTRIED;
+    uint32_t m_zeroCopyNext = 0;  // The number the kernel gives the next zero-copy send.
+    unsigned m_zeroCopyCopiedRun = 0;
+    std::deque<ZeroCopyWrite> m_zeroCopyWrites;
+    // WaitReadable reads the error queue on its own thread, so reading it and m_zeroCopyCompleted take the lock.
+    // The rest of the zero-copy state belongs to the thread writing.
+    std::mutex m_zeroCopyLock;
+    std::vector<ZeroCopyCompletion> m_zeroCopyCompleted;  // Read from the error queue but not yet accounted for.
+
+    ZeroCopy m_zeroCopyReceive = ZeroCopy::UNTRIED;
+    void* m_receiveRegion = nullptr;  // Where ReadView maps received pages. Created by the first ReadView.
+    size_t m_receiveSkip = 0;         // Bytes at the head of the stream that cannot be mapped and must be copied.
+    std::vector<char> m_viewBuffer;   // Holds the bytes of a ReadView that were copied.
+
+    std::mutex m_closeLock;  // Held while closing, so GetTcpInfo on another thread never queries a closed or reused fd.
+
+    //! Moves completions from the error queue to m_zeroCopyCompleted without blocking. Must hold m_zeroCopyLock.
+    //! @return Whether anything was taken off the queue.
+    bool ReadZeroCopyCompletions(int fd)
+    {
+        bool readAny = false;
+        for (;;)
+        {
+            std::array<char, CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))> control{};
+            msghdr msg{};
+            msg.msg_control = control.data();
+            msg.msg_controllen = control.size();
+            if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == SocketFd::SOCKET_ERROR)  // NOLINT(hicpp-signed-bitwise)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    return readAny;
+                throw SocketError(errno);
+            }
+            readAny = true;
+            for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))  // NOLINT
+            {
+                bool const isRecvErr = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+                if (!isRecvErr)
+                    continue;
+                sock_extended_err err{};
+                std::memcpy(&err, CMSG_DATA(cmsg), sizeof(err));  // NOLINT
+                if (err.ee_origin == SO_EE_ORIGIN_ZEROCOPY && err.ee_errno == 0)
+                    m_zeroCopyCompleted.push_back({ err.ee_info, err.ee_data, (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0 });  // NOLINT(hicpp-signed-bitwise)
+            }
+        }
+    }
+
+    //! Accounts for the completion of sends lo through hi. Finished writes are moved to out_released.
+    void CompleteZeroCopy(uint32_t lo, uint32_t hi, bool copied, TcpBasicSocket::ZeroCopyReleases* out_released)
+    {
+        m_zeroCopyCopiedRun = copied ? m_zeroCopyCopiedRun + (hi - lo + 1) : 0;  // Completions can be coalesced into ranges.
+        if (m_zeroCopyCopiedRun >= c_zeroCopyCopiedLimit)
+            m_zeroCopy = ZeroCopy::DISABLED;  // Pinning only costs extra when the kernel copies anyway, e.g. over loopback.
+        if (m_zeroCopyWrites.empty())
+            return;
+
+        // Work with offsets from the oldest outstanding send, so the numbers can wrap around.
+        uint32_t const base = m_zeroCopyWrites.front().first;
+        uint64_t const completedLo = static_cast<uint32_t>(lo - base);
+        uint64_t const completedHi = static_cast<uint32_t>(hi - base);
+        for (auto it = m_zeroCopyWrites.begin(); it != m_zeroCopyWrites.end();)
+        {
+            uint64_t const writeLo = static_cast<uint32_t>(it->first - base);
+            uint64_t const writeHi = writeLo + it->sends - 1;
+            uint64_t const overlapLo = std::max(writeLo, completedLo);
+            uint64_t const overlapHi = std::min(writeHi, completedHi);
+            if (it->sends > 0 && overlapLo <= overlapHi)
+            {
+                it->outstanding -= static_cast<uint32_t>(overlapHi - overlapLo + 1);
+                it->copied = it->copied || copied;
+            }
+            if (it->sends > 0 && it->outstanding == 0)
+            {
+                out_released->emplace_back(std::move(it->onRelease), it->copied ? TcpBasicSocket::ZeroCopyStatus::COPIED : TcpBasicSocket::ZeroCopyStatus::SENT);
+                it = m_zeroCopyWrites.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
 };
 
 TcpBasicSocket::TcpBasicSocket() = default;
@@ -78,15 +457,29 @@ TcpBasicSocket& TcpBasicSocket::operator=(TcpBasicSocket&&) noexcept = default;
 
 //! Constructor connects to host:port.
 TcpBasicSocket::TcpBasicSocket(std::string const& host, uint16_t port)
-    : m_socket(Connect(host, port))
-    , m_impl(new TcpBasicSocketImpl)
+    : TcpBasicSocket(host, port, ConnectOptions())
 { }
 
+//! Constructor connects to host:port, racing the resolved addresses as the options describe.
+TcpBasicSocket::TcpBasicSocket(std::string const& host, uint16_t port, ConnectOptions const& options)
+    : m_socket(Connect(host, port, options))
+    , m_impl(new TcpBasicSocketImpl)
+    , m_stats(new SocketStatsCounters)
+{
+    STRAPPER_NET_PROBE2(tcp_connect, **m_socket, port);
+    Trace::Record(TraceEvent::TCP_CONNECT, **m_socket, port);
+    MetricsRegistry::Global().Add(MetricsRegistry::Counter::TCP_CONNECTS);
+}
+
 //! Special private constructor used only by TcpListener.Accept().
 TcpBasicSocket::TcpBasicSocket(SocketHandle&& socket)
     : m_socket(std::move(socket))
     , m_impl(new TcpBasicSocketImpl)
-{ }
+    , m_stats(new SocketStatsCounters)
+{
+    MetricsRegistry::Global().Add(MetricsRegistry::Counter::TCP_ACCEPTS);
+    Trace::Record(TraceEvent::TCP_ACCEPT, **m_socket, 0);
+}
 
 TcpBasicSocket::~TcpBasicSocket()
 {
@@ -116,10 +509,22 @@ void TcpBasicSocket::SetReadTimeout(unsigned milliseconds)
         throw SocketError(errno);
 }
 
+//! Applies every option that is set. See SocketOptions.
+void TcpBasicSocket::SetOptions(SocketOptions const& options)
+{
+    ApplySocketOptions(m_socket, options);
+}
+
+SocketOptions TcpBasicSocket::GetOptions() const
+{
+    return QuerySocketOptions(m_socket);
+}
+
 void TcpBasicSocket::ShutdownSend()
 {
     if (m_impl)
         m_impl->m_sendEnabled = false;
+    STRAPPER_NET_PROBE2(tcp_shutdown, **m_socket, SHUT_WR);
     if (shutdown(**m_socket, SHUT_WR) == SocketFd::SOCKET_ERROR)
         throw SocketError(errno);
 }
@@ -128,6 +533,7 @@ void TcpBasicSocket::ShutdownReceive()
 {
     if (m_impl)
         m_impl->m_receiveEnabled = false;
+    STRAPPER_NET_PROBE2(tcp_shutdown, **m_socket, SHUT_RD);
     if (shutdown(**m_socket, SHUT_RD) == SocketFd::SOCKET_ERROR)
     {
         // Linux gives ENOTCONN when calling shutdown receive if both sides have called shutdown send. We can ignore this.
@@ -143,14 +549,40 @@ void TcpBasicSocket::ShutdownBoth() noexcept
     {
         m_impl->m_sendEnabled = false;
         m_impl->m_receiveEnabled = false;
+        STRAPPER_NET_PROBE2(tcp_shutdown, **m_socket, SHUT_RDWR);
         shutdown(**m_socket, SHUT_RDWR);
     }
 }
 
 //! Shutdown and close the socket.
-void TcpBasicSocket::Close() noexcept
+//! Waits up to c_zeroCopyLingerMilliseconds for outstanding WriteZeroCopy completions first. Writes whose
+//! completion did not arrive in time are released as CANCELLED once the socket is closed.
+//! @param[out] out_released If given, release callbacks that are due are added to it instead of being called.
+void TcpBasicSocket::Close(ZeroCopyReleases* out_released /* = nullptr */) noexcept
 {
+    ReleaseGuard released(out_released);
+    if (m_socket && m_impl && !m_impl->m_zeroCopyWrites.empty())
+    {
+        try
+        {
+            PollZeroCopy(c_zeroCopyLingerMilliseconds, released.Get());
+        }
+        catch (...)
+        { }
+        for (auto& write : m_impl->m_zeroCopyWrites)
+            released.Get()->emplace_back(std::move(write.onRelease), ZeroCopyStatus::CANCELLED);
+        m_impl->m_zeroCopyWrites.clear();
+    }
+    if (m_socket)
+    {
+        STRAPPER_NET_PROBE1(tcp_close, **m_socket);
+        Trace::Record(TraceEvent::TCP_CLOSE, **m_socket, 0);
+        MetricsRegistry::Global().Add(MetricsRegistry::Counter::TCP_CLOSES);
+    }
     ShutdownBoth();
+    std::unique_lock<std::mutex> lock;
+    if (m_impl)
+        lock = std::unique_lock<std::mutex>(m_impl->m_closeLock);
     m_socket.Close();
 }
 
@@ -161,10 +593,31 @@ void TcpBasicSocket::Write(void const* src, size_t len)
     if (len == 0)
         throw ProgramError("Length must be greater than 0.");
 
-    while (send(**m_socket, src, len, MSG_NOSIGNAL) == SocketFd::SOCKET_ERROR)
+    // A blocking send normally takes everything, but a signal can interrupt it part-way through.
+    auto const* cursor = static_cast<char const*>(src);
+    size_t remaining = len;
+    while (remaining > 0)
     {
-        if (errno != EINTR)
-            throw SocketError(errno);
+        auto const start = SocketStatsCounters::Now();
+        STRAPPER_NET_PROBE2(tcp_write_start, **m_socket, remaining);
+        Trace::Record(TraceEvent::TCP_WRITE_START, **m_socket, static_cast<int64_t>(remaining));
+        ssize_t const amountWritten = send(**m_socket, cursor, remaining, MSG_NOSIGNAL);
+        STRAPPER_NET_PROBE2(tcp_write_end, **m_socket, amountWritten);
+        Trace::Record(TraceEvent::TCP_WRITE_END, **m_socket, amountWritten);
+        m_stats->RecordWrite(amountWritten > 0 ? static_cast<size_t>(amountWritten) : 0, start);
+        if (amountWritten == SocketFd::SOCKET_ERROR)
+        {
+            if (errno != EINTR)
+                throw SocketError(errno);
+            m_stats->RecordInterrupted();
+            continue;
+        }
+
+        MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_WRITTEN, static_cast<uint64_t>(amountWritten));
+        cursor += amountWritten;
+        remaining -= static_cast<size_t>(amountWritten);
+        if (remaining > 0)
+            m_stats->RecordPartialWrite();
     }
 }
 
@@ -181,25 +634,422 @@ bool TcpBasicSocket::Read(void* dest, size_t len)
             throw ProgramError("Length must be greater than 0.");
         if (len > static_cast<size_t>(std::numeric_limits<ssize_t>::max()))
             throw ProgramError("Length must be less than ssize_t max.");
-        auto const lenAsLongInt = static_cast<ssize_t>(len);
 
-        ssize_t amountRead = 0;
-        do
+        // MSG_WAITALL can still return early if a signal arrives after some data has been received.
+        auto* cursor = static_cast<char*>(dest);
+        size_t remaining = len;
+        while (remaining > 0)
+        {
+            auto const start = SocketStatsCounters::Now();
+            STRAPPER_NET_PROBE2(tcp_read_start, **m_socket, remaining);
+            Trace::Record(TraceEvent::TCP_READ_START, **m_socket, static_cast<int64_t>(remaining));
+            ssize_t const amountRead = recv(**m_socket, cursor, remaining, MSG_WAITALL);
+            STRAPPER_NET_PROBE2(tcp_read_end, **m_socket, amountRead);
+            Trace::Record(TraceEvent::TCP_READ_END, **m_socket, amountRead);
+            m_stats->RecordRead(amountRead > 0 ? static_cast<size_t>(amountRead) : 0, start);
+            if (amountRead == SocketFd::SOCKET_ERROR)
+            {
+                if (errno != EINTR)
+                    throw SocketError(errno);
+                m_stats->RecordInterrupted();
+                continue;
+            }
+            if (amountRead == 0)
+            {
+                if (remaining != len)
+                    throw ProgramError("Other side closed before all bytes were received.");
+                // Graceful close.
+                if (!m_impl->m_receiveEnabled)
+                    throw ProgramError("Attempted to read after EOF.");
+                ShutdownReceive();
+                return false;
+            }
+
+            MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_READ, static_cast<uint64_t>(amountRead));
+            cursor += amountRead;
+            remaining -= static_cast<size_t>(amountRead);
+            if (remaining > 0)
+                m_stats->RecordPartialRead();
+        }
+        return true;
+    }
+    catch (ProgramError const&)
+    {
+        Close();
+        throw;
+    }
+}
+
+//! Sends len bytes of the file, starting at offset, without copying them through user space.
+//! The file position is not changed. out_sent, if given, is kept up to date so it is valid if an exception is thrown.
+//! @return The number of bytes sent. Less than len only if the end of the file was reached.
+size_t TcpBasicSocket::SendFile(int fd, uint64_t offset, size_t len, size_t* out_sent /* = nullptr */)
+{
+    if (len == 0)
+        throw ProgramError("Length must be greater than 0.");
+    if (offset > static_cast<uint64_t>(std::numeric_limits<off_t>::max()))
+        throw ProgramError("Offset must be less than off_t max.");
+
+    SigPipeGuard const sigPipeGuard;
+    auto position = static_cast<off_t>(offset);
+    size_t sent = 0;
+    if (out_sent)
+        *out_sent = 0;
+    while (sent < len)
+    {
+        auto const start = SocketStatsCounters::Now();
+        STRAPPER_NET_PROBE2(tcp_write_start, **m_socket, len - sent);
+        Trace::Record(TraceEvent::TCP_WRITE_START, **m_socket, static_cast<int64_t>(len - sent));
+        ssize_t const amountWritten = sendfile(**m_socket, fd, &position, len - sent);
+        STRAPPER_NET_PROBE2(tcp_write_end, **m_socket, amountWritten);
+        Trace::Record(TraceEvent::TCP_WRITE_END, **m_socket, amountWritten);
+        m_stats->RecordWrite(amountWritten > 0 ? static_cast<size_t>(amountWritten) : 0, start);
+        if (amountWritten == SocketFd::SOCKET_ERROR)
+        {
+            if (errno != EINTR)
+                throw SocketError(errno);
+            m_stats->RecordInterrupted();
+            continue;
+        }
+        if (amountWritten == 0)
+            break;  // End of file.
+
+        MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_WRITTEN, static_cast<uint64_t>(amountWritten));
+        sent += static_cast<size_t>(amountWritten);
+        if (out_sent)
+            *out_sent = sent;
+        if (sent < len)
+            m_stats->RecordPartialWrite();
+    }
+    return sent;
+}
+
+//! Moves up to maxLen bytes that have arrived on this socket into a kernel pipe, without copying them to user space.
+//! Blocks until some data is available. Each SpliceRead must be followed by a SpliceWrite before the next.
+//! @return The number of bytes moved. Zero if the other side closed, in which case receiving is shut down.
+size_t TcpBasicSocket::SpliceRead(size_t maxLen)
+{
+    try
+    {
+        if (maxLen == 0)
+            throw ProgramError("Length must be greater than 0.");
+        if (m_impl->m_piped != 0)
+            throw ProgramError("The previous splice has not been written.");
+        if (m_impl->m_pipe[0] == SocketFd::INVALID_SOCKET && pipe2(m_impl->m_pipe.data(), O_CLOEXEC) == SocketFd::SOCKET_ERROR)
+            throw SocketError(errno);
+
+        for (;;)
+        {
+            size_t const chunk = std::min(maxLen, c_spliceChunk);
+            auto const start = SocketStatsCounters::Now();
+            STRAPPER_NET_PROBE2(tcp_read_start, **m_socket, chunk);
+            Trace::Record(TraceEvent::TCP_READ_START, **m_socket, static_cast<int64_t>(chunk));
+            ssize_t const amountRead = splice(**m_socket, nullptr, m_impl->m_pipe[1], nullptr, chunk, SPLICE_F_MOVE);
+            STRAPPER_NET_PROBE2(tcp_read_end, **m_socket, amountRead);
+            Trace::Record(TraceEvent::TCP_READ_END, **m_socket, amountRead);
+            m_stats->RecordRead(amountRead > 0 ? static_cast<size_t>(amountRead) : 0, start);
+            if (amountRead == SocketFd::SOCKET_ERROR)
+            {
+                if (errno != EINTR)
+                    throw SocketError(errno);
+                m_stats->RecordInterrupted();
+                continue;
+            }
+            if (amountRead == 0)
+            {
+                // Graceful close.
+                if (!m_impl->m_receiveEnabled)
+                    throw ProgramError("Attempted to read after EOF.");
+                ShutdownReceive();
+                return 0;
+            }
+
+            MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_READ, static_cast<uint64_t>(amountRead));
+            m_impl->m_piped = static_cast<size_t>(amountRead);
+            return m_impl->m_piped;
+        }
+    }
+    catch (ProgramError const&)
+    {
+        Close();
+        throw;
+    }
+}
+
+//! Writes everything moved by the last SpliceRead to dest, without copying it to user space.
+void TcpBasicSocket::SpliceWrite(TcpBasicSocket& dest)
+{
+    if (&dest == this)
+        throw ProgramError("Cannot splice a socket to itself.");
+
+    SigPipeGuard const sigPipeGuard;
+    while (m_impl->m_piped > 0)
+    {
+        auto const start = SocketStatsCounters::Now();
+        STRAPPER_NET_PROBE2(tcp_write_start, **dest.m_socket, m_impl->m_piped);
+        Trace::Record(TraceEvent::TCP_WRITE_START, **dest.m_socket, static_cast<int64_t>(m_impl->m_piped));
+        ssize_t const amountWritten = splice(m_impl->m_pipe[0], nullptr, **dest.m_socket, nullptr, m_impl->m_piped, SPLICE_F_MOVE);
+        STRAPPER_NET_PROBE2(tcp_write_end, **dest.m_socket, amountWritten);
+        Trace::Record(TraceEvent::TCP_WRITE_END, **dest.m_socket, amountWritten);
+        dest.m_stats->RecordWrite(amountWritten > 0 ? static_cast<size_t>(amountWritten) : 0, start);
+        if (amountWritten == SocketFd::SOCKET_ERROR)
+        {
+            if (errno != EINTR)
+                throw SocketError(errno);
+            dest.m_stats->RecordInterrupted();
+            continue;
+        }
+
+        MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_WRITTEN, static_cast<uint64_t>(amountWritten));
+        m_impl->m_piped -= static_cast<size_t>(amountWritten);
+        if (m_impl->m_piped > 0)
+            dest.m_stats->RecordPartialWrite();
+    }
+}
+
+//! Writes len bytes without copying them into the kernel. The pages stay pinned until the peer acknowledges them,
+//! so the buffer must not be changed or freed until onRelease is called.
+//! onRelease is called exactly once: From WriteZeroCopy itself if the data was copied (writes smaller than
+//! c_zeroCopyThreshold, kernels without SO_ZEROCOPY, or after the kernel keeps reporting that it copied anyway),
+//! and otherwise from a later WriteZeroCopy, PollZeroCopy or Close on this thread. It must not use this socket.
+//! @param[out] out_released If given, release callbacks that are due are added to it instead of being called.
+void TcpBasicSocket::WriteZeroCopy(void const* src, size_t len, ZeroCopyCallback onRelease, ZeroCopyReleases* out_released /* = nullptr */)
+{
+    if (!src)
+        throw ProgramError("Null pointer.");
+    if (len == 0)
+        throw ProgramError("Length must be greater than 0.");
+    if (!onRelease)
+        throw ProgramError("Release callback is empty.");
+
+    ReleaseGuard released(out_released);
+    PollZeroCopy(0, released.Get());
+
+    if (m_impl->m_zeroCopy == TcpBasicSocketImpl::ZeroCopy::UNTRIED)
+    {
+        int const yes = 1;
+        bool const enabled = setsockopt(**m_socket, SOL_SOCKET, SO_ZEROCOPY, &yes, sizeof(yes)) == 0;
+        m_impl->m_zeroCopy = enabled ? TcpBasicSocketImpl::ZeroCopy::ENABLED : TcpBasicSocketImpl::ZeroCopy::DISABLED;
+    }
+    if (len < c_zeroCopyThreshold || m_impl->m_zeroCopy != TcpBasicSocketImpl::ZeroCopy::ENABLED)
+    {
+        released.Get()->emplace_back(std::move(onRelease), ZeroCopyStatus::COPIED);  // Released once Write returns or throws.
+        Write(src, len);
+        return;
+    }
+
+    m_impl->m_zeroCopyWrites.emplace_back();
+    TcpBasicSocketImpl::ZeroCopyWrite& write = m_impl->m_zeroCopyWrites.back();
+    write.first = m_impl->m_zeroCopyNext;
+    write.onRelease = std::move(onRelease);
+
+    auto const* cursor = static_cast<char const*>(src);
+    size_t remaining = len;
+    int flags = MSG_NOSIGNAL | MSG_ZEROCOPY;  // NOLINT(hicpp-signed-bitwise)
+    try
+    {
+        while (remaining > 0)
+        {
+            auto const start = SocketStatsCounters::Now();
+            STRAPPER_NET_PROBE2(tcp_write_start, **m_socket, remaining);
+            Trace::Record(TraceEvent::TCP_WRITE_START, **m_socket, static_cast<int64_t>(remaining));
+            ssize_t const amountWritten = send(**m_socket, cursor, remaining, flags);
+            STRAPPER_NET_PROBE2(tcp_write_end, **m_socket, amountWritten);
+            Trace::Record(TraceEvent::TCP_WRITE_END, **m_socket, amountWritten);
+            m_stats->RecordWrite(amountWritten > 0 ? static_cast<size_t>(amountWritten) : 0, start);
+            if (amountWritten == SocketFd::SOCKET_ERROR)
+            {
+                if (errno == ENOBUFS && (flags & MSG_ZEROCOPY) != 0)  // NOLINT(hicpp-signed-bitwise)
+                {
+                    flags = MSG_NOSIGNAL;  // Out of memory to pin pages (optmem_max). Copy the rest.
+                    continue;
+                }
+                if (errno != EINTR)
+                    throw SocketError(errno);
+                m_stats->RecordInterrupted();
+                continue;
+            }
+
+            if ((flags & MSG_ZEROCOPY) != 0)  // NOLINT(hicpp-signed-bitwise)
+            {
+                ++m_impl->m_zeroCopyNext;
+                ++write.sends;
+                ++write.outstanding;
+            }
+            MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_WRITTEN, static_cast<uint64_t>(amountWritten));
+            cursor += amountWritten;
+            remaining -= static_cast<size_t>(amountWritten);
+            if (remaining > 0)
+                m_stats->RecordPartialWrite();
+        }
+    }
+    catch (...)
+    {
+        if (write.sends == 0)
+        {
+            // The kernel never referenced the buffer.
+            released.Get()->emplace_back(std::move(write.onRelease), ZeroCopyStatus::COPIED);
+            m_impl->m_zeroCopyWrites.pop_back();
+        }
+        throw;
+    }
+
+    if (write.sends == 0)
+    {
+        released.Get()->emplace_back(std::move(write.onRelease), ZeroCopyStatus::COPIED);
+        m_impl->m_zeroCopyWrites.pop_back();
+    }
+}
+
+//! Calls the release callback of every WriteZeroCopy that has completed, waiting up to timeoutMilliseconds for
+//! the rest. A negative timeout waits for all of them.
+//! @param[out] out_released If given, release callbacks that are due are added to it instead of being called.
+//! @return The number of writes still outstanding.
+size_t TcpBasicSocket::PollZeroCopy(int timeoutMilliseconds, ZeroCopyReleases* out_released /* = nullptr */)
+{
+    ReleaseGuard released(out_released);
+    auto const deadline = Clock::now() + std::chrono::milliseconds(std::max(timeoutMilliseconds, 0));
+    for (;;)
+    {
+        // Completions are reported on the socket's error queue, which never blocks.
+        std::vector<TcpBasicSocketImpl::ZeroCopyCompletion> completed;
         {
-            amountRead = recv(**m_socket, dest, len, MSG_WAITALL);
-        } while (amountRead == SocketFd::SOCKET_ERROR && errno == EINTR);
-        if (amountRead == SocketFd::SOCKET_ERROR)
+            std::lock_guard<std::mutex> lock(m_impl->m_zeroCopyLock);
+            m_impl->ReadZeroCopyCompletions(**m_socket);
+            completed.swap(m_impl->m_zeroCopyCompleted);
+        }
+        for (auto const& completion : completed)
+            m_impl->CompleteZeroCopy(completion.first, completion.last, completion.copied, released.Get());
+
+        if (m_impl->m_zeroCopyWrites.empty())
+            return 0;
+        int const wait = timeoutMilliseconds < 0 ? -1 : RemainingMilliseconds(deadline);
+        if (wait == 0)
+            return m_impl->m_zeroCopyWrites.size();
+
+        // A queued completion raises POLLERR, but WaitReadable on another thread may take it off the queue first,
+        // so check again every c_zeroCopyPollMilliseconds. Other conditions (e.g. POLLHUP) would wake poll straight
+        // away, so fall back to checking every millisecond when one of them is set.
+        pollfd fd{ **m_socket, 0, 0 };
+        int const count = poll(&fd, 1, wait < 0 ? c_zeroCopyPollMilliseconds : std::min(wait, c_zeroCopyPollMilliseconds));
+        if (count == SocketFd::SOCKET_ERROR && errno != EINTR)
             throw SocketError(errno);
-        if (amountRead == lenAsLongInt)
-            return true;
-        if (amountRead == 0)  // Graceful close.
+        if (count > 0 && (fd.revents & POLLERR) == 0)  // NOLINT(hicpp-signed-bitwise)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+//! Whether WriteZeroCopy currently avoids copying. False until the first WriteZeroCopy tries to turn it on.
+bool TcpBasicSocket::ZeroCopyEnabled() const
+{
+    return m_impl && m_impl->m_zeroCopy == TcpBasicSocketImpl::ZeroCopy::ENABLED;
+}
+
+//! Calls the release callbacks handed out by WriteZeroCopy, PollZeroCopy or Close, and empties released.
+void TcpBasicSocket::CallReleases(ZeroCopyReleases* released) noexcept
+{
+    if (!released)
+        return;
+    for (auto& release : *released)
+        release.first(release.second);
+    released->clear();
+}
+
+//! Receives up to maxLen bytes in place. Whole pages of payload are mapped from the kernel with TCP_ZEROCOPY_RECEIVE
+//! instead of being copied. Bytes that cannot be mapped (the part of the stream before the next page-aligned
+//! payload, or everything on kernels without the option) are copied with recv into an internal buffer.
+//! Blocks until at least one byte is available, and returns whatever is available up to maxLen.
+//! @return The received bytes, valid until the next ReadView or Close. Empty if the other side closed, in
+//! which case receiving is shut down. On error the socket is closed.
+ReceiveView TcpBasicSocket::ReadView(size_t maxLen)
+{
+    try
+    {
+        if (maxLen == 0)
+            throw ProgramError("Length must be greater than 0.");
+
+        if (m_impl->m_zeroCopyReceive == TcpBasicSocketImpl::ZeroCopy::UNTRIED)
         {
-            if (!m_impl->m_receiveEnabled)
-                throw ProgramError("Attempted to read after EOF.");
-            ShutdownReceive();
-            return false;
+            void* region = mmap(nullptr, c_receiveMapBytes, PROT_READ, MAP_SHARED, **m_socket, 0);
+            bool const enabled = region != MAP_FAILED;  // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+            m_impl->m_receiveRegion = enabled ? region : nullptr;
+            m_impl->m_zeroCopyReceive = enabled ? TcpBasicSocketImpl::ZeroCopy::ENABLED : TcpBasicSocketImpl::ZeroCopy::DISABLED;
+        }
+
+        auto const pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        bool waited = false;
+        while (m_impl->m_zeroCopyReceive == TcpBasicSocketImpl::ZeroCopy::ENABLED && m_impl->m_receiveSkip == 0 && maxLen >= pageSize)
+        {
+            tcp_zerocopy_receive zc{};
+            zc.address = reinterpret_cast<uint64_t>(m_impl->m_receiveRegion);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            zc.length = static_cast<uint32_t>(std::min(maxLen, c_receiveMapBytes) / pageSize * pageSize);
+            socklen_t zcLen = offsetof(tcp_zerocopy_receive, inq);  // The original layout, accepted by every kernel with the option.
+            auto const start = SocketStatsCounters::Now();
+            STRAPPER_NET_PROBE2(tcp_read_start, **m_socket, zc.length);
+            Trace::Record(TraceEvent::TCP_READ_START, **m_socket, zc.length);
+            int const status = getsockopt(**m_socket, IPPROTO_TCP, TCP_ZEROCOPY_RECEIVE, &zc, &zcLen);
+            STRAPPER_NET_PROBE2(tcp_read_end, **m_socket, status == 0 ? static_cast<int64_t>(zc.length) : status);
+            Trace::Record(TraceEvent::TCP_READ_END, **m_socket, status == 0 ? static_cast<int64_t>(zc.length) : status);
+            if (status == SocketFd::SOCKET_ERROR)
+            {
+                if (errno == EINTR)
+                    continue;
+                // Not supported for this socket. A real socket error will come from recv below.
+                m_impl->m_zeroCopyReceive = TcpBasicSocketImpl::ZeroCopy::DISABLED;
+                break;
+            }
+            m_stats->RecordRead(zc.length, start);
+            if (zc.length > 0)
+            {
+                MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_READ, zc.length);
+                return MakeView(static_cast<char const*>(m_impl->m_receiveRegion), zc.length, true);
+            }
+
+            m_impl->m_receiveSkip = zc.recv_skip_hint;
+            if (m_impl->m_receiveSkip > 0 || waited)
+                break;  // Copy the unaligned bytes, or find out why nothing arrived (e.g. end of stream).
+
+            // Nothing queued yet. Wait for data without consuming it, honoring the read timeout, then map again.
+            char peek = 0;
+            ssize_t const amountPeeked = recv(**m_socket, &peek, 1, MSG_PEEK);
+            if (amountPeeked == SocketFd::SOCKET_ERROR && errno != EINTR)
+                throw SocketError(errno);
+            waited = amountPeeked != SocketFd::SOCKET_ERROR;
+        }
+
+        size_t chunk = std::min(maxLen, c_receiveCopyBytes);
+        if (m_impl->m_receiveSkip > 0)
+            chunk = std::min(chunk, m_impl->m_receiveSkip);
+        m_impl->m_viewBuffer.resize(c_receiveCopyBytes);
+        for (;;)
+        {
+            auto const start = SocketStatsCounters::Now();
+            STRAPPER_NET_PROBE2(tcp_read_start, **m_socket, chunk);
+            Trace::Record(TraceEvent::TCP_READ_START, **m_socket, static_cast<int64_t>(chunk));
+            ssize_t const amountRead = recv(**m_socket, m_impl->m_viewBuffer.data(), chunk, 0);
+            STRAPPER_NET_PROBE2(tcp_read_end, **m_socket, amountRead);
+            Trace::Record(TraceEvent::TCP_READ_END, **m_socket, amountRead);
+            m_stats->RecordRead(amountRead > 0 ? static_cast<size_t>(amountRead) : 0, start);
+            if (amountRead == SocketFd::SOCKET_ERROR)
+            {
+                if (errno != EINTR)
+                    throw SocketError(errno);
+                m_stats->RecordInterrupted();
+                continue;
+            }
+            if (amountRead == 0)
+            {
+                // Graceful close.
+                if (!m_impl->m_receiveEnabled)
+                    throw ProgramError("Attempted to read after EOF.");
+                ShutdownReceive();
+                return ReceiveView{};
+            }
+
+            MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_READ, static_cast<uint64_t>(amountRead));
+            m_impl->m_receiveSkip -= std::min(m_impl->m_receiveSkip, static_cast<size_t>(amountRead));
+            return MakeView(m_impl->m_viewBuffer.data(), static_cast<size_t>(amountRead), false);
         }
-        throw ProgramError("Other side closed before all bytes were received.");
     }
     catch (ProgramError const&)
     {
@@ -229,6 +1079,106 @@ unsigned TcpBasicSocket::DataAvailable()
     return static_cast<unsigned>(bytesAvailable);
 }
 
+//! Waits until at least one of the sockets can be read without blocking.
+//! That includes when the other side has closed the connection or there is an error, since Read will return immediately.
+//! Pending WriteZeroCopy completions do not make a socket ready. Their callbacks are called by the next
+//! WriteZeroCopy, PollZeroCopy or Close on the writing thread.
+//! @param[in] timeoutMilliseconds Negative waits forever.
+//! @param[out] ready Resized to match sockets. Set to true for each socket that is ready.
+//! @return The number of ready sockets. 0 if the timeout was reached.
+size_t TcpBasicSocket::WaitReadable(std::vector<TcpBasicSocket const*> const& sockets, std::vector<bool>* ready, int timeoutMilliseconds)
+{
+    if (!ready)
+        throw ProgramError("Null pointer.");
+    if (sockets.empty())
+        throw ProgramError("No sockets to wait on.");
+
+    std::vector<pollfd> fds(sockets.size());
+    for (size_t i = 0; i < sockets.size(); ++i)
+    {
+        if (!sockets[i] || !sockets[i]->m_socket)
+            throw ProgramError("Socket is not open.");
+        fds[i].fd = **sockets[i]->m_socket;
+        fds[i].events = POLLIN;
+    }
+
+    auto const deadline = Clock::now() + std::chrono::milliseconds(std::max(timeoutMilliseconds, 0));
+    int wait = timeoutMilliseconds;
+    for (;;)
+    {
+        int count = 0;
+        while ((count = poll(fds.data(), static_cast<nfds_t>(fds.size()), wait)) == SocketFd::SOCKET_ERROR)
+        {
+            if (errno != EINTR)
+                throw SocketError(errno);
+        }
+
+        // Completed WriteZeroCopy sends wait on the error queue and raise POLLERR, although there is nothing to read.
+        // Move them off the queue for the writing thread and poll again. A socket error leaves POLLERR set.
+        bool drained = false;
+        for (size_t i = 0; i < fds.size(); ++i)
+        {
+            if (fds[i].revents != POLLERR)
+                continue;
+            TcpBasicSocketImpl& impl = *sockets[i]->m_impl;
+            std::lock_guard<std::mutex> lock(impl.m_zeroCopyLock);
+            try
+            {
+                drained = impl.ReadZeroCopyCompletions(fds[i].fd) || drained;
+            }
+            catch (SocketError const&)
+            { }  // Reported as ready, so the next Read reports the error.
+        }
+
+        if (!drained)
+        {
+            ready->assign(sockets.size(), false);
+            for (size_t i = 0; i < fds.size(); ++i)
+                (*ready)[i] = fds[i].revents != 0;
+            return static_cast<size_t>(count);
+        }
+        wait = timeoutMilliseconds < 0 ? -1 : RemainingMilliseconds(deadline);
+    }
+}
+
+//! Older kernels fill in a shorter tcp_info. The fields they leave out stay 0.
+//! Safe to call while another thread reads, writes or closes the socket.
+TcpInfo TcpBasicSocket::GetTcpInfo() const
+{
+    if (!m_impl)
+        throw ProgramError("Socket is not connected.");
+    std::lock_guard<std::mutex> lock(m_impl->m_closeLock);
+    if (!m_socket)
+        throw ProgramError("Socket is not connected.");
+
+    tcp_info info{};
+    socklen_t infoLen = sizeof(info);
+    if (getsockopt(**m_socket, IPPROTO_TCP, TCP_INFO, &info, &infoLen) == SocketFd::SOCKET_ERROR)
+        throw SocketError(errno);
+
+    TcpInfo result;
+    result.rttMicroseconds = info.tcpi_rtt;
+    result.rttVarianceMicroseconds = info.tcpi_rttvar;
+    result.sendMss = info.tcpi_snd_mss;
+    result.congestionWindowBytes = static_cast<uint64_t>(info.tcpi_snd_cwnd) * info.tcpi_snd_mss;
+    result.slowStartThreshold = info.tcpi_snd_ssthresh;
+    result.unackedSegments = info.tcpi_unacked;
+    result.lostSegments = info.tcpi_lost;
+    result.retransmits = info.tcpi_retransmits;
+    result.totalRetransmits = info.tcpi_total_retrans;
+    result.receiveSpaceBytes = info.tcpi_rcv_space;
+    result.pacingRate = info.tcpi_pacing_rate;
+    result.deliveryRate = info.tcpi_delivery_rate;
+    result.bytesAcked = info.tcpi_bytes_acked;
+    result.bytesReceived = info.tcpi_bytes_received;
+    return result;
+}
+
+SocketStats TcpBasicSocket::GetStats() const
+{
+    return m_stats ? m_stats->Snapshot() : SocketStats();
+}
+
 TcpBasicSocket::operator bool() const
 {
     return IsOpen();
@@ -16,7 +16,12 @@
 
 #include <strapper/net/UdpBasicSocket.h>
 
+#include <strapper/net/MetricsRegistry.h>
 #include <strapper/net/SocketError.h>
+#include <strapper/net/Trace.h>
+#include "Probes.h"
+#include "SockAddr.h"
+#include "SockOpts.h"
 #include "SocketFd.h"
 
 #include <arpa/inet.h>
@@ -30,23 +35,24 @@ namespace strapper { namespace net {
 
 namespace {
 
-// Creates a socket and binds it to the given port. Set to 0 for any.
-SocketHandle MakeSocket(uint16_t myport)
+// Creates a dual-stack socket and binds it to the given port on all interfaces. Set to 0 for any.
+SocketHandle MakeSocket(uint16_t myport, int* out_family)
 {
-    SocketHandle socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    SocketHandle socket = MakeDualStackSocket(SOCK_DGRAM, IPPROTO_UDP, out_family);
     assert(socket);
 
-    sockaddr_in myInfo{};
-    myInfo.sin_family = AF_INET;
-    myInfo.sin_addr.s_addr = htonl(INADDR_ANY);
-    myInfo.sin_port = htons(myport);
+    sockaddr_storage myInfo{};
+    IpAddress const any = *out_family == AF_INET6 ? IpAddress(IpAddressV6::Any) : IpAddress(IpAddressV4::Any);
+    socklen_t const myInfoLen = ToSockAddr(any, myport, *out_family, &myInfo);
 
     auto const status = bind(**socket,
                              reinterpret_cast<sockaddr*>(&myInfo),  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-                             sizeof(myInfo));
+                             myInfoLen);
 
     if (status == SocketFd::SOCKET_ERROR)
         throw SocketError(errno);
+    STRAPPER_NET_PROBE2(udp_bind, **socket, myport);
+    Trace::Record(TraceEvent::UDP_BIND, **socket, myport);
 
     return socket;
 }
@@ -55,7 +61,8 @@ SocketHandle MakeSocket(uint16_t myport)
 
 //! 0 for any. // todo: verify
 UdpBasicSocket::UdpBasicSocket(uint16_t myport)
-    : m_socket(MakeSocket(myport))
+    : m_socket(MakeSocket(myport, &m_family))
+    , m_stats(new SocketStatsCounters)
 { }
 
 UdpBasicSocket::~UdpBasicSocket()
@@ -86,43 +93,67 @@ void UdpBasicSocket::SetReadTimeout(unsigned milliseconds)
         throw SocketError(errno);
 }
 
+//! Applies every option that is set. The TCP options are rejected by the system.
+void UdpBasicSocket::SetOptions(SocketOptions const& options)
+{
+    ApplySocketOptions(m_socket, options);
+}
+
+SocketOptions UdpBasicSocket::GetOptions() const
+{
+    return QuerySocketOptions(m_socket);
+}
+
 void UdpBasicSocket::Shutdown() noexcept
 {
     if (m_socket)
+    {
+        STRAPPER_NET_PROBE1(udp_shutdown, **m_socket);
         shutdown(**m_socket, SHUT_RDWR);
+    }
 }
 
 // Shutdown and close the socket.
 void UdpBasicSocket::Close() noexcept
 {
     Shutdown();
+    if (m_socket)
+    {
+        STRAPPER_NET_PROBE1(udp_close, **m_socket);
+        Trace::Record(TraceEvent::UDP_CLOSE, **m_socket, 0);
+    }
     m_socket.Close();
 }
 
-void UdpBasicSocket::Write(void const* src, size_t len, IpAddressV4 const& ipAddress, uint16_t port)
+void UdpBasicSocket::Write(void const* src, size_t len, IpAddress const& ipAddress, uint16_t port)
 {
     if (!src)
         throw ProgramError("Null pointer.");
     if (len == 0)
         throw ProgramError("Length must be greater than 0.");
 
-    sockaddr_in info{};
-    info.sin_family = AF_INET;
-    info.sin_port = htons(port);
-    std::string const ipString = ipAddress.ToString('.');
-    int const success = inet_pton(AF_INET, ipString.c_str(), &info.sin_addr);
-    if (success == 0)
-        throw ProgramError("Invalid IP address: " + ipAddress.ToString('.'));
-    if (success == -1)
-        throw SocketError(errno);
-    if (success != 1)
-        throw ProgramError("Unknown error.");
+    sockaddr_storage info{};
+    socklen_t const infoLen = ToSockAddr(ipAddress, port, m_family, &info);
 
     auto* infoAsSockAddr = reinterpret_cast<sockaddr*>(&info);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-    while (sendto(**m_socket, src, len, 0, infoAsSockAddr, sizeof(info)) == SocketFd::SOCKET_ERROR)
+    for (;;)
     {
+        auto const start = SocketStatsCounters::Now();
+        STRAPPER_NET_PROBE3(udp_write_start, **m_socket, len, port);
+        Trace::Record(TraceEvent::UDP_WRITE_START, **m_socket, static_cast<int64_t>(len));
+        ssize_t const amountWritten = sendto(**m_socket, src, len, 0, infoAsSockAddr, infoLen);
+        STRAPPER_NET_PROBE2(udp_write_end, **m_socket, amountWritten);
+        Trace::Record(TraceEvent::UDP_WRITE_END, **m_socket, amountWritten);
+        m_stats->RecordWrite(amountWritten > 0 ? static_cast<size_t>(amountWritten) : 0, start);
+        if (amountWritten != SocketFd::SOCKET_ERROR)
+        {
+            MetricsRegistry::Count(MetricsRegistry::Counter::UDP_DATAGRAMS_WRITTEN);
+            MetricsRegistry::Count(MetricsRegistry::Counter::UDP_BYTES_WRITTEN, static_cast<uint64_t>(amountWritten));
+            break;
+        }
         if (errno != EINTR)
             throw SocketError(errno);
+        m_stats->RecordInterrupted();
     }
 }
 
@@ -143,38 +174,54 @@ void UdpBasicSocket::Write(void const* src, size_t len, IpAddressV4 const& ipAdd
 //     }
 // }
 
-unsigned UdpBasicSocket::Read(void* dest, size_t maxlen, IpAddressV4* out_ipAddress, uint16_t* out_port)
+unsigned UdpBasicSocket::Read(void* dest, size_t maxlen, IpAddress* out_ipAddress, uint16_t* out_port)
 {
     if (!dest)
         throw ProgramError("Null pointer.");
     if (maxlen == 0)
         throw ProgramError("Max length must be greater than 0.");
 
-    sockaddr_in info{};
+    sockaddr_storage info{};
     socklen_t infoLen = sizeof(info);
     ssize_t amountRead = 0;
-    do
+    for (;;)
     {
+        auto const start = SocketStatsCounters::Now();
+        STRAPPER_NET_PROBE2(udp_read_start, **m_socket, maxlen);
+        Trace::Record(TraceEvent::UDP_READ_START, **m_socket, static_cast<int64_t>(maxlen));
         amountRead = recvfrom(**m_socket, dest, maxlen, 0,
                               reinterpret_cast<sockaddr*>(&info),  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
                               &infoLen);
-    } while (amountRead == SocketFd::SOCKET_ERROR && errno == EINTR);
+        STRAPPER_NET_PROBE2(udp_read_end, **m_socket, amountRead);
+        Trace::Record(TraceEvent::UDP_READ_END, **m_socket, amountRead);
+        m_stats->RecordRead(amountRead > 0 ? static_cast<size_t>(amountRead) : 0, start);
+        if (amountRead != SocketFd::SOCKET_ERROR || errno != EINTR)
+            break;
+        m_stats->RecordInterrupted();
+    }
     if (amountRead == SocketFd::SOCKET_ERROR)
         throw SocketError(errno);
     if (amountRead == 0)
         throw ProgramError("Socket was closed.");
 
-    if ((out_ipAddress || out_port) && (infoLen != sizeof(info)))
-        throw ProgramError("Read returned unexpected endpoint info size.");
+    MetricsRegistry::Count(MetricsRegistry::Counter::UDP_DATAGRAMS_READ);
+    MetricsRegistry::Count(MetricsRegistry::Counter::UDP_BYTES_READ, static_cast<uint64_t>(amountRead));
 
-    if (out_ipAddress)
-        *out_ipAddress = IpAddressV4(info.sin_addr.s_addr);
-    if (out_port)
-        *out_port = ntohs(info.sin_port);
+    if (out_ipAddress || out_port)
+    {
+        IpAddress const ip = FromSockAddr(info, out_port);
+        if (out_ipAddress)
+            *out_ipAddress = ip;
+    }
 
     return static_cast<unsigned>(amountRead);
 }
 
+SocketStats UdpBasicSocket::GetStats() const
+{
+    return m_stats ? m_stats->Snapshot() : SocketStats();
+}
+
 // returns the total amount of data in the buffer.
 // A call to Read will not necessarily return this much data, since the buffer may contain many datagrams.
 // returns -1 on error
@@ -20,6 +20,7 @@
 #include <strapper/net/SocketError.h>
 
 #include <cassert>
+#include <exception>
 
 namespace strapper { namespace net {
 
@@ -96,10 +97,23 @@ ErrorCode::ErrorCode(std::exception_ptr exception)  // NOLINT(performance-unnece
             m_nativeErrorCode = e.NativeCode();
             m_what = e.what();
         }
+        catch (IntegrityError const& e)
+        {
+            m_integrityError = true;
+            m_what = e.what();
+        }
         catch (ProgramError const& e)
         {
             m_what = e.what();
         }
+        catch (std::exception const& e)
+        {
+            m_what = e.what();
+        }
+        catch (...)
+        {
+            m_what = "Unknown exception.";
+        }
     }
 }
 
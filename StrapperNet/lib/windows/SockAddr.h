@@ -0,0 +1,100 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include "SocketIncludes.h"
+#include <strapper/net/IpAddress.h>
+#include <strapper/net/SocketError.h>
+#include <strapper/net/SocketHandle.h>
+#include "SocketFd.h"
+
+#include <cstring>
+
+namespace strapper { namespace net {
+
+// Opens a dual-stack IPv6 socket that also carries IPv4 traffic as IPv4-mapped addresses.
+// Falls back to an IPv4 socket on hosts without IPv6. out_family receives the family that was opened.
+inline SocketHandle MakeDualStackSocket(int socktype, int protocol, int* out_family)
+{
+    try
+    {
+        SocketHandle socket(AF_INET6, socktype, protocol);
+        DWORD const no = 0;
+        if (setsockopt(**socket, IPPROTO_IPV6, IPV6_V6ONLY, reinterpret_cast<char const*>(&no), sizeof(no)) == SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            throw SocketError(WSAGetLastError());
+        *out_family = AF_INET6;
+        return socket;
+    }
+    catch (SocketError const& e)
+    {
+        if (e.NativeCode() != WSAEAFNOSUPPORT)
+            throw;
+    }
+    *out_family = AF_INET;
+    return SocketHandle(AF_INET, socktype, protocol);
+}
+
+// Fills in an endpoint usable by a socket of the given family. IPv4 addresses are mapped for IPv6 sockets.
+// Returns the length of the filled-in structure.
+inline int ToSockAddr(IpAddress const& ip, uint16_t port, int family, sockaddr_storage* out_addr)
+{
+    *out_addr = sockaddr_storage{};
+    if (family == AF_INET6)
+    {
+        auto* addr6 = reinterpret_cast<sockaddr_in6*>(out_addr);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_port = htons(port);
+        auto const bytes = ip.IsV4() ? IpAddressV6::MapV4(ip.V4()).ToArray() : ip.V6().ToArray();
+        std::memcpy(&addr6->sin6_addr, bytes.data(), bytes.size());
+        return static_cast<int>(sizeof(sockaddr_in6));
+    }
+
+    if (!ip.IsV4())
+        throw ProgramError("Cannot reach an IPv6 address from an IPv4 socket: '" + ip.ToString() + "'");
+    auto* addr4 = reinterpret_cast<sockaddr_in*>(out_addr);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    addr4->sin_family = AF_INET;
+    addr4->sin_port = htons(port);
+    addr4->sin_addr.s_addr = ip.V4().ToInt();
+    return static_cast<int>(sizeof(sockaddr_in));
+}
+
+// Reads an endpoint filled in by the system. IPv4-mapped addresses are reported as IPv4.
+inline IpAddress FromSockAddr(sockaddr_storage const& addr, uint16_t* out_port)
+{
+    if (addr.ss_family == AF_INET6)
+    {
+        auto const* addr6 = reinterpret_cast<sockaddr_in6 const*>(&addr);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        if (out_port)
+            *out_port = ntohs(addr6->sin6_port);
+        std::array<uint8_t, 16> bytes{};
+        std::memcpy(bytes.data(), &addr6->sin6_addr, bytes.size());
+        IpAddressV6 const ip(bytes);
+        if (ip.IsV4Mapped())
+            return ip.ToV4();
+        return ip;
+    }
+    if (addr.ss_family == AF_INET)
+    {
+        auto const* addr4 = reinterpret_cast<sockaddr_in const*>(&addr);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        if (out_port)
+            *out_port = ntohs(addr4->sin_port);
+        return IpAddressV4(addr4->sin_addr.s_addr);
+    }
+    throw ProgramError("Unexpected address family.");
+}
+
+}}  // namespace strapper::net
@@ -0,0 +1,114 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include "SocketIncludes.h"
+#include "SockOpts.h"
+
+#include <strapper/net/SocketError.h>
+#include "SocketFd.h"
+
+#include <chrono>
+#include <limits>
+
+namespace strapper { namespace net {
+
+namespace {
+
+void SetDword(SocketHandle const& socket, int level, int name, DWORD value)
+{
+    if (setsockopt(**socket, level, name, reinterpret_cast<char const*>(&value), sizeof(value)) == SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        throw SocketError(WSAGetLastError());
+}
+
+DWORD GetDword(SocketHandle const& socket, int level, int name)
+{
+    DWORD value = 0;
+    int len = sizeof(value);
+    if (getsockopt(**socket, level, name, reinterpret_cast<char*>(&value), &len) == SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        throw SocketError(WSAGetLastError());
+    return value;
+}
+
+template <typename Rep, typename Period>
+DWORD ToDword(std::chrono::duration<Rep, Period> value)
+{
+    if (value.count() < 0 || value.count() > std::numeric_limits<int>::max())
+        throw ProgramError("Socket option duration is out of range.");
+    return static_cast<DWORD>(value.count());
+}
+
+}  // namespace
+
+void ApplySocketOptions(SocketHandle const& socket, SocketOptions const& options)
+{
+    // Reject before anything is applied.
+    if (options.cork.IsSet())
+        throw ProgramError("TCP_CORK is not supported on Windows.");
+    if (options.quickAck.IsSet())
+        throw ProgramError("TCP_QUICKACK is not supported on Windows.");
+    if (options.notSentLowWatermark.IsSet())
+        throw ProgramError("TCP_NOTSENT_LOWAT is not supported on Windows.");
+    if (options.maxSegmentSize.IsSet())
+        throw ProgramError("Setting TCP_MAXSEG is not supported on Windows.");
+    if (options.tos.IsSet())
+        throw ProgramError("IP_TOS is ignored by Windows. Use QoS policies instead.");
+
+    if (options.noDelay.IsSet())
+        SetDword(socket, IPPROTO_TCP, TCP_NODELAY, options.noDelay.Get() ? 1 : 0);
+    if (options.sendBufferSize.IsSet())
+        SetDword(socket, SOL_SOCKET, SO_SNDBUF, static_cast<DWORD>(options.sendBufferSize.Get()));
+    if (options.receiveBufferSize.IsSet())
+        SetDword(socket, SOL_SOCKET, SO_RCVBUF, static_cast<DWORD>(options.receiveBufferSize.Get()));
+    if (options.keepAlive.IsSet())
+    {
+        KeepAlive const& keepAlive = options.keepAlive.Get();
+        SetDword(socket, SOL_SOCKET, SO_KEEPALIVE, keepAlive.enable ? 1 : 0);
+        // The per-socket timers need Windows 10 version 1709.
+        if (keepAlive.idle.count() > 0)
+            SetDword(socket, IPPROTO_TCP, TCP_KEEPIDLE, ToDword(keepAlive.idle));
+        if (keepAlive.interval.count() > 0)
+            SetDword(socket, IPPROTO_TCP, TCP_KEEPINTVL, ToDword(keepAlive.interval));
+        if (keepAlive.count > 0)
+            SetDword(socket, IPPROTO_TCP, TCP_KEEPCNT, keepAlive.count);
+    }
+    if (options.userTimeout.IsSet())
+    {
+        // TCP_MAXRT is in whole seconds. Round up so a short timeout does not become "never".
+        auto const milliseconds = ToDword(options.userTimeout.Get());
+        SetDword(socket, IPPROTO_TCP, TCP_MAXRT, (milliseconds + 999) / 1000);  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+    }
+}
+
+SocketOptions QuerySocketOptions(SocketHandle const& socket)
+{
+    SocketOptions options;
+    options.sendBufferSize = static_cast<int>(GetDword(socket, SOL_SOCKET, SO_SNDBUF));
+    options.receiveBufferSize = static_cast<int>(GetDword(socket, SOL_SOCKET, SO_RCVBUF));
+    if (GetDword(socket, SOL_SOCKET, SO_TYPE) != SOCK_STREAM)
+        return options;
+
+    options.noDelay = GetDword(socket, IPPROTO_TCP, TCP_NODELAY) != 0;
+    KeepAlive keepAlive;
+    keepAlive.enable = GetDword(socket, SOL_SOCKET, SO_KEEPALIVE) != 0;
+    keepAlive.idle = std::chrono::seconds(GetDword(socket, IPPROTO_TCP, TCP_KEEPIDLE));
+    keepAlive.interval = std::chrono::seconds(GetDword(socket, IPPROTO_TCP, TCP_KEEPINTVL));
+    keepAlive.count = GetDword(socket, IPPROTO_TCP, TCP_KEEPCNT);
+    options.keepAlive = keepAlive;
+    options.userTimeout = std::chrono::seconds(GetDword(socket, IPPROTO_TCP, TCP_MAXRT));
+    return options;
+}
+
+}}  // namespace strapper::net
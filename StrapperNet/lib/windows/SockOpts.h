@@ -0,0 +1,32 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#pragma once
+
+#include <strapper/net/SocketHandle.h>
+#include <strapper/net/SocketOptions.h>
+
+namespace strapper { namespace net {
+
+// Sets every option that is set in options. Throws SocketError if the system rejects one,
+// or ProgramError for an option this platform does not have.
+// Options already applied before the failure stay applied.
+void ApplySocketOptions(SocketHandle const& socket, SocketOptions const& options);
+
+// Reads back the current value of every option the socket supports.
+SocketOptions QuerySocketOptions(SocketHandle const& socket);
+
+}}  // namespace strapper::net
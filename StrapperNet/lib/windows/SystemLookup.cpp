@@ -0,0 +1,66 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include "SocketIncludes.h"
+#include <strapper/net/Resolver.h>
+
+#include <strapper/net/SocketError.h>
+#include <strapper/net/SystemContext.h>
+#include "SockAddr.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace strapper { namespace net {
+
+Resolver::Addresses Resolver::SystemLookup(std::string const& host)
+{
+    SystemContext const context;
+
+    addrinfo hostInfo{};
+    hostInfo.ai_family = AF_UNSPEC;      // Can be IPv4 or IPv6
+    hostInfo.ai_socktype = SOCK_STREAM;  // One entry per address rather than one per socket type.
+
+    auto lFreeList = [](addrinfo* p) { freeaddrinfo(p); };
+    std::unique_ptr<addrinfo, decltype(lFreeList)> hostInfoList(nullptr, lFreeList);
+
+    {
+        addrinfo* hil = nullptr;
+        int const error = getaddrinfo(host.c_str(), nullptr, &hostInfo, &hil);
+        if (error != 0)
+            throw SocketError(error);
+        hostInfoList.reset(hil);
+    }
+
+    Addresses addresses;
+    for (addrinfo const* info = hostInfoList.get(); info; info = info->ai_next)
+    {
+        if ((info->ai_family != AF_INET && info->ai_family != AF_INET6) || info->ai_addrlen > sizeof(sockaddr_storage))
+            continue;
+        sockaddr_storage addr{};
+        std::memcpy(&addr, info->ai_addr, info->ai_addrlen);
+        IpAddress const ip = FromSockAddr(addr, nullptr);
+        if (std::find(addresses.cbegin(), addresses.cend(), ip) == addresses.cend())
+            addresses.push_back(ip);
+    }
+
+    if (addresses.empty())
+        throw ProgramError("getaddrinfo returned empty list.");
+    return addresses;
+}
+
+}}  // namespace strapper::net
@@ -18,36 +18,24 @@
 #include <strapper/net/TcpBasicListener.h>
 
 #include <strapper/net/SocketError.h>
+#include "SockAddr.h"
+#include "SockOpts.h"
 #include "SocketFd.h"
 
-#include <memory>
 
 namespace strapper { namespace net {
 
 namespace {
 
-SocketHandle Start(uint16_t port)
+// Listens on all interfaces. The socket is dual-stack, so IPv4 clients are accepted as IPv4-mapped peers.
+SocketHandle Start(uint16_t port, SocketOptions const& options)
 {
-    addrinfo hostInfo{};
-    hostInfo.ai_family = AF_INET;
-    hostInfo.ai_socktype = SOCK_STREAM;
-    hostInfo.ai_protocol = IPPROTO_TCP;
-    hostInfo.ai_flags = AI_PASSIVE;
+    int family = 0;
+    SocketHandle socket = MakeDualStackSocket(SOCK_STREAM, IPPROTO_TCP, &family);
 
-    auto lFreeList = [](addrinfo* p) { freeaddrinfo(p); };
-    std::unique_ptr<addrinfo, decltype(lFreeList)> hostInfoList(nullptr, lFreeList);
-
-    {
-        addrinfo* hil = nullptr;
-        int const error = getaddrinfo(nullptr, std::to_string(port).c_str(), &hostInfo, &hil);
-        if (error != 0)
-            throw SocketError(error);
-        if (!hil)
-            throw ProgramError("getaddrinfo returned empty list.");
-        hostInfoList.reset(hil);
-    }
-
-    SocketHandle socket = SocketHandle(hostInfoList->ai_family, hostInfoList->ai_socktype, hostInfoList->ai_protocol);
+    sockaddr_storage myInfo{};
+    IpAddress const any = family == AF_INET6 ? IpAddress(IpAddressV6::Any) : IpAddress(IpAddressV4::Any);
+    int const myInfoLen = ToSockAddr(any, port, family, &myInfo);
 
     /*
     BOOL const yes = true;
@@ -55,7 +43,9 @@ SocketHandle Start(uint16_t port)
         throw SocketError(WSAGetLastError());
     // */
 
-    if (bind(**socket, hostInfoList->ai_addr, static_cast<int>(hostInfoList->ai_addrlen)) == SOCKET_ERROR)
+    ApplySocketOptions(socket, options);
+
+    if (bind(**socket, reinterpret_cast<sockaddr*>(&myInfo), myInfoLen) == SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
         throw SocketError(WSAGetLastError());
 
     if (listen(**socket, TcpBasicListener::c_backlog) == SOCKET_ERROR)
@@ -67,7 +57,13 @@ SocketHandle Start(uint16_t port)
 }  // namespace
 
 TcpBasicListener::TcpBasicListener(uint16_t port)
-    : m_socket(Start(port))
+    : TcpBasicListener(port, SocketOptions())
+{ }
+
+//! The options are applied before listening, so no connection is accepted without them.
+//! Accepted sockets inherit them from the listener, except quickAck.
+TcpBasicListener::TcpBasicListener(uint16_t port, SocketOptions const& options)
+    : m_socket(Start(port, options))
 { }
 
 TcpBasicListener::~TcpBasicListener()
@@ -81,6 +77,31 @@ bool TcpBasicListener::IsListening() const
     return !!m_socket;
 }
 
+//! Applies every option that is set. Only sockets accepted afterwards inherit them.
+void TcpBasicListener::SetOptions(SocketOptions const& options)
+{
+    ApplySocketOptions(m_socket, options);
+}
+
+SocketOptions TcpBasicListener::GetOptions() const
+{
+    return QuerySocketOptions(m_socket);
+}
+
+//! The port the listener is bound to. Useful after listening on port 0, which lets the system choose.
+uint16_t TcpBasicListener::LocalPort() const
+{
+    if (!m_socket)
+        throw ProgramError("Listener is not open.");
+    sockaddr_storage addr{};
+    int len = static_cast<int>(sizeof(addr));
+    if (getsockname(**m_socket, reinterpret_cast<sockaddr*>(&addr), &len) == SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        throw SocketError(WSAGetLastError());
+    uint16_t port = 0;
+    FromSockAddr(addr, &port);
+    return port;
+}
+
 void TcpBasicListener::Close() noexcept
 {
     shutdown();
@@ -17,51 +17,203 @@
 #include "SocketIncludes.h"
 #include <strapper/net/TcpBasicSocket.h>
 
+#include <strapper/net/MetricsRegistry.h>
+#include <strapper/net/Resolver.h>
 #include <strapper/net/SocketError.h>
+#include <strapper/net/Trace.h>
+#include "SockAddr.h"
+#include "SockOpts.h"
 #include "SocketFd.h"
 
+#include <io.h>
+#include <mswsock.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
 #include <limits>
+#include <vector>
+
+#pragma comment(lib, "Mswsock.lib")
 
 namespace strapper { namespace net {
 
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t TcpBasicSocket::c_zeroCopyThreshold;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr int TcpBasicSocket::c_zeroCopyLingerMilliseconds;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t TcpBasicSocket::c_receiveMapBytes;
+// NOLINTNEXTLINE(readability-redundant-declaration): Needed for GCC.
+constexpr size_t TcpBasicSocket::c_receiveCopyBytes;
+
 namespace {
 
-//! Connects to host:port
-SocketHandle Connect(std::string const& host, uint16_t port)
+size_t constexpr c_spliceChunk = 64 * 1024;
+
+using Clock = std::chrono::steady_clock;
+
+long RemainingMilliseconds(Clock::time_point until)
 {
-    addrinfo hostInfo{};
-    hostInfo.ai_family = AF_UNSPEC;      // Can be IPv4 or IPv6
-    hostInfo.ai_socktype = SOCK_STREAM;  // TCP
+    auto const remaining = std::chrono::duration_cast<std::chrono::milliseconds>(until - Clock::now()).count();
+    return static_cast<long>(std::max<decltype(remaining)>(0, std::min<decltype(remaining)>(remaining, std::numeric_limits<long>::max())));
+}
 
-    auto lFreeList = [](addrinfo* p) { freeaddrinfo(p); };
-    std::unique_ptr<addrinfo, decltype(lFreeList)> hostInfoList(nullptr, lFreeList);
+void SetNonBlocking(SocketHandle const& socket, bool enable)
+{
+    u_long arg = enable ? 1 : 0;
+    if (ioctlsocket(**socket, FIONBIO, &arg) == SOCKET_ERROR)
+        throw SocketError(WSAGetLastError());
+}
 
-    {
-        addrinfo* hil = nullptr;
-        int const error = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hostInfo, &hil);
-        if (error != 0)
-            throw SocketError(error);
-        if (!hil)
-            throw ProgramError("getaddrinfo returned empty list.");
-        hostInfoList.reset(hil);
-    }
+bool HasLocalBind(ConnectOptions const& options)
+{
+    return options.localPort != 0 || options.localAddress != IpAddress(IpAddressV4::Any);
+}
 
-    if (hostInfoList->ai_addrlen > static_cast<size_t>(std::numeric_limits<int>::max()))
-        throw ProgramError("getaddrinfo returned invalid length.");
+//! Applies the local address of the options to a socket that has not connected yet.
+//! Windows has no IP_BIND_ADDRESS_NO_PORT, so binding a local address reserves a port for the life of the socket.
+void BindLocal(SocketHandle const& socket, int family, ConnectOptions const& options)
+{
+    if (!options.device.empty())
+        throw ProgramError("Binding to a device is not supported on Windows. Bind the interface's local address instead.");
 
-    SocketHandle socket(hostInfoList->ai_family, hostInfoList->ai_socktype, hostInfoList->ai_protocol);
+    if (!HasLocalBind(options))
+        return;
 
-    if (connect(**socket, hostInfoList->ai_addr, static_cast<int>(hostInfoList->ai_addrlen)) == SOCKET_ERROR)
+    sockaddr_storage addr{};
+    int const addrLen = ToSockAddr(options.localAddress, options.localPort, family, &addr);
+    if (bind(**socket, reinterpret_cast<sockaddr*>(&addr), addrLen) == SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
         throw SocketError(WSAGetLastError());
+}
 
-    return socket;
+//! Keeps only the addresses that can be reached from the local address of the options, if one is set.
+Resolver::Addresses MatchLocalFamily(Resolver::Addresses addresses, ConnectOptions const& options)
+{
+    if (!HasLocalBind(options))
+        return addresses;
+    auto const family = options.localAddress.GetFamily();
+    addresses.erase(std::remove_if(addresses.begin(), addresses.end(), [family](IpAddress const& ip) { return ip.GetFamily() != family; }),
+                    addresses.end());
+    if (addresses.empty())
+        throw ProgramError("No resolved address has the family of the local address: '" + options.localAddress.ToString() + "'");
+    return addresses;
+}
+
+//! Connects to host:port. The host is resolved through the resolver cache, then the addresses are raced
+//! with staggered non-blocking connects. The first to complete is returned in blocking mode.
+//! Uses select rather than WSAPoll, which does not report failed connects before Windows 10 2004.
+SocketHandle Connect(std::string const& host, uint16_t port, ConnectOptions const& options)
+{
+    Resolver& resolver = options.resolver ? *options.resolver : Resolver::Global();
+    Resolver::Addresses const addresses = Resolver::InterleaveFamilies(MatchLocalFamily(resolver.Resolve(host), options));
+
+    bool const bounded = options.timeout.count() > 0;
+    auto const deadline = Clock::now() + options.timeout;
+
+    std::vector<SocketHandle> attempts;
+    size_t next = 0;
+    auto nextStart = Clock::now();
+    std::exception_ptr lastFailure = std::make_exception_ptr(SocketError(WSAETIMEDOUT));
+
+    for (;;)
+    {
+        if (next < addresses.size() && (attempts.empty() || Clock::now() >= nextStart))
+        {
+            IpAddress const& ip = addresses[next++];
+            try
+            {
+                int const family = ip.IsV4() ? AF_INET : AF_INET6;
+                sockaddr_storage addr{};
+                int const addrLen = ToSockAddr(ip, port, family, &addr);
+
+                SocketHandle socket(family, SOCK_STREAM, IPPROTO_TCP);
+                BindLocal(socket, family, options);
+                ApplySocketOptions(socket, options.socketOptions);
+                SetNonBlocking(socket, true);
+                if (connect(**socket, reinterpret_cast<sockaddr*>(&addr), addrLen) == 0)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                {
+                    SetNonBlocking(socket, false);
+                    return socket;
+                }
+                int const error = WSAGetLastError();
+                if (error == WSAEWOULDBLOCK && attempts.size() < FD_SETSIZE)
+                {
+                    attempts.push_back(std::move(socket));
+                    nextStart = Clock::now() + options.attemptDelay;
+                }
+                else
+                    lastFailure = std::make_exception_ptr(SocketError(error));  // Failed outright. Move on to the next address right away.
+            }
+            catch (ProgramError const&)
+            {
+                // Setting up this attempt failed, e.g. binding to the local address. Like a failed connect, move on.
+                lastFailure = std::current_exception();
+            }
+            continue;
+        }
+
+        if (attempts.empty())
+            std::rethrow_exception(lastFailure);
+        if (bounded && Clock::now() >= deadline)
+            throw SocketError(WSAETIMEDOUT);
+
+        long wait = -1;
+        if (next < addresses.size())
+            wait = RemainingMilliseconds(nextStart);
+        if (bounded)
+            wait = wait < 0 ? RemainingMilliseconds(deadline) : std::min(wait, RemainingMilliseconds(deadline));
+
+        fd_set writable{};
+        fd_set failed{};
+        FD_ZERO(&writable);
+        FD_ZERO(&failed);
+        for (auto const& attempt : attempts)
+        {
+            FD_SET(**attempt, &writable);
+            FD_SET(**attempt, &failed);
+        }
+        timeval t{};
+        t.tv_sec = wait / 1000;            // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        t.tv_usec = (wait % 1000) * 1000;  // NOLINT(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+        if (select(0, nullptr, &writable, &failed, wait < 0 ? nullptr : &t) == SOCKET_ERROR)
+            throw SocketError(WSAGetLastError());
+
+        for (size_t i = 0; i < attempts.size();)
+        {
+            if (FD_ISSET(**attempts[i], &writable))
+            {
+                SocketHandle socket = std::move(attempts[i]);
+                SetNonBlocking(socket, false);
+                return socket;  // The other attempts are closed as they go out of scope.
+            }
+            if (!FD_ISSET(**attempts[i], &failed))
+            {
+                ++i;
+                continue;
+            }
+            int error = 0;
+            int errorLen = sizeof(error);
+            if (getsockopt(**attempts[i], SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &errorLen) == SOCKET_ERROR)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                error = WSAGetLastError();
+            lastFailure = std::make_exception_ptr(SocketError(error));
+            attempts.erase(attempts.begin() + static_cast<std::ptrdiff_t>(i));
+            nextStart = Clock::now();  // A failed attempt hands over to the next address immediately.
+        }
+    }
 }
 
 }  // namespace
 
-//! Unused for this implementation.
+//! Provide additional data members specific to an implementation.
+//! Windows has no splice, so SpliceRead copies through this buffer instead.
 struct TcpBasicSocketImpl
-{ };
+{
+    std::vector<char> m_spliceBuffer;
+    size_t m_spliced = 0;  // Bytes in the buffer waiting for SpliceWrite.
+    std::vector<char> m_viewBuffer;  // Holds the bytes of a ReadView.
+};
 
 TcpBasicSocket::TcpBasicSocket() = default;
 TcpBasicSocket::TcpBasicSocket(TcpBasicSocket&&) noexcept = default;
@@ -69,13 +221,28 @@ TcpBasicSocket& TcpBasicSocket::operator=(TcpBasicSocket&&) noexcept = default;
 
 //! Constructor connects to host:port.
 TcpBasicSocket::TcpBasicSocket(std::string const& host, uint16_t port)
-    : m_socket(Connect(host, port))
+    : TcpBasicSocket(host, port, ConnectOptions())
 { }
 
+//! Constructor connects to host:port, racing the resolved addresses as the options describe.
+TcpBasicSocket::TcpBasicSocket(std::string const& host, uint16_t port, ConnectOptions const& options)
+    : m_socket(Connect(host, port, options))
+    , m_impl(new TcpBasicSocketImpl)
+    , m_stats(new SocketStatsCounters)
+{
+    Trace::Record(TraceEvent::TCP_CONNECT, static_cast<int64_t>(**m_socket), port);
+    MetricsRegistry::Global().Add(MetricsRegistry::Counter::TCP_CONNECTS);
+}
+
 //! Special private constructor used only by TcpListener.Accept().
 TcpBasicSocket::TcpBasicSocket(SocketHandle&& socket)
     : m_socket(std::move(socket))
-{ }
+    , m_impl(new TcpBasicSocketImpl)
+    , m_stats(new SocketStatsCounters)
+{
+    MetricsRegistry::Global().Add(MetricsRegistry::Counter::TCP_ACCEPTS);
+    Trace::Record(TraceEvent::TCP_ACCEPT, static_cast<int64_t>(**m_socket), 0);
+}
 
 TcpBasicSocket::~TcpBasicSocket()
 {
@@ -105,6 +272,17 @@ void TcpBasicSocket::SetReadTimeout(unsigned milliseconds)
         throw SocketError(WSAGetLastError());
 }
 
+//! Applies every option that is set. See SocketOptions.
+void TcpBasicSocket::SetOptions(SocketOptions const& options)
+{
+    ApplySocketOptions(m_socket, options);
+}
+
+SocketOptions TcpBasicSocket::GetOptions() const
+{
+    return QuerySocketOptions(m_socket);
+}
+
 void TcpBasicSocket::ShutdownSend()
 {
     if (shutdown(**m_socket, SD_SEND) == SOCKET_ERROR)
@@ -129,9 +307,14 @@ void TcpBasicSocket::ShutdownBoth() noexcept
     }
 }
 
-//! Shutdown and close the socket.
-void TcpBasicSocket::Close() noexcept
+//! Shutdown and close the socket. Nothing is ever outstanding from WriteZeroCopy on Windows.
+void TcpBasicSocket::Close(ZeroCopyReleases* /*out_released*/) noexcept
 {
+    if (m_socket)
+    {
+        Trace::Record(TraceEvent::TCP_CLOSE, static_cast<int64_t>(**m_socket), 0);
+        MetricsRegistry::Global().Add(MetricsRegistry::Counter::TCP_CLOSES);
+    }
     ShutdownBoth();
     m_socket.Close();
 }
@@ -145,8 +328,24 @@ void TcpBasicSocket::Write(void const* src, size_t len)
     if (len > static_cast<size_t>(std::numeric_limits<int>::max()))
         throw ProgramError("Length must be less than int max.");
 
-    if (send(**m_socket, static_cast<char const*>(src), static_cast<int>(len), 0) == SOCKET_ERROR)
-        throw SocketError(WSAGetLastError());
+    auto const* cursor = static_cast<char const*>(src);
+    int remaining = static_cast<int>(len);
+    while (remaining > 0)
+    {
+        auto const start = SocketStatsCounters::Now();
+        Trace::Record(TraceEvent::TCP_WRITE_START, static_cast<int64_t>(**m_socket), remaining);
+        int const amountWritten = send(**m_socket, cursor, remaining, 0);
+        Trace::Record(TraceEvent::TCP_WRITE_END, static_cast<int64_t>(**m_socket), amountWritten);
+        m_stats->RecordWrite(amountWritten > 0 ? static_cast<size_t>(amountWritten) : 0, start);
+        if (amountWritten == SOCKET_ERROR)
+            throw SocketError(WSAGetLastError());
+
+        MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_WRITTEN, static_cast<uint64_t>(amountWritten));
+        cursor += amountWritten;
+        remaining -= amountWritten;
+        if (remaining > 0)
+            m_stats->RecordPartialWrite();
+    }
 }
 
 //! Reads len bytes into given buffer.
@@ -163,18 +362,215 @@ bool TcpBasicSocket::Read(void* dest, size_t len)
         if (len > static_cast<size_t>(std::numeric_limits<int>::max()))
             throw ProgramError("Length must be less than int max.");
 
+        auto* cursor = static_cast<char*>(dest);
         int const lenAsInt = static_cast<int>(len);
-        int const amountRead = recv(**m_socket, static_cast<char*>(dest), lenAsInt, MSG_WAITALL);
+        int remaining = lenAsInt;
+        while (remaining > 0)
+        {
+            auto const start = SocketStatsCounters::Now();
+            Trace::Record(TraceEvent::TCP_READ_START, static_cast<int64_t>(**m_socket), remaining);
+            int const amountRead = recv(**m_socket, cursor, remaining, MSG_WAITALL);
+            Trace::Record(TraceEvent::TCP_READ_END, static_cast<int64_t>(**m_socket), amountRead);
+            m_stats->RecordRead(amountRead > 0 ? static_cast<size_t>(amountRead) : 0, start);
+            if (amountRead == SOCKET_ERROR)
+                throw SocketError(WSAGetLastError());
+            if (amountRead == 0)
+            {
+                if (remaining != lenAsInt)
+                    throw ProgramError("Other side closed before all bytes were received.");
+                // Graceful close.
+                ShutdownReceive();
+                return false;
+            }
+
+            MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_READ, static_cast<uint64_t>(amountRead));
+            cursor += amountRead;
+            remaining -= amountRead;
+            if (remaining > 0)
+                m_stats->RecordPartialRead();
+        }
+        return true;
+    }
+    catch (...)
+    {
+        Close();
+        throw;
+    }
+}
+
+//! Sends len bytes of the file, starting at offset, with TransmitFile.
+//! Unlike Linux, the file position is moved. out_sent, if given, is kept up to date so it is valid if an exception is thrown.
+//! @return The number of bytes sent. Less than len only if the end of the file was reached.
+size_t TcpBasicSocket::SendFile(int fd, uint64_t offset, size_t len, size_t* out_sent /* = nullptr */)
+{
+    if (len == 0)
+        throw ProgramError("Length must be greater than 0.");
+    HANDLE const file = reinterpret_cast<HANDLE>(_get_osfhandle(fd));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+    if (file == INVALID_HANDLE_VALUE)
+        throw ProgramError("Invalid file descriptor.");
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size))
+        throw SocketError(static_cast<int>(GetLastError()));
+    auto const fileSize = static_cast<uint64_t>(size.QuadPart);
+    if (offset >= fileSize)
+        return 0;
+    len = static_cast<size_t>(std::min<uint64_t>(len, fileSize - offset));
+
+    LARGE_INTEGER position{};
+    position.QuadPart = static_cast<LONGLONG>(offset);
+    if (!SetFilePointerEx(file, position, nullptr, FILE_BEGIN))
+        throw SocketError(static_cast<int>(GetLastError()));
+
+    size_t sent = 0;
+    if (out_sent)
+        *out_sent = 0;
+    while (sent < len)
+    {
+        auto const chunk = static_cast<DWORD>(std::min<size_t>(len - sent, std::numeric_limits<int>::max()));
+        auto const start = SocketStatsCounters::Now();
+        Trace::Record(TraceEvent::TCP_WRITE_START, static_cast<int64_t>(**m_socket), chunk);
+        BOOL const ok = TransmitFile(**m_socket, file, chunk, 0, nullptr, nullptr, 0);
+        Trace::Record(TraceEvent::TCP_WRITE_END, static_cast<int64_t>(**m_socket), ok ? chunk : -1);
+        m_stats->RecordWrite(ok ? chunk : 0, start);
+        if (!ok)
+            throw SocketError(WSAGetLastError());
+
+        MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_WRITTEN, chunk);
+        sent += chunk;
+        if (out_sent)
+            *out_sent = sent;
+    }
+    return sent;
+}
+
+//! Reads up to maxLen bytes that have arrived on this socket into an internal buffer.
+//! Blocks until some data is available. Each SpliceRead must be followed by a SpliceWrite before the next.
+//! @return The number of bytes read. Zero if the other side closed, in which case receiving is shut down.
+size_t TcpBasicSocket::SpliceRead(size_t maxLen)
+{
+    try
+    {
+        if (maxLen == 0)
+            throw ProgramError("Length must be greater than 0.");
+        if (m_impl->m_spliced != 0)
+            throw ProgramError("The previous splice has not been written.");
+
+        int const chunk = static_cast<int>(std::min(maxLen, c_spliceChunk));
+        m_impl->m_spliceBuffer.resize(c_spliceChunk);
+        auto const start = SocketStatsCounters::Now();
+        Trace::Record(TraceEvent::TCP_READ_START, static_cast<int64_t>(**m_socket), chunk);
+        int const amountRead = recv(**m_socket, m_impl->m_spliceBuffer.data(), chunk, 0);
+        Trace::Record(TraceEvent::TCP_READ_END, static_cast<int64_t>(**m_socket), amountRead);
+        m_stats->RecordRead(amountRead > 0 ? static_cast<size_t>(amountRead) : 0, start);
         if (amountRead == SOCKET_ERROR)
             throw SocketError(WSAGetLastError());
-        if (amountRead == 0 && len > 0)  // Graceful close.
+        if (amountRead == 0)
         {
+            // Graceful close.
             ShutdownReceive();
-            return false;
+            return 0;
         }
-        if (amountRead != lenAsInt)
-            throw ProgramError("Other side closed before all bytes were received.");
-        return true;
+
+        MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_READ, static_cast<uint64_t>(amountRead));
+        m_impl->m_spliced = static_cast<size_t>(amountRead);
+        return m_impl->m_spliced;
+    }
+    catch (...)
+    {
+        Close();
+        throw;
+    }
+}
+
+//! Writes everything read by the last SpliceRead to dest.
+void TcpBasicSocket::SpliceWrite(TcpBasicSocket& dest)
+{
+    if (&dest == this)
+        throw ProgramError("Cannot splice a socket to itself.");
+    if (m_impl->m_spliced == 0)
+        return;
+
+    size_t const spliced = m_impl->m_spliced;
+    m_impl->m_spliced = 0;
+    dest.Write(m_impl->m_spliceBuffer.data(), spliced);
+}
+
+//! Windows has no MSG_ZEROCOPY. The data is copied and onRelease is released as COPIED before returning.
+//! @param[out] out_released If given, onRelease is added to it instead of being called.
+void TcpBasicSocket::WriteZeroCopy(void const* src, size_t len, ZeroCopyCallback onRelease, ZeroCopyReleases* out_released /* = nullptr */)
+{
+    if (!onRelease)
+        throw ProgramError("Release callback is empty.");
+
+    ZeroCopyReleases released;
+    ZeroCopyReleases* const out = out_released ? out_released : &released;
+    out->emplace_back(std::move(onRelease), ZeroCopyStatus::COPIED);
+    try
+    {
+        Write(src, len);
+    }
+    catch (...)
+    {
+        CallReleases(&released);
+        throw;
+    }
+    CallReleases(&released);
+}
+
+//! Nothing is ever outstanding on Windows.
+size_t TcpBasicSocket::PollZeroCopy(int /*timeoutMilliseconds*/, ZeroCopyReleases* /*out_released*/)
+{
+    return 0;
+}
+
+bool TcpBasicSocket::ZeroCopyEnabled() const
+{
+    return false;
+}
+
+//! Calls the release callbacks handed out by WriteZeroCopy, and empties released.
+void TcpBasicSocket::CallReleases(ZeroCopyReleases* released) noexcept
+{
+    if (!released)
+        return;
+    for (auto& release : *released)
+        release.first(release.second);
+    released->clear();
+}
+
+//! Receives up to maxLen bytes into an internal buffer. Windows cannot map received pages, so they are always copied.
+//! Blocks until at least one byte is available, and returns whatever is available up to maxLen.
+//! @return The received bytes, valid until the next ReadView or Close. Empty if the other side closed, in
+//! which case receiving is shut down. On error the socket is closed.
+ReceiveView TcpBasicSocket::ReadView(size_t maxLen)
+{
+    try
+    {
+        if (maxLen == 0)
+            throw ProgramError("Length must be greater than 0.");
+
+        int const chunk = static_cast<int>(std::min(maxLen, c_receiveCopyBytes));
+        m_impl->m_viewBuffer.resize(c_receiveCopyBytes);
+        auto const start = SocketStatsCounters::Now();
+        Trace::Record(TraceEvent::TCP_READ_START, static_cast<int64_t>(**m_socket), chunk);
+        int const amountRead = recv(**m_socket, m_impl->m_viewBuffer.data(), chunk, 0);
+        Trace::Record(TraceEvent::TCP_READ_END, static_cast<int64_t>(**m_socket), amountRead);
+        m_stats->RecordRead(amountRead > 0 ? static_cast<size_t>(amountRead) : 0, start);
+        if (amountRead == SOCKET_ERROR)
+            throw SocketError(WSAGetLastError());
+        if (amountRead == 0)
+        {
+            // Graceful close.
+            ShutdownReceive();
+            return ReceiveView{};
+        }
+
+        MetricsRegistry::Count(MetricsRegistry::Counter::TCP_BYTES_READ, static_cast<uint64_t>(amountRead));
+        ReceiveView view;
+        view.data = m_impl->m_viewBuffer.data();
+        view.size = static_cast<size_t>(amountRead);
+        return view;
     }
     catch (...)
     {
@@ -199,6 +595,50 @@ unsigned TcpBasicSocket::DataAvailable()
     return bytesAvailable;
 }
 
+//! Waits until at least one of the sockets can be read without blocking.
+//! That includes when the other side has closed the connection or there is an error, since Read will return immediately.
+//! @param[in] timeoutMilliseconds Negative waits forever.
+//! @param[out] ready Resized to match sockets. Set to true for each socket that is ready.
+//! @return The number of ready sockets. 0 if the timeout was reached.
+size_t TcpBasicSocket::WaitReadable(std::vector<TcpBasicSocket const*> const& sockets, std::vector<bool>* ready, int timeoutMilliseconds)
+{
+    if (!ready)
+        throw ProgramError("Null pointer.");
+    if (sockets.empty())
+        throw ProgramError("No sockets to wait on.");
+    if (sockets.size() > std::numeric_limits<ULONG>::max())
+        throw ProgramError("Too many sockets.");
+
+    std::vector<WSAPOLLFD> fds(sockets.size());
+    for (size_t i = 0; i < sockets.size(); ++i)
+    {
+        if (!sockets[i] || !sockets[i]->m_socket)
+            throw ProgramError("Socket is not open.");
+        fds[i].fd = **sockets[i]->m_socket;
+        fds[i].events = POLLRDNORM;
+    }
+
+    int const count = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeoutMilliseconds);
+    if (count == SOCKET_ERROR)
+        throw SocketError(WSAGetLastError());
+
+    ready->assign(sockets.size(), false);
+    for (size_t i = 0; i < fds.size(); ++i)
+        (*ready)[i] = fds[i].revents != 0;
+    return static_cast<size_t>(count);
+}
+
+//! SIO_TCP_INFO needs Windows 10 version 1703, but this library targets Vista.
+TcpInfo TcpBasicSocket::GetTcpInfo() const
+{
+    throw ProgramError("TCP_INFO is not supported on Windows.");
+}
+
+SocketStats TcpBasicSocket::GetStats() const
+{
+    return m_stats ? m_stats->Snapshot() : SocketStats();
+}
+
 TcpBasicSocket::operator bool() const
 {
     return IsOpen();
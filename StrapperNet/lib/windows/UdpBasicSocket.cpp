@@ -17,7 +17,11 @@
 #include "SocketIncludes.h"
 #include <strapper/net/UdpBasicSocket.h>
 
+#include <strapper/net/MetricsRegistry.h>
 #include <strapper/net/SocketError.h>
+#include <strapper/net/Trace.h>
+#include "SockAddr.h"
+#include "SockOpts.h"
 #include "SocketFd.h"
 
 #include <limits>
@@ -26,21 +30,21 @@ namespace strapper { namespace net {
 
 namespace {
 
-// Creates a socket and binds it to the given port. Set to 0 for any.
-SocketHandle MakeSocket(uint16_t myport)
+// Creates a dual-stack socket and binds it to the given port on all interfaces. Set to 0 for any.
+SocketHandle MakeSocket(uint16_t myport, int* out_family)
 {
-    SocketHandle socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    SocketHandle socket = MakeDualStackSocket(SOCK_DGRAM, IPPROTO_UDP, out_family);
 
-    sockaddr_in myInfo{};
-    myInfo.sin_family = AF_INET;
-    myInfo.sin_addr.s_addr = htonl(INADDR_ANY);
-    myInfo.sin_port = htons(myport);
+    sockaddr_storage myInfo{};
+    IpAddress const any = *out_family == AF_INET6 ? IpAddress(IpAddressV6::Any) : IpAddress(IpAddressV4::Any);
+    int const myInfoLen = ToSockAddr(any, myport, *out_family, &myInfo);
 
     auto const status = bind(**socket,
                              reinterpret_cast<sockaddr*>(&myInfo),  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-                             sizeof(myInfo));
+                             myInfoLen);
     if (status == SOCKET_ERROR)
         throw SocketError(WSAGetLastError());
+    Trace::Record(TraceEvent::UDP_BIND, static_cast<int64_t>(**socket), myport);
 
     return socket;
 }
@@ -49,7 +53,8 @@ SocketHandle MakeSocket(uint16_t myport)
 
 //! 0 for any.
 UdpBasicSocket::UdpBasicSocket(uint16_t myport)
-    : m_socket(MakeSocket(myport))
+    : m_socket(MakeSocket(myport, &m_family))
+    , m_stats(new SocketStatsCounters)
 { }
 
 UdpBasicSocket::~UdpBasicSocket()
@@ -79,6 +84,17 @@ void UdpBasicSocket::SetReadTimeout(unsigned milliseconds)
         throw SocketError(WSAGetLastError());
 }
 
+//! Applies every option that is set. The TCP options are rejected by the system.
+void UdpBasicSocket::SetOptions(SocketOptions const& options)
+{
+    ApplySocketOptions(m_socket, options);
+}
+
+SocketOptions UdpBasicSocket::GetOptions() const
+{
+    return QuerySocketOptions(m_socket);
+}
+
 void UdpBasicSocket::Shutdown() noexcept
 {
     if (m_socket)
@@ -95,10 +111,12 @@ void UdpBasicSocket::Shutdown() noexcept
 void UdpBasicSocket::Close() noexcept
 {
     Shutdown();
+    if (m_socket)
+        Trace::Record(TraceEvent::UDP_CLOSE, static_cast<int64_t>(**m_socket), 0);
     m_socket.Close();
 }
 
-void UdpBasicSocket::Write(void const* src, size_t len, IpAddressV4 const& ipAddress, uint16_t port)
+void UdpBasicSocket::Write(void const* src, size_t len, IpAddress const& ipAddress, uint16_t port)
 {
     if (!src)
         throw ProgramError("Null pointer.");
@@ -107,26 +125,23 @@ void UdpBasicSocket::Write(void const* src, size_t len, IpAddressV4 const& ipAdd
     if (len > static_cast<size_t>(std::numeric_limits<int>::max()))
         throw ProgramError("Length must be less than int max.");
 
-    sockaddr_in info{};
-    info.sin_family = AF_INET;
-    info.sin_port = htons(port);
-    std::string const ipString = ipAddress.ToString('.');
-    int const success = inet_pton(AF_INET, ipString.c_str(), &info.sin_addr);
-    if (success == 0)
-        throw ProgramError("Invalid IP address: " + ipAddress.ToString('.'));
-    if (success == -1)
-        throw SocketError(WSAGetLastError());
-    if (success != 1)
-        throw ProgramError("Unknown error.");
+    sockaddr_storage info{};
+    int const infoLen = ToSockAddr(ipAddress, port, m_family, &info);
 
+    auto const start = SocketStatsCounters::Now();
+    Trace::Record(TraceEvent::UDP_WRITE_START, static_cast<int64_t>(**m_socket), static_cast<int64_t>(len));
     int const amountWritten = sendto(**m_socket,
                                      static_cast<char const*>(src),
                                      static_cast<int>(len),
                                      0,
                                      reinterpret_cast<sockaddr*>(&info),  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-                                     sizeof(info));
+                                     infoLen);
+    Trace::Record(TraceEvent::UDP_WRITE_END, static_cast<int64_t>(**m_socket), amountWritten);
+    m_stats->RecordWrite(amountWritten > 0 ? static_cast<size_t>(amountWritten) : 0, start);
     if (amountWritten == SOCKET_ERROR)
         throw SocketError(WSAGetLastError());
+    MetricsRegistry::Count(MetricsRegistry::Counter::UDP_DATAGRAMS_WRITTEN);
+    MetricsRegistry::Count(MetricsRegistry::Counter::UDP_BYTES_WRITTEN, static_cast<uint64_t>(amountWritten));
 }
 
 // if (amountRead == SOCKET_ERROR)
@@ -171,7 +186,7 @@ void UdpBasicSocket::Write(void const* src, size_t len, IpAddressV4 const& ipAdd
 //     }
 // }
 
-unsigned UdpBasicSocket::Read(void* dest, size_t maxlen, IpAddressV4* out_ipAddress, uint16_t* out_port)
+unsigned UdpBasicSocket::Read(void* dest, size_t maxlen, IpAddress* out_ipAddress, uint16_t* out_port)
 {
     if (!dest)
         throw ProgramError("Null pointer.");
@@ -180,30 +195,41 @@ unsigned UdpBasicSocket::Read(void* dest, size_t maxlen, IpAddressV4* out_ipAddr
     if (maxlen > static_cast<size_t>(std::numeric_limits<int>::max()))
         throw ProgramError("Max length must be less than int max.");
 
-    sockaddr_in info{};
+    sockaddr_storage info{};
     int infoLen = sizeof(info);
+    auto const start = SocketStatsCounters::Now();
+    Trace::Record(TraceEvent::UDP_READ_START, static_cast<int64_t>(**m_socket), static_cast<int64_t>(maxlen));
     int const amountRead = recvfrom(**m_socket,
                                     static_cast<char*>(dest),
                                     static_cast<int>(maxlen),
                                     0,
                                     reinterpret_cast<sockaddr*>(&info),  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
                                     &infoLen);
+    Trace::Record(TraceEvent::UDP_READ_END, static_cast<int64_t>(**m_socket), amountRead);
+    m_stats->RecordRead(amountRead > 0 ? static_cast<size_t>(amountRead) : 0, start);
     if (amountRead == 0)
         throw ProgramError("Socket was shut down.");
     if (amountRead == SOCKET_ERROR)
         throw SocketError(WSAGetLastError());
 
-    if ((out_ipAddress || out_port) && (infoLen != sizeof(info)))
-        throw ProgramError("Read returned unexpected endpoint info size.");
+    MetricsRegistry::Count(MetricsRegistry::Counter::UDP_DATAGRAMS_READ);
+    MetricsRegistry::Count(MetricsRegistry::Counter::UDP_BYTES_READ, static_cast<uint64_t>(amountRead));
 
-    if (out_ipAddress)
-        *out_ipAddress = IpAddressV4(info.sin_addr.s_addr);
-    if (out_port)
-        *out_port = ntohs(info.sin_port);
+    if (out_ipAddress || out_port)
+    {
+        IpAddress const ip = FromSockAddr(info, out_port);
+        if (out_ipAddress)
+            *out_ipAddress = ip;
+    }
 
     return static_cast<unsigned>(amountRead);
 }
 
+SocketStats UdpBasicSocket::GetStats() const
+{
+    return m_stats ? m_stats->Snapshot() : SocketStats();
+}
+
 // returns the total amount of data in the buffer.
 // A call to Read will not necessarily return this much data, since the buffer may contain many datagrams.
 // returns -1 on error
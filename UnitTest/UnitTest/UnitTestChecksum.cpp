@@ -0,0 +1,206 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <gtest/gtest.h>
+
+#include <strapper/net/Crc32c.h>
+#include <strapper/net/IpAddress.h>
+#include <strapper/net/SocketError.h>
+#include <strapper/net/TcpListener.h>
+#include <strapper/net/TcpSerializer.h>
+#include <strapper/net/UdpSocket.h>
+#include "TestGlobals.h"
+#include "Timeout.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace strapper { namespace net { namespace test {
+
+class UnitTestChecksum : public ::testing::Test
+{
+public:
+    Timeout m_timeout{ std::chrono::seconds(3) };
+};
+
+TEST_F(UnitTestChecksum, KnownValues)
+{
+    std::string const check = "123456789";
+    ASSERT_EQ(Crc32c(check.data(), check.length()), 0xE3069283u);
+    ASSERT_EQ(Crc32cPortable(check.data(), check.length()), 0xE3069283u);
+
+    std::vector<uint8_t> const zeros(32, 0x00);
+    ASSERT_EQ(Crc32c(zeros.data(), zeros.size()), 0x8A9136AAu);
+    std::vector<uint8_t> const ones(32, 0xFF);
+    ASSERT_EQ(Crc32c(ones.data(), ones.size()), 0x62A8AB43u);
+
+    ASSERT_EQ(Crc32c(nullptr, 0), 0u);
+}
+
+TEST_F(UnitTestChecksum, HardwareMatchesPortable)
+{
+    std::vector<uint8_t> data(4099);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<uint8_t>((i * 131) ^ (i >> 3));
+
+    // Cover every alignment and tail length.
+    for (size_t offset = 0; offset < 16; ++offset)
+    {
+        for (size_t len = 0; len < 40; ++len)
+            ASSERT_EQ(Crc32c(data.data() + offset, len), Crc32cPortable(data.data() + offset, len));
+        ASSERT_EQ(Crc32c(data.data() + offset, data.size() - offset), Crc32cPortable(data.data() + offset, data.size() - offset));
+    }
+}
+
+TEST_F(UnitTestChecksum, Continuation)
+{
+    std::string const check = "123456789";
+    uint32_t const first = Crc32c(check.data(), 4);
+    ASSERT_EQ(Crc32c(check.data() + 4, check.length() - 4, first), 0xE3069283u);
+    ASSERT_EQ(Crc32cPortable(check.data() + 4, check.length() - 4, first), 0xE3069283u);
+}
+
+TEST_F(UnitTestChecksum, Serializer)
+{
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSerializer sender(TcpSocket(TestGlobals::localhost, TestGlobals::testPortA));
+    TcpSerializer receiver(listener.Accept());
+    sender.EnableChecksums(true);
+    receiver.EnableChecksums(true);
+    ASSERT_TRUE(receiver.ChecksumsEnabled());
+
+    sender.Write('c');
+    sender.Write(true);
+    sender.Write(int32_t{ -20 });
+    sender.Write(5.25);
+    sender.Write(std::string("Hello, World!"));
+    sender.Write(std::string());
+    sender.WriteStream(3, [](char* dest, size_t) {
+        dest[0] = 'a';
+        dest[1] = 'b';
+        dest[2] = 'c';
+        return size_t{ 3 };
+    });
+
+    char c = 0;
+    bool b = false;
+    int32_t i = 0;
+    double d = 0;
+    std::string s;
+    ASSERT_TRUE(receiver.Read(&c));
+    ASSERT_EQ(c, 'c');
+    ASSERT_TRUE(receiver.Read(&b));
+    ASSERT_EQ(b, true);
+    ASSERT_TRUE(receiver.Read(&i));
+    ASSERT_EQ(i, -20);
+    ASSERT_TRUE(receiver.Read(&d));
+    ASSERT_EQ(d, 5.25);
+    ASSERT_TRUE(receiver.Read(&s));
+    ASSERT_EQ(s, "Hello, World!");
+    ASSERT_TRUE(receiver.Read(&s));
+    ASSERT_EQ(s, "");
+    std::string streamed;
+    ASSERT_TRUE(receiver.ReadStream([&streamed](char const* src, size_t len) { streamed.append(src, len); }));
+    ASSERT_EQ(streamed, "abc");
+    ASSERT_EQ(receiver.Socket().DataAvailable(), 0u);
+}
+
+TEST_F(UnitTestChecksum, SerializerLargeString)
+{
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSerializer sender(TcpSocket(TestGlobals::localhost, TestGlobals::testPortA));
+    TcpSerializer receiver(listener.Accept());
+    sender.EnableChecksums(true);
+    receiver.EnableChecksums(true);
+
+    // Large enough that the payload is written in place rather than copied.
+    std::string large(3 * TcpSerializer::c_streamChunkSize + 123, '\0');
+    for (size_t i = 0; i < large.length(); ++i)
+        large[i] = static_cast<char>(i * 7);
+    std::thread writer([&sender, &large]() {
+        sender.Write(large);
+        sender.Write(std::string("after"));
+    });
+
+    std::string s;
+    bool const read = receiver.Read(&s);
+    writer.join();
+    ASSERT_TRUE(read);
+    ASSERT_EQ(s, large);
+    ASSERT_TRUE(receiver.Read(&s));
+    ASSERT_EQ(s, "after");
+}
+
+TEST_F(UnitTestChecksum, SerializerMismatch)
+{
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSerializer sender(TcpSocket(TestGlobals::localhost, TestGlobals::testPortA));
+    TcpSerializer receiver(listener.Accept());
+    receiver.EnableChecksums(true);
+
+    // A value with a bad trailer.
+    sender.Write(int32_t{ 5 });
+    sender.Write(int32_t{ 1234 });
+    int32_t i = 0;
+    ErrorCode ec;
+    ASSERT_FALSE(receiver.Read(&i, &ec));
+    ASSERT_TRUE(ec);
+    ASSERT_TRUE(ec.IsIntegrityError());
+    ASSERT_EQ(i, 0);
+
+    // The connection is still usable.
+    sender.EnableChecksums(true);
+    sender.Write(std::string("abc"));
+    std::string s;
+    ASSERT_TRUE(receiver.Read(&s));
+    ASSERT_EQ(s, "abc");
+
+    sender.EnableChecksums(false);
+    sender.Write(std::string("abc"));
+    sender.Write(int32_t{ 0 });
+    ASSERT_THROW(receiver.Read(&s), IntegrityError);
+}
+
+TEST_F(UnitTestChecksum, Udp)
+{
+    IpAddressV4 const ip(TestGlobals::localhost);
+    UdpSocket sender(TestGlobals::testPortB);
+    UdpSocket receiver(TestGlobals::testPortA);
+    sender.EnableChecksums(true);
+    receiver.EnableChecksums(true);
+
+    std::string const message = "Hello, World!";
+    sender.Write(message.data(), message.length(), ip, TestGlobals::testPortA);
+
+    std::vector<char> buffer(message.length() + c_checksumLen);
+    ASSERT_EQ(receiver.Read(buffer.data(), buffer.size(), nullptr, nullptr), message.length());
+    ASSERT_EQ(std::string(buffer.data(), message.length()), message);
+
+    // Without the trailer.
+    sender.EnableChecksums(false);
+    sender.Write(message.data(), message.length(), ip, TestGlobals::testPortA);
+    ErrorCode ec;
+    receiver.Read(buffer.data(), buffer.size(), nullptr, nullptr, &ec);
+    ASSERT_TRUE(ec.IsIntegrityError());
+    sender.Write("ab", 2, ip, TestGlobals::testPortA);
+    ASSERT_THROW(receiver.Read(buffer.data(), buffer.size(), nullptr, nullptr), IntegrityError);
+    ASSERT_TRUE(receiver.IsOpen());
+}
+
+}}}  // namespace strapper::net::test
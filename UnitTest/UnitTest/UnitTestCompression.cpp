@@ -0,0 +1,240 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <gtest/gtest.h>
+
+#include <strapper/net/Lz4.h>
+#include <strapper/net/SocketError.h>
+#include <strapper/net/TcpListener.h>
+#include <strapper/net/TcpSerializer.h>
+#include "TestGlobals.h"
+#include "Timeout.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace strapper { namespace net { namespace test {
+
+class UnitTestCompression : public ::testing::Test
+{
+public:
+    static std::string Compress(std::string const& s)
+    {
+        std::string compressed(Lz4CompressBound(s.length()), '\0');
+        compressed.resize(Lz4Compress(s.data(), s.length(), &compressed[0], compressed.length()));
+        return compressed;
+    }
+
+    static std::string Decompress(std::string const& compressed, size_t len)
+    {
+        std::string s(len, '\0');
+        s.resize(Lz4Decompress(compressed.data(), compressed.length(), &s[0], s.length()));
+        return s;
+    }
+
+    static std::string Text(size_t len)
+    {
+        std::string const words[] = { "replica ", "update ", "key=", "value ", "timestamp ", "\n" };
+        std::mt19937 rng(7);
+        std::string s;
+        while (s.length() < len)
+            s += words[rng() % 6];
+        s.resize(len);
+        return s;
+    }
+
+    Timeout m_timeout{ std::chrono::seconds(3) };
+};
+
+TEST_F(UnitTestCompression, RoundTrip)
+{
+    std::mt19937 rng(1);
+    std::vector<std::string> inputs = { "", "a", "abcdefghijkl", "abcdefghijklm", std::string(32, 'a'), std::string(100000, 'z'), Text(70000) };
+    std::string random(5000, '\0');
+    for (char& c : random)
+        c = static_cast<char>(rng());
+    inputs.push_back(random);
+    inputs.push_back(random + random);
+
+    for (std::string const& input : inputs)
+    {
+        std::string const compressed = Compress(input);
+        ASSERT_LE(compressed.length(), Lz4CompressBound(input.length()));
+        ASSERT_EQ(Decompress(compressed, input.length()), input);
+    }
+
+    ASSERT_LT(Compress(std::string(100000, 'z')).length(), 1000u);
+    ASSERT_LT(Compress(Text(70000)).length(), 70000u / 2);
+}
+
+TEST_F(UnitTestCompression, KnownBlock)
+{
+    // 1 literal, then a 26 byte match at offset 1, then 5 final literals.
+    std::string const block("\x1F" "a" "\x01\x00" "\x07" "\x50" "aaaaa", 11);
+    ASSERT_EQ(Decompress(block, 64), std::string(32, 'a'));
+    ASSERT_EQ(Compress(std::string(32, 'a')), block);
+}
+
+TEST_F(UnitTestCompression, Malformed)
+{
+    std::string const block = Compress(Text(1000));
+
+    // Truncated. Cutting at a sequence boundary leaves a valid but shorter block.
+    for (size_t len = 0; len < block.length(); ++len)
+    {
+        try
+        {
+            ASSERT_LT(Decompress(block.substr(0, len), 1000).length(), 1000u);
+        }
+        catch (ProgramError const&)
+        {
+        }
+    }
+    ASSERT_THROW(Decompress(block.substr(0, 0), 1000), ProgramError);
+    // Destination too small.
+    ASSERT_THROW(Decompress(block, 999), ProgramError);
+    // Offset before the start of the output.
+    ASSERT_THROW(Decompress(std::string("\x10" "a" "\x02\x00" "\x00", 5), 64), ProgramError);
+    // Zero offset.
+    ASSERT_THROW(Decompress(std::string("\x10" "a" "\x00\x00" "\x00", 5), 64), ProgramError);
+    // Too small a destination for the compress bound.
+    std::string dest(10, '\0');
+    ASSERT_THROW(Lz4Compress("abcdefghijklmnop", 16, &dest[0], dest.length()), ProgramError);
+}
+
+TEST_F(UnitTestCompression, Serializer)
+{
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSerializer sender(TcpSocket(TestGlobals::localhost, TestGlobals::testPortA));
+    TcpSerializer receiver(listener.Accept());
+    sender.EnableCompression(true);
+    receiver.EnableCompression(true);
+    sender.EnableChecksums(true);
+    receiver.EnableChecksums(true);
+    ASSERT_TRUE(receiver.CompressionEnabled());
+
+    std::string const text = Text(100000);
+    std::string random(1000, '\0');
+    std::mt19937 rng(3);
+    for (char& c : random)
+        c = static_cast<char>(rng());
+
+    sender.Write(text);
+    sender.Write(std::string("small"));
+    sender.Write(random);
+    sender.Write(std::string());
+    sender.Write(int32_t{ 5 });
+
+    std::string s;
+    ASSERT_TRUE(receiver.Read(&s));
+    ASSERT_EQ(s, text);
+    ASSERT_TRUE(receiver.Read(&s));
+    ASSERT_EQ(s, "small");
+    ASSERT_TRUE(receiver.Read(&s));
+    ASSERT_EQ(s, random);
+    ASSERT_TRUE(receiver.Read(&s));
+    ASSERT_EQ(s, "");
+    int32_t i = 0;
+    ASSERT_TRUE(receiver.Read(&i));
+    ASSERT_EQ(i, 5);
+
+    TcpSerializer::CompressionStats const& stats = sender.GetCompressionStats();
+    ASSERT_EQ(stats.framesCompressed, 1u);
+    ASSERT_EQ(stats.framesStored, 3u);  // Small, incompressible, and empty.
+    ASSERT_EQ(stats.bytesIn, text.length() + 5 + random.length());
+    ASSERT_GT(stats.Ratio(), 2.0);
+    ASSERT_EQ(receiver.GetCompressionStats().framesDecompressed, 1u);
+}
+
+TEST_F(UnitTestCompression, SerializerThreshold)
+{
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSerializer sender(TcpSocket(TestGlobals::localhost, TestGlobals::testPortA));
+    TcpSerializer receiver(listener.Accept());
+    // The threshold only matters to the sender.
+    sender.EnableCompression(true, 0);
+    receiver.EnableCompression(true, 1000000);
+
+    sender.Write(std::string(20, 'a'));
+    std::string s;
+    ASSERT_TRUE(receiver.Read(&s));
+    ASSERT_EQ(s, std::string(20, 'a'));
+    ASSERT_EQ(sender.GetCompressionStats().framesCompressed, 1u);
+
+    // The max string length applies to the decompressed size.
+    receiver.SetMaxStringLength(10);
+    sender.Write(std::string(20, 'a'));
+    ASSERT_THROW(receiver.Read(&s), ProgramError);
+}
+
+TEST_F(UnitTestCompression, SerializerStreams)
+{
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSerializer sender(TcpSocket(TestGlobals::localhost, TestGlobals::testPortA));
+    TcpSerializer receiver(listener.Accept());
+    sender.EnableCompression(true);
+    receiver.EnableCompression(true);
+    sender.EnableChecksums(true);
+    receiver.EnableChecksums(true);
+
+    std::string const text = Text(100000);
+    auto writeStream = [&sender](std::string const& value) {
+        size_t offset = 0;
+        sender.WriteStream(value.length(), [&value, &offset](char* dest, size_t maxlen) {
+            size_t const n = std::min(maxlen, value.length() - offset);
+            value.copy(dest, n, offset);
+            offset += n;
+            return n;
+        });
+    };
+    auto readStream = [&receiver](std::string* dest) {
+        dest->clear();
+        return receiver.ReadStream([dest](char const* src, size_t len) { dest->append(src, len); });
+    };
+
+    // A compressed string can be received as a stream, and a stream as a string.
+    sender.Write(text);
+    writeStream(text);
+    sender.Write(std::string("small"));
+    writeStream("small");
+    sender.Write(int32_t{ 5 });
+
+    std::string s;
+    ASSERT_TRUE(readStream(&s));
+    ASSERT_EQ(s, text);
+    ASSERT_TRUE(receiver.Read(&s));
+    ASSERT_EQ(s, text);
+    ASSERT_TRUE(readStream(&s));
+    ASSERT_EQ(s, "small");
+    ASSERT_TRUE(receiver.Read(&s));
+    ASSERT_EQ(s, "small");
+    int32_t i = 0;
+    ASSERT_TRUE(receiver.Read(&i));
+    ASSERT_EQ(i, 5);
+    ASSERT_EQ(sender.GetCompressionStats().framesCompressed, 1u);
+    ASSERT_EQ(receiver.GetCompressionStats().framesDecompressed, 1u);
+
+    // A compressed string is held in memory, so the max string length still applies when it is read as a stream.
+    receiver.SetMaxStringLength(10);
+    sender.Write(text);
+    ASSERT_THROW(readStream(&s), ProgramError);
+}
+
+}}}  // namespace strapper::net::test
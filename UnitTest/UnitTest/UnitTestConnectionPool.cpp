@@ -0,0 +1,182 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <gtest/gtest.h>
+
+#include <strapper/net/ErrorCode.h>
+#include <strapper/net/TcpConnectionPool.h>
+#include <strapper/net/TcpListener.h>
+#include <strapper/net/TcpSocket.h>
+#include "TestGlobals.h"
+#include "Timeout.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace strapper { namespace net { namespace test {
+
+class UnitTestConnectionPool : public ::testing::Test
+{
+public:
+    static constexpr char const* host = TestGlobals::localhost;
+    static uint16_t constexpr port = TestGlobals::testPortA;
+
+    // Sends a byte from the client and checks that the given server side receives it.
+    static void Roundtrip(TcpSocket& client, TcpSocket& server)
+    {
+        char data = 5;
+        client.Write(&data, 1);
+        data = 0;
+        ASSERT_TRUE(server.Read(&data, 1));
+        ASSERT_EQ(data, 5);
+    }
+};
+
+TEST_F(UnitTestConnectionPool, Empty)
+{ }
+
+TEST_F(UnitTestConnectionPool, Reuse)
+{
+    Timeout timeout(std::chrono::seconds(3));
+    TcpListener listener(port);
+    TcpConnectionPool pool;
+
+    TcpSocket client = pool.Acquire(host, port);
+    ASSERT_TRUE(client.IsOpen());
+    TcpSocket server = listener.Accept();
+    Roundtrip(client, server);
+    pool.Release(host, port, std::move(client));
+    ASSERT_EQ(pool.IdleCount(host, port), 1u);
+    ASSERT_EQ(pool.IdleCount(), 1u);
+
+    // The same connection comes back, so the server side needs no new Accept.
+    client = pool.Acquire(host, port);
+    ASSERT_TRUE(client.IsOpen());
+    ASSERT_EQ(pool.IdleCount(), 0u);
+    Roundtrip(client, server);
+
+    ConnectionPoolStats const stats = pool.GetStats();
+    ASSERT_EQ(stats.connected, 1u);
+    ASSERT_EQ(stats.reused, 1u);
+}
+
+TEST_F(UnitTestConnectionPool, Stale)
+{
+    Timeout timeout(std::chrono::seconds(3));
+    TcpListener listener(port);
+    TcpConnectionPool pool;
+
+    // The peer closes an idle connection.
+    TcpSocket client = pool.Acquire(host, port);
+    TcpSocket server = listener.Accept();
+    pool.Release(host, port, std::move(client));
+    server.Close();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    client = pool.Acquire(host, port);
+    server = listener.Accept();
+    Roundtrip(client, server);
+
+    // An idle connection has unread data.
+    pool.Release(host, port, std::move(client));
+    char const data = 1;
+    server.Write(&data, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    client = pool.Acquire(host, port);
+    server = listener.Accept();
+    Roundtrip(client, server);
+
+    ConnectionPoolStats const stats = pool.GetStats();
+    ASSERT_EQ(stats.connected, 3u);
+    ASSERT_EQ(stats.reused, 0u);
+    ASSERT_EQ(stats.stale, 2u);
+}
+
+TEST_F(UnitTestConnectionPool, Limits)
+{
+    Timeout timeout(std::chrono::seconds(3));
+    TcpListener listener(port);
+    TcpConnectionPool::Options options;
+    options.maxIdlePerHost = 2;
+    options.maxIdleTime = std::chrono::milliseconds(50);
+    TcpConnectionPool pool(options);
+
+    std::vector<TcpSocket> clients;
+    std::vector<TcpSocket> servers;
+    for (int i = 0; i < 3; ++i)
+    {
+        clients.push_back(pool.Acquire(host, port));
+        servers.push_back(listener.Accept());
+    }
+    for (auto& client : clients)
+        pool.Release(host, port, std::move(client));
+    ASSERT_EQ(pool.IdleCount(host, port), 2u);
+    ASSERT_EQ(pool.GetStats().overflow, 1u);
+
+    // Closed connections are not kept.
+    pool.Release(host, port, TcpSocket());
+    ASSERT_EQ(pool.IdleCount(host, port), 2u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    pool.EvictExpired();
+    ASSERT_EQ(pool.IdleCount(), 0u);
+    ASSERT_EQ(pool.GetStats().expired, 2u);
+}
+
+TEST_F(UnitTestConnectionPool, Threads)
+{
+    Timeout timeout(std::chrono::seconds(5));
+    TcpListener listener(port);
+    TcpConnectionPool pool;
+
+    int constexpr threadCount = 4;
+    std::vector<TcpSocket> servers;
+    std::thread acceptor([&]() {
+        for (int i = 0; i < threadCount; ++i)
+            servers.push_back(listener.Accept());
+    });
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&pool]() {
+            for (int i = 0; i < 100; ++i)
+            {
+                ErrorCode ec;
+                TcpSocket client = pool.Acquire(host, port, &ec);
+                EXPECT_FALSE(ec);
+                pool.Release(host, port, std::move(client));
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    // At most one connection per thread was ever needed.
+    ConnectionPoolStats const stats = pool.GetStats();
+    ASSERT_LE(stats.connected, static_cast<uint64_t>(threadCount));
+    ASSERT_EQ(stats.connected + stats.reused, 400u);
+
+    // Unblock the acceptor if fewer connections were made than it expects.
+    for (uint64_t i = stats.connected; i < threadCount; ++i)
+        TcpSocket const unblock(host, port);
+    acceptor.join();
+}
+
+}}}  // namespace strapper::net::test
@@ -0,0 +1,150 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <gtest/gtest.h>
+
+#include <strapper/net/ErrorCode.h>
+#include <strapper/net/TcpSerializer.h>
+#include <strapper/net/TcpSocket.h>
+#include "EchoServers.h"
+#include "TestGlobals.h"
+#include "Timeout.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace strapper { namespace net { namespace test {
+
+class UnitTestEchoServerPool : public ::testing::Test
+{
+public:
+    static constexpr char const* host = TestGlobals::localhost;
+    static uint16_t constexpr port = TestGlobals::testPortA;
+
+    // The pool updates its counts on its own threads, so wait for them to settle. The test's Timeout fails the test
+    // if they never do.
+    static void WaitFor(std::function<bool()> const& done)
+    {
+        while (!done())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    static void Echo(TcpSerializer& client, std::string const& message)
+    {
+        client.Write(message);
+        std::string echoed;
+        ASSERT_TRUE(client.Read(&echoed));
+        ASSERT_EQ(echoed, message);
+    }
+};
+
+TEST_F(UnitTestEchoServerPool, ConcurrentClients)
+{
+    Timeout timeout(std::chrono::seconds(5));
+
+    // More clients than threads, so each worker serves several connections at once.
+    TcpEchoServerPool pool(port, 2);
+    size_t const clientCount = 6;
+    size_t const messageCount = 50;
+    std::vector<std::thread> clients;
+    for (size_t c = 0; c < clientCount; ++c)
+    {
+        clients.emplace_back([c]() {
+            TcpSerializer client(TcpSocket(host, port));
+            for (size_t m = 0; m < messageCount; ++m)
+                Echo(client, "client " + std::to_string(c) + " message " + std::to_string(m));
+        });
+    }
+    for (auto& client : clients)
+        client.join();
+
+    WaitFor([&pool]() { return pool.MessagesEchoed() == clientCount * messageCount; });
+    WaitFor([&pool]() { return pool.Connections() == 0u; });
+}
+
+TEST_F(UnitTestEchoServerPool, Counts)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpEchoServerPool pool(port, 2);
+    ASSERT_EQ(pool.Connections(), 0u);
+    ASSERT_EQ(pool.MessagesEchoed(), 0u);
+
+    std::vector<std::unique_ptr<TcpSerializer>> clients;
+    for (int i = 0; i < 3; ++i)
+        clients.emplace_back(new TcpSerializer(TcpSocket(host, port)));
+    WaitFor([&pool]() { return pool.Connections() == 3u; });
+
+    Echo(*clients[0], "one");
+    Echo(*clients[1], "two");
+    WaitFor([&pool]() { return pool.MessagesEchoed() == 2u; });
+
+    clients[0]->Socket().Close();
+    WaitFor([&pool]() { return pool.Connections() == 2u; });
+
+    clients.clear();
+    WaitFor([&pool]() { return pool.Connections() == 0u; });
+    ASSERT_EQ(pool.MessagesEchoed(), 2u);
+}
+
+TEST_F(UnitTestEchoServerPool, StopDuringPartialMessage)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpEchoServerPool pool(port, 1);
+    TcpSocket client(host, port);
+    WaitFor([&pool]() { return pool.Connections() == 1u; });
+
+    // Half a message header. The worker blocks reading the rest, which never comes.
+    char const partial[2] = {};
+    client.Write(partial, sizeof(partial));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    pool.Stop();
+    ASSERT_EQ(pool.Connections(), 0u);
+    ASSERT_EQ(pool.MessagesEchoed(), 0u);
+
+    // The pool closed the connection.
+    char data = 0;
+    ErrorCode ec;
+    ASSERT_FALSE(client.Read(&data, sizeof(data), &ec));
+}
+
+TEST_F(UnitTestEchoServerPool, StopTwice)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpEchoServerPool pool(port, 2);
+    std::thread waiter([&pool]() { pool.Wait(); });
+
+    pool.Stop();
+    pool.Stop();
+    waiter.join();
+
+    // Also returns straight away once stopped.
+    pool.Wait();
+
+    // Nothing is listening any more.
+    ErrorCode ec;
+    TcpSocket client(host, port, &ec);
+    ASSERT_TRUE(ec);
+}
+
+}}}  // namespace strapper::net::test
@@ -0,0 +1,149 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <gtest/gtest.h>
+
+#include <strapper/net/FramedConnection.h>
+#include <strapper/net/SocketError.h>
+#include <strapper/net/TcpListener.h>
+#include "TestGlobals.h"
+#include "Timeout.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace strapper { namespace net { namespace test {
+
+class UnitTestFramedConnection : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        TcpListener listener(TestGlobals::testPortA);
+        ASSERT_TRUE(listener);
+        m_client.reset(new FramedConnection(TcpSocket(TestGlobals::localhost, TestGlobals::testPortA)));
+        ASSERT_TRUE(m_client->Socket().IsOpen());
+        m_server.reset(new FramedConnection(listener.Accept()));
+        ASSERT_TRUE(m_server->Socket().IsOpen());
+    }
+
+    std::unique_ptr<FramedConnection> m_client;
+    std::unique_ptr<FramedConnection> m_server;
+
+    Timeout m_timeout{ std::chrono::seconds(3) };
+};
+
+TEST_F(UnitTestFramedConnection, SendReceive)
+{
+    m_client->Send(7, "Hello, World!");
+    m_client->Send(8, "");
+
+    FramedConnection::Frame frame;
+    ASSERT_TRUE(m_server->Receive(&frame));
+    ASSERT_EQ(frame.sequence, 7u);
+    ASSERT_EQ(frame.payload, "Hello, World!");
+    ASSERT_TRUE(m_server->Receive(&frame));
+    ASSERT_EQ(frame.sequence, 8u);
+    ASSERT_EQ(frame.payload, "");
+}
+
+TEST_F(UnitTestFramedConnection, PipelinedOutOfOrder)
+{
+    int const count = 100;
+    std::vector<uint32_t> sequences;
+    for (int i = 0; i < count; ++i)
+        sequences.push_back(m_client->SendRequest(std::to_string(i)));
+    ASSERT_EQ(m_client->Outstanding(), static_cast<size_t>(count));
+
+    // Reply in reverse order.
+    std::thread server([this]() {
+        std::vector<FramedConnection::Frame> requests(count);
+        for (auto& request : requests)
+            ASSERT_TRUE(m_server->Receive(&request));
+        for (auto iter = requests.rbegin(); iter != requests.rend(); ++iter)
+            m_server->Send(iter->sequence, "re: " + iter->payload);
+    });
+
+    for (int i = 0; i < count; ++i)
+    {
+        std::string response;
+        ASSERT_TRUE(m_client->ReadResponse(sequences[static_cast<size_t>(i)], &response));
+        ASSERT_EQ(response, "re: " + std::to_string(i));
+    }
+    server.join();
+    ASSERT_EQ(m_client->Outstanding(), 0u);
+}
+
+TEST_F(UnitTestFramedConnection, ReadNextResponse)
+{
+    uint32_t const a = m_client->SendRequest("a");
+    uint32_t const b = m_client->SendRequest("b");
+
+    FramedConnection::Frame frame;
+    ASSERT_TRUE(m_server->Receive(&frame));
+    ASSERT_TRUE(m_server->Receive(&frame));
+    m_server->Send(b, "b");
+    m_server->Send(a, "a");
+
+    std::string response;
+    ASSERT_TRUE(m_client->ReadResponse(a, &response));  // Holds on to b.
+    ASSERT_EQ(response, "a");
+    ASSERT_TRUE(m_client->ReadNextResponse(&frame));
+    ASSERT_EQ(frame.sequence, b);
+    ASSERT_EQ(frame.payload, "b");
+
+    ErrorCode ec;
+    ASSERT_FALSE(m_client->ReadNextResponse(&frame, &ec));
+    ASSERT_TRUE(ec);
+}
+
+TEST_F(UnitTestFramedConnection, UnknownResponse)
+{
+    std::string response;
+    ASSERT_THROW(m_client->ReadResponse(12345, &response), ProgramError);
+
+    uint32_t const sequence = m_client->SendRequest("request");
+    m_server->Send(sequence + 1, "response");
+    ErrorCode ec;
+    ASSERT_FALSE(m_client->ReadResponse(sequence, &response, &ec));
+    ASSERT_TRUE(ec);
+}
+
+TEST_F(UnitTestFramedConnection, FrameTooLarge)
+{
+    FramedConnection small(std::move(m_server->Socket()), 4);
+    ErrorCode ec;
+    small.Send(0, "12345", &ec);
+    ASSERT_TRUE(ec);
+
+    m_client->Send(0, "12345");
+    FramedConnection::Frame frame;
+    ASSERT_FALSE(small.Receive(&frame, &ec));
+    ASSERT_TRUE(ec);
+    ASSERT_FALSE(small.Socket().IsOpen());
+}
+
+TEST_F(UnitTestFramedConnection, GracefulClose)
+{
+    m_client->Socket().Close();
+    FramedConnection::Frame frame;
+    ASSERT_FALSE(m_server->Receive(&frame));
+}
+
+}}}  // namespace strapper::net::test
@@ -147,4 +147,93 @@ TEST_F(UnitTestIpAddress, Comparison)
     ASSERT_TRUE(a != c);
 }
 
+TEST_F(UnitTestIpAddress, V6Parse)
+{
+    using Array = std::array<uint8_t, 16>;
+    ASSERT_TRUE((IpAddressV6("::").ToArray() == Array{}));
+    ASSERT_TRUE((IpAddressV6("::1").ToArray() == Array{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 }));
+    ASSERT_TRUE((IpAddressV6("2001:DB8::ff00:42:8329").ToArray()
+                 == Array{ 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0xff, 0x00, 0x00, 0x42, 0x83, 0x29 }));
+    ASSERT_TRUE((IpAddressV6("1:2:3:4:5:6:7:8").ToArray() == Array{ 0, 1, 0, 2, 0, 3, 0, 4, 0, 5, 0, 6, 0, 7, 0, 8 }));
+    ASSERT_TRUE((IpAddressV6("1::").ToArray() == Array{ 0, 1 }));
+    ASSERT_TRUE((IpAddressV6("::ffff:192.0.2.1").ToArray() == Array{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 192, 0, 2, 1 }));
+    ASSERT_EQ(IpAddressV6("0:0:0:0:0:0:0:1"), IpAddressV6::Loopback);
+    ASSERT_EQ(IpAddressV6("0000::0000"), IpAddressV6::Any);
+}
+
+TEST_F(UnitTestIpAddress, V6ParseFail)
+{
+    ASSERT_THROW(IpAddressV6(""), ProgramError);
+    ASSERT_THROW(IpAddressV6(":"), ProgramError);
+    ASSERT_THROW(IpAddressV6(":::"), ProgramError);
+    ASSERT_THROW(IpAddressV6("1::2::3"), ProgramError);
+    ASSERT_THROW(IpAddressV6(":1:2:3:4:5:6:7"), ProgramError);
+    ASSERT_THROW(IpAddressV6("1:2:3:4:5:6:7:"), ProgramError);
+    ASSERT_THROW(IpAddressV6("1:2:3:4:5:6:7"), ProgramError);
+    ASSERT_THROW(IpAddressV6("1:2:3:4:5:6:7:8:9"), ProgramError);
+    ASSERT_THROW(IpAddressV6("1:2:3:4:5:6:7:8:"), ProgramError);
+    ASSERT_THROW(IpAddressV6("1:2:3:4:5:6:7:8::"), ProgramError);
+    ASSERT_THROW(IpAddressV6("1:2:3:4::5:6:7:8"), ProgramError);
+    ASSERT_THROW(IpAddressV6("12345::"), ProgramError);
+    ASSERT_THROW(IpAddressV6("g::"), ProgramError);
+    ASSERT_THROW(IpAddressV6("::1.2.3"), ProgramError);
+    ASSERT_THROW(IpAddressV6("::1.2.3.256"), ProgramError);
+    ASSERT_THROW(IpAddressV6("1.2.3.4::"), ProgramError);
+    ASSERT_THROW(IpAddressV6("1:2:3:4:5:6:7:1.2.3.4"), ProgramError);
+    ASSERT_THROW(IpAddressV6("fe80::1%eth0"), ProgramError);
+}
+
+TEST_F(UnitTestIpAddress, V6ToString)
+{
+    // RFC 5952 canonical form.
+    ASSERT_EQ(IpAddressV6::Any.ToString(), "::");
+    ASSERT_EQ(IpAddressV6::Loopback.ToString(), "::1");
+    ASSERT_EQ(IpAddressV6("2001:0DB8:0000:0000:0000:ff00:0042:8329").ToString(), "2001:db8::ff00:42:8329");
+    ASSERT_EQ(IpAddressV6("2001:db8:0:1:1:1:1:1").ToString(), "2001:db8:0:1:1:1:1:1");  // A single zero group is not compressed.
+    ASSERT_EQ(IpAddressV6("2001:0:0:1:0:0:0:1").ToString(), "2001:0:0:1::1");           // The longest run is compressed.
+    ASSERT_EQ(IpAddressV6("2001:db8:0:0:1:0:0:1").ToString(), "2001:db8::1:0:0:1");     // The first run wins a tie.
+    ASSERT_EQ(IpAddressV6("1:0:0:0:0:0:0:0").ToString(), "1::");
+    ASSERT_EQ(IpAddressV6("::ffff:c000:0201").ToString(), "::ffff:192.0.2.1");
+
+    for (char const* text : { "fe80::1:2", "1:2:3:4:5:6:7:8", "::2:3:4:5:6:7:8", "1:2:3:4:5:6:7::" })
+        ASSERT_EQ(IpAddressV6(IpAddressV6(text).ToString()), IpAddressV6(text)) << text;
+}
+
+TEST_F(UnitTestIpAddress, V4Mapped)
+{
+    IpAddressV6 const mapped = IpAddressV6::MapV4(IpAddressV4("192.0.2.1"));
+    ASSERT_TRUE(mapped.IsV4Mapped());
+    ASSERT_EQ(mapped, IpAddressV6("::ffff:192.0.2.1"));
+    ASSERT_EQ(mapped.ToV4(), IpAddressV4("192.0.2.1"));
+    ASSERT_FALSE(IpAddressV6::Loopback.IsV4Mapped());
+    ASSERT_THROW(IpAddressV6::Loopback.ToV4(), ProgramError);
+}
+
+TEST_F(UnitTestIpAddress, Variant)
+{
+    IpAddress const v4("127.0.0.1");
+    ASSERT_TRUE(v4.IsV4());
+    ASSERT_EQ(v4.GetFamily(), IpAddress::Family::V4);
+    ASSERT_EQ(v4.V4(), IpAddressV4::Loopback);
+    ASSERT_THROW(v4.V6(), ProgramError);
+    ASSERT_EQ(v4.ToString(), "127.0.0.1");
+
+    IpAddress const v6("::1");
+    ASSERT_TRUE(v6.IsV6());
+    ASSERT_EQ(v6.GetFamily(), IpAddress::Family::V6);
+    ASSERT_EQ(v6.V6(), IpAddressV6::Loopback);
+    ASSERT_THROW(v6.V4(), ProgramError);
+    ASSERT_EQ(v6.ToString(), "::1");
+
+    // The IPv4 form with ':' delimiters is still read as IPv4.
+    ASSERT_TRUE(IpAddress("1:2:3:4").IsV4());
+    ASSERT_THROW(IpAddress("localhost"), ProgramError);
+
+    ASSERT_EQ(IpAddress(IpAddressV4::Loopback), v4);
+    ASSERT_EQ(IpAddress(IpAddressV6::Loopback), v6);
+    ASSERT_NE(v4, v6);
+    ASSERT_NE(IpAddress(IpAddressV4::Any), IpAddress(IpAddressV6::Any));
+    ASSERT_NE(IpAddress(IpAddressV4::Loopback), IpAddress(IpAddressV6::MapV4(IpAddressV4::Loopback)));
+}
+
 }}}  // namespace strapper::net::test
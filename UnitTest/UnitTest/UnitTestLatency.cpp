@@ -0,0 +1,183 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <gtest/gtest.h>
+
+#include <strapper/net/LatencyHistogram.h>
+#include <strapper/net/SocketError.h>
+#include <strapper/net/TcpListener.h>
+#include <strapper/net/UdpSocket.h>
+#include "TestGlobals.h"
+#include "Timeout.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace strapper { namespace net { namespace test {
+
+class UnitTestLatency : public ::testing::Test
+{ };
+
+TEST_F(UnitTestLatency, Buckets)
+{
+    using H = LatencyHistogram;
+    for (uint64_t v = 0; v < 2 * H::c_subBuckets; ++v)
+    {
+        ASSERT_EQ(H::BucketLowerBound(H::BucketIndex(v)), v);
+        ASSERT_EQ(H::BucketUpperBound(H::BucketIndex(v)), v);
+    }
+    ASSERT_EQ(H::BucketIndex(UINT64_MAX), H::c_bucketCount - 1);
+    ASSERT_EQ(H::BucketUpperBound(H::c_bucketCount - 1), UINT64_MAX);
+
+    // Buckets are contiguous, and every value is within 1/c_subBuckets of its bucket's bounds.
+    for (size_t i = 1; i < H::c_bucketCount; ++i)
+        ASSERT_EQ(H::BucketLowerBound(i), H::BucketUpperBound(i - 1) + 1);
+    for (uint64_t v = 1; v < (uint64_t(1) << 62); v = v * 3 + 1)
+    {
+        size_t const i = H::BucketIndex(v);
+        ASSERT_LE(H::BucketLowerBound(i), v);
+        ASSERT_GE(H::BucketUpperBound(i), v);
+        ASSERT_LE(H::BucketUpperBound(i) - H::BucketLowerBound(i), v / H::c_subBuckets);
+    }
+}
+
+TEST_F(UnitTestLatency, Percentiles)
+{
+    LatencyHistogram h;
+    ASSERT_EQ(h.Count(), 0u);
+    ASSERT_EQ(h.Percentile(50), 0u);
+    ASSERT_EQ(h.Min(), 0u);
+
+    for (uint64_t v = 1; v <= 1000; ++v)
+        h.Record(v * 1000);
+    ASSERT_EQ(h.Count(), 1000u);
+    ASSERT_EQ(h.Min(), 1000u);
+    ASSERT_EQ(h.Max(), 1000000u);
+    ASSERT_DOUBLE_EQ(h.Mean(), 500500.0);
+
+    // Reported values may be up to one bucket (about 3%) high, never low.
+    auto const near = [](uint64_t reported, uint64_t expected) { return reported >= expected && reported <= expected + expected / 32; };
+    ASSERT_TRUE(near(h.Percentile(50), 500000));
+    ASSERT_TRUE(near(h.Percentile(99), 990000));
+    ASSERT_TRUE(near(h.Percentile(99.9), 999000));
+    ASSERT_EQ(h.Percentile(100), 1000000u);
+    ASSERT_TRUE(near(h.Percentile(0), 1000));
+
+    h.Record(std::chrono::microseconds(5));
+    ASSERT_EQ(h.Min(), 1000u);
+    h.Reset();
+    ASSERT_EQ(h.Count(), 0u);
+    ASSERT_EQ(h.Max(), 0u);
+}
+
+TEST_F(UnitTestLatency, Merge)
+{
+    LatencyHistogram a;
+    LatencyHistogram b;
+    a.Record(10);
+    a.Record(20);
+    b.Record(5);
+    b.Record(1000000);
+    a.Merge(b);
+    a.Merge(a);
+    ASSERT_EQ(a.Count(), 4u);
+    ASSERT_EQ(a.Min(), 5u);
+    ASSERT_EQ(a.Max(), 1000000u);
+    ASSERT_EQ(a.Percentile(50), 10u);
+    ASSERT_EQ(b.Count(), 2u);
+
+    LatencyHistogram empty;
+    a.Merge(empty);
+    ASSERT_EQ(a.Min(), 5u);
+}
+
+TEST_F(UnitTestLatency, ConcurrentRecord)
+{
+    LatencyHistogram h;
+    std::vector<std::thread> threads;
+    for (uint64_t t = 1; t <= 4; ++t)
+    {
+        threads.emplace_back([&h, t]() {
+            for (uint64_t i = 0; i < 10000; ++i)
+                h.Record(t * 100);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    ASSERT_EQ(h.Count(), 40000u);
+    ASSERT_EQ(h.Min(), 100u);
+    ASSERT_EQ(h.Max(), 400u);
+    ASSERT_DOUBLE_EQ(h.Mean(), 250.0);
+}
+
+TEST_F(UnitTestLatency, Sockets)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    SocketLatency latency;
+    latency.read = std::make_shared<LatencyHistogram>();
+    latency.write = std::make_shared<LatencyHistogram>();
+    latency.lockWait = std::make_shared<LatencyHistogram>();
+
+    TcpListener listener(TestGlobals::testPortA);
+    listener.SetLatencyHistograms(latency);
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket host = listener.Accept();
+    ASSERT_EQ(latency.read->Count(), 1u);
+    ASSERT_EQ(latency.lockWait->Count(), 1u);
+
+    // Both ends share the histograms, so their samples merge as they are recorded.
+    client.SetLatencyHistograms(latency);
+    host.SetLatencyHistograms(latency);
+    char c = 'x';
+    client.Write(&c, 1);
+    ASSERT_TRUE(host.Read(&c, 1));
+    ASSERT_EQ(latency.read->Count(), 2u);
+    ASSERT_EQ(latency.write->Count(), 1u);
+    ASSERT_EQ(latency.lockWait->Count(), 3u);
+    ASSERT_EQ(host.GetLatencyHistograms().read, latency.read);
+
+    // Cannot be changed mid-read.
+    std::thread reader([&host, &c]() { ASSERT_TRUE(host.Read(&c, 1)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ErrorCode ec;
+    host.SetLatencyHistograms({}, &ec);
+    ASSERT_TRUE(ec);
+    client.Write(&c, 1);
+    reader.join();
+
+    client.SetLatencyHistograms({});
+    client.Write(&c, 1);
+    ASSERT_EQ(latency.write->Count(), 2u);
+    ASSERT_TRUE(host.Read(&c, 1));
+
+    IpAddressV4 const ip(TestGlobals::localhost);
+    UdpSocket sender(TestGlobals::testPortB);
+    UdpSocket receiver(TestGlobals::testPortA);
+    SocketLatency udpLatency;
+    udpLatency.read = std::make_shared<LatencyHistogram>();
+    udpLatency.write = udpLatency.read;
+    sender.SetLatencyHistograms(udpLatency);
+    receiver.SetLatencyHistograms(udpLatency);
+    sender.Write(&c, 1, ip, TestGlobals::testPortA);
+    ASSERT_EQ(receiver.Read(&c, 1, nullptr, nullptr), 1u);
+    ASSERT_EQ(udpLatency.read->Count(), 2u);
+}
+
+}}}  // namespace strapper::net::test
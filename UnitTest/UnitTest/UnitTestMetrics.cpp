@@ -0,0 +1,134 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <gtest/gtest.h>
+
+#include <strapper/net/MetricsRegistry.h>
+#include <strapper/net/MetricsServer.h>
+#include <strapper/net/SocketError.h>
+#include <strapper/net/TcpListener.h>
+#include <strapper/net/UdpSocket.h>
+#include "TestGlobals.h"
+#include "Timeout.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace strapper { namespace net { namespace test {
+
+class UnitTestMetrics : public ::testing::Test
+{
+public:
+    using Counter = MetricsRegistry::Counter;
+
+    void SetUp() override { MetricsRegistry::Enable(true); }
+    void TearDown() override { MetricsRegistry::Enable(false); }
+
+    static uint64_t Get(Counter counter) { return MetricsRegistry::Global().Get(counter); }
+
+    static std::string Fetch(std::string const& request)
+    {
+        TcpSocket client(TestGlobals::localhost, TestGlobals::testPortB);
+        client.Write(request.data(), request.length());
+        std::string response;
+        char c = 0;
+        while (client.Read(&c, 1))
+            response += c;
+        return response;
+    }
+};
+
+TEST_F(UnitTestMetrics, Counters)
+{
+    Timeout timeout(std::chrono::seconds(3));
+    auto& registry = MetricsRegistry::Global();
+
+    uint64_t const open = registry.OpenConnections();
+    uint64_t const connects = Get(Counter::TCP_CONNECTS);
+    uint64_t const accepts = Get(Counter::TCP_ACCEPTS);
+    uint64_t const bytesRead = Get(Counter::TCP_BYTES_READ);
+    uint64_t const bytesWritten = Get(Counter::TCP_BYTES_WRITTEN);
+    {
+        TcpListener listener(TestGlobals::testPortA);
+        TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA);
+        TcpSocket host = listener.Accept();
+        ASSERT_EQ(registry.OpenConnections(), open + 2);
+        ASSERT_EQ(Get(Counter::TCP_CONNECTS), connects + 1);
+        ASSERT_EQ(Get(Counter::TCP_ACCEPTS), accepts + 1);
+
+        char data[10] = {};
+        client.Write(data, 10);
+        ASSERT_TRUE(host.Read(data, 10));
+        ASSERT_EQ(Get(Counter::TCP_BYTES_WRITTEN), bytesWritten + 10);
+        ASSERT_EQ(Get(Counter::TCP_BYTES_READ), bytesRead + 10);
+    }
+    ASSERT_EQ(registry.OpenConnections(), open);
+
+    // Counted on many threads, summed across shards.
+    uint64_t const datagrams = Get(Counter::UDP_DATAGRAMS_WRITTEN);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 20; ++i)
+        threads.emplace_back([]() { MetricsRegistry::Count(Counter::UDP_DATAGRAMS_WRITTEN, 3); });
+    for (auto& thread : threads)
+        thread.join();
+    ASSERT_EQ(Get(Counter::UDP_DATAGRAMS_WRITTEN), datagrams + 60);
+
+    MetricsRegistry::Enable(false);
+    MetricsRegistry::Count(Counter::UDP_DATAGRAMS_WRITTEN, 3);
+    ASSERT_EQ(Get(Counter::UDP_DATAGRAMS_WRITTEN), datagrams + 60);
+}
+
+TEST_F(UnitTestMetrics, Errors)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    ErrorCode ec;
+    TcpListener listener(TestGlobals::testPortA);
+    auto const before = MetricsRegistry::Global().GetErrors();
+    TcpListener conflict(TestGlobals::testPortA, &ec);
+    ASSERT_TRUE(ec);
+    ASSERT_NE(ec.NativeCode(), 0);
+    auto const after = MetricsRegistry::Global().GetErrors();
+    uint64_t const previous = before.count(ec.NativeCode()) ? before.at(ec.NativeCode()) : 0;
+    ASSERT_EQ(after.at(ec.NativeCode()), previous + 1);
+}
+
+TEST_F(UnitTestMetrics, Server)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    MetricsServer server(TestGlobals::testPortB);
+    ASSERT_TRUE(server.IsListening());
+
+    std::string response = Fetch("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    ASSERT_EQ(response.find("HTTP/1.1 200 OK\r\n"), 0u);
+    ASSERT_NE(response.find("# TYPE strapper_net_tcp_connections_open gauge\n"), std::string::npos);
+    ASSERT_NE(response.find("\nstrapper_net_tcp_accepts_total "), std::string::npos);
+    std::string const body = response.substr(response.find("\r\n\r\n") + 4);
+    ASSERT_NE(response.find("Content-Length: " + std::to_string(body.length()) + "\r\n"), std::string::npos);
+
+    response = Fetch("GET /other HTTP/1.1\r\n\r\n");
+    ASSERT_EQ(response.find("HTTP/1.1 404 Not Found\r\n"), 0u);
+    response = Fetch("POST /metrics HTTP/1.1\r\n\r\n");
+    ASSERT_EQ(response.find("HTTP/1.1 405 Method Not Allowed\r\n"), 0u);
+
+    server.Close();
+    ASSERT_FALSE(server.IsListening());
+}
+
+}}}  // namespace strapper::net::test
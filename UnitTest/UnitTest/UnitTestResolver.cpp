@@ -0,0 +1,223 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <gtest/gtest.h>
+
+#include <strapper/net/ErrorCode.h>
+#include <strapper/net/Resolver.h>
+#include <strapper/net/SocketError.h>
+#include <strapper/net/TcpListener.h>
+#include <strapper/net/TcpSocket.h>
+#include "TestGlobals.h"
+#include "Timeout.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace strapper { namespace net { namespace test {
+
+class UnitTestResolver : public ::testing::Test
+{
+public:
+    using Addresses = Resolver::Addresses;
+
+    // A stub resolver that knows two hosts and counts its lookups.
+    Resolver::LookupFunction Stub(std::chrono::milliseconds delay = std::chrono::milliseconds(0))
+    {
+        return [this, delay](std::string const& host) -> Addresses {
+            ++lookups;
+            std::this_thread::sleep_for(delay);
+            if (host == "a.test")
+                return { IpAddressV4("10.0.0.1"), IpAddressV6("2001:db8::1") };
+            if (host == "b.test")
+                return { IpAddressV4("10.0.0.2") };
+            if (host == "c.test")
+                return { IpAddressV4("10.0.0.3") };
+            throw SocketError(1);
+        };
+    }
+
+    static Resolver::Options Options()
+    {
+        Resolver::Options options;
+        options.positiveTtl = std::chrono::milliseconds(10000);
+        options.negativeTtl = std::chrono::milliseconds(10000);
+        return options;
+    }
+
+    std::atomic<int> lookups{ 0 };
+};
+
+TEST_F(UnitTestResolver, Empty)
+{ }
+
+TEST_F(UnitTestResolver, Cache)
+{
+    Resolver resolver(Options(), Stub());
+    Addresses const expected = { IpAddressV4("10.0.0.1"), IpAddressV6("2001:db8::1") };
+
+    ASSERT_EQ(resolver.Resolve("a.test"), expected);
+    ASSERT_EQ(resolver.Resolve("a.test"), expected);
+    ASSERT_EQ(resolver.Resolve("b.test"), Addresses{ IpAddressV4("10.0.0.2") });
+    ASSERT_EQ(lookups, 2);
+    ASSERT_EQ(resolver.Size(), 2u);
+
+    ResolverStats const stats = resolver.GetStats();
+    ASSERT_EQ(stats.hits, 1u);
+    ASSERT_EQ(stats.misses, 2u);
+
+    resolver.Clear();
+    ASSERT_EQ(resolver.Size(), 0u);
+    resolver.Resolve("a.test");
+    ASSERT_EQ(lookups, 3);
+}
+
+TEST_F(UnitTestResolver, Ttl)
+{
+    auto options = Options();
+    options.positiveTtl = std::chrono::milliseconds(50);
+    Resolver resolver(options, Stub());
+
+    resolver.Resolve("a.test");
+    resolver.Resolve("a.test");
+    ASSERT_EQ(lookups, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    resolver.Resolve("a.test");
+    ASSERT_EQ(lookups, 2);
+}
+
+TEST_F(UnitTestResolver, NegativeCache)
+{
+    auto options = Options();
+    options.negativeTtl = std::chrono::milliseconds(50);
+    Resolver resolver(options, Stub());
+
+    ASSERT_THROW(resolver.Resolve("missing.test"), SocketError);
+    ASSERT_THROW(resolver.Resolve("missing.test"), SocketError);
+    ASSERT_EQ(lookups, 1);
+    ASSERT_EQ(resolver.GetStats().negativeHits, 1u);
+
+    ErrorCode ec;
+    ASSERT_TRUE(resolver.Resolve("missing.test", &ec).empty());
+    ASSERT_TRUE(ec);
+    ASSERT_EQ(ec.NativeCode(), 1);
+    ASSERT_EQ(lookups, 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_THROW(resolver.Resolve("missing.test"), SocketError);
+    ASSERT_EQ(lookups, 2);
+}
+
+TEST_F(UnitTestResolver, Bounded)
+{
+    auto options = Options();
+    options.maxEntries = 2;
+    Resolver resolver(options, Stub());
+
+    resolver.Resolve("a.test");
+    resolver.Resolve("b.test");
+    resolver.Resolve("a.test");  // b.test is now least recently used.
+    resolver.Resolve("c.test");
+    ASSERT_EQ(resolver.Size(), 2u);
+    ASSERT_EQ(resolver.GetStats().evictions, 1u);
+    ASSERT_EQ(lookups, 3);
+
+    resolver.Resolve("a.test");
+    ASSERT_EQ(lookups, 3);
+    resolver.Resolve("b.test");
+    ASSERT_EQ(lookups, 4);
+}
+
+TEST_F(UnitTestResolver, Numeric)
+{
+    Resolver resolver(Options(), Stub());
+    ASSERT_EQ(resolver.Resolve("127.0.0.1"), Addresses{ IpAddressV4::Loopback });
+    ASSERT_EQ(resolver.Resolve("::1"), Addresses{ IpAddressV6::Loopback });
+    ASSERT_EQ(lookups, 0);
+    ASSERT_EQ(resolver.Size(), 0u);
+}
+
+TEST_F(UnitTestResolver, Coalesce)
+{
+    Timeout timeout(std::chrono::seconds(3));
+    Resolver resolver(Options(), Stub(std::chrono::milliseconds(100)));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+        threads.emplace_back([&resolver]() { resolver.Resolve("a.test"); });
+    for (auto& thread : threads)
+        thread.join();
+
+    ASSERT_EQ(lookups, 1);
+}
+
+TEST_F(UnitTestResolver, Async)
+{
+    Timeout timeout(std::chrono::seconds(3));
+    Resolver resolver(Options(), Stub(std::chrono::milliseconds(10)));
+
+    std::future<Addresses> future = resolver.ResolveAsync("b.test");
+    ASSERT_EQ(future.get(), Addresses{ IpAddressV4("10.0.0.2") });
+
+    future = resolver.ResolveAsync("missing.test");
+    ASSERT_THROW(future.get(), SocketError);
+
+    std::promise<ErrorCode> done;
+    resolver.ResolveAsync("c.test", [&done](Addresses const& addresses, ErrorCode const& ec) {
+        EXPECT_EQ(addresses, Addresses{ IpAddressV4("10.0.0.3") });
+        done.set_value(ec);
+    });
+    ASSERT_FALSE(done.get_future().get());
+
+    // Cached answers complete without a lookup.
+    ASSERT_EQ(resolver.ResolveAsync("b.test").get(), Addresses{ IpAddressV4("10.0.0.2") });
+    ASSERT_EQ(lookups, 3);
+}
+
+TEST_F(UnitTestResolver, InterleaveFamilies)
+{
+    IpAddress const a4("10.0.0.1");
+    IpAddress const b4("10.0.0.2");
+    IpAddress const c4("10.0.0.3");
+    IpAddress const a6("2001:db8::1");
+    IpAddress const b6("2001:db8::2");
+
+    ASSERT_EQ(Resolver::InterleaveFamilies({ a6, b6, a4, b4, c4 }), (Addresses{ a6, a4, b6, b4, c4 }));
+    ASSERT_EQ(Resolver::InterleaveFamilies({ a4, b4, a6 }), (Addresses{ a4, a6, b4 }));
+    ASSERT_EQ(Resolver::InterleaveFamilies({ a4, b4 }), (Addresses{ a4, b4 }));
+    ASSERT_TRUE(Resolver::InterleaveFamilies({}).empty());
+}
+
+TEST_F(UnitTestResolver, System)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    Addresses const addresses = Resolver::SystemLookup("localhost");
+    ASSERT_FALSE(addresses.empty());
+    for (auto const& ip : addresses)
+        ASSERT_TRUE(ip == IpAddress(IpAddressV4::Loopback) || ip == IpAddress(IpAddressV6::Loopback)) << ip.ToString();
+
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSocket client("localhost", TestGlobals::testPortA);
+    ASSERT_TRUE(client.IsOpen());
+    ASSERT_TRUE(listener.Accept().IsOpen());
+}
+
+}}}  // namespace strapper::net::test
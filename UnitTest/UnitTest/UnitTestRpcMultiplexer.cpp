@@ -0,0 +1,146 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <gtest/gtest.h>
+
+#include <strapper/net/FramedConnection.h>
+#include <strapper/net/RpcMultiplexer.h>
+#include <strapper/net/SocketError.h>
+#include <strapper/net/TcpListener.h>
+#include "TestGlobals.h"
+#include "Timeout.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace strapper { namespace net { namespace test {
+
+class UnitTestRpcMultiplexer : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        TcpListener listener(TestGlobals::testPortA);
+        ASSERT_TRUE(listener);
+        m_client.reset(new RpcMultiplexer(TcpSocket(TestGlobals::localhost, TestGlobals::testPortA)));
+        m_server.reset(new FramedConnection(listener.Accept()));
+        ASSERT_TRUE(m_server->Socket().IsOpen());
+    }
+
+    void TearDown() override
+    {
+        m_client.reset();
+        if (m_serverThread.joinable())
+            m_serverThread.join();
+    }
+
+    //! Replies to each request with its payload reversed. Replies to every pair of requests in reverse order.
+    void StartServer()
+    {
+        m_serverThread = std::thread([this]() {
+            FramedConnection::Frame first;
+            FramedConnection::Frame second;
+            ErrorCode ec;
+            while (m_server->Receive(&first, &ec))
+            {
+                bool const paired = m_server->Receive(&second, &ec);
+                if (paired)
+                    m_server->Send(second.sequence, std::string(second.payload.rbegin(), second.payload.rend()), &ec);
+                m_server->Send(first.sequence, std::string(first.payload.rbegin(), first.payload.rend()), &ec);
+                if (!paired)
+                    break;
+            }
+        });
+    }
+
+    std::unique_ptr<RpcMultiplexer> m_client;
+    std::unique_ptr<FramedConnection> m_server;
+    std::thread m_serverThread;
+
+    Timeout m_timeout{ std::chrono::seconds(3) };
+};
+
+TEST_F(UnitTestRpcMultiplexer, SingleCall)
+{
+    StartServer();
+    auto first = m_client->Call("abc");
+    auto second = m_client->Call("12345");
+    ASSERT_EQ(second.get(), "54321");
+    ASSERT_EQ(first.get(), "cba");
+    ASSERT_EQ(m_client->Pending(), 0u);
+}
+
+TEST_F(UnitTestRpcMultiplexer, ConcurrentCalls)
+{
+    StartServer();
+    int const threadCount = 8;
+    int const callsPerThread = 200;  // Even total, since the server replies in pairs.
+
+    std::atomic<int> mismatches{ 0 };
+    std::vector<std::thread> callers;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        callers.emplace_back([&, t]() {
+            std::vector<std::future<std::string>> responses;
+            for (int i = 0; i < callsPerThread; ++i)
+                responses.push_back(m_client->Call(std::to_string(t) + ":" + std::to_string(i)));
+            for (int i = 0; i < callsPerThread; ++i)
+            {
+                std::string const expected = std::to_string(t) + ":" + std::to_string(i);
+                if (responses[static_cast<size_t>(i)].get() != std::string(expected.rbegin(), expected.rend()))
+                    ++mismatches;
+            }
+        });
+    }
+    for (auto& caller : callers)
+        caller.join();
+
+    ASSERT_EQ(mismatches, 0);
+    ASSERT_EQ(m_client->Pending(), 0u);
+}
+
+TEST_F(UnitTestRpcMultiplexer, PeerCloseFailsPendingCalls)
+{
+    auto response = m_client->Call("abc");
+    FramedConnection::Frame frame;
+    ASSERT_TRUE(m_server->Receive(&frame));
+    m_server->Socket().Close();
+
+    ASSERT_THROW(response.get(), ProgramError);
+    ASSERT_EQ(m_client->Pending(), 0u);
+
+    // The reader thread marks the multiplexer closed before failing the calls.
+    ASSERT_FALSE(m_client->IsOpen());
+    ErrorCode ec;
+    m_client->Call("def", &ec);
+    ASSERT_TRUE(ec);
+}
+
+TEST_F(UnitTestRpcMultiplexer, CloseFailsPendingCalls)
+{
+    auto response = m_client->Call("abc");
+    m_client->Close();
+    ASSERT_THROW(response.get(), ProgramError);
+    ASSERT_FALSE(m_client->IsOpen());
+    ASSERT_THROW(m_client->Call("def"), ProgramError);
+}
+
+}}}  // namespace strapper::net::test
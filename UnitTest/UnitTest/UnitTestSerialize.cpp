@@ -27,7 +27,9 @@
 #include <chrono>
 #include <cstring>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <thread>
 
 namespace strapper { namespace net { namespace test {
 
@@ -124,4 +126,97 @@ TEST_F(UnitTestSerialize, SendRecvCharString)
     ASSERT_EQ(in, out);
 }
 
+TEST_F(UnitTestSerialize, MaxStringLength)
+{
+    ASSERT_EQ(s_sender->MaxStringLength(), TcpSerializer::c_maxStringLen);
+    ASSERT_THROW(s_sender->SetMaxStringLength(-1), ProgramError);
+
+    std::string const out = "Hello, World!";
+    s_sender->SetMaxStringLength(4);
+    ErrorCode ec;
+    s_sender->Write(out, &ec);
+    ASSERT_TRUE(ec);
+    s_sender->SetMaxStringLength(TcpSerializer::c_maxStringLen);
+
+    // The receiver rejects the string after reading the length prefix.
+    s_sender->Write(out);
+    s_receiver->SetMaxStringLength(4);
+    std::string in;
+    ASSERT_FALSE(s_receiver->Read(&in, &ec));
+    ASSERT_TRUE(ec);
+    s_receiver->SetMaxStringLength(TcpSerializer::c_maxStringLen);
+    std::string payload(out.length(), '\0');
+    ASSERT_TRUE(s_receiver->Socket().Read(&payload[0], payload.length()));
+    ASSERT_EQ(payload, out);
+}
+
+TEST_F(UnitTestSerialize, SendRecvStream)
+{
+    // Larger than the max string length and the stream chunk size.
+    size_t const len = 3 * TcpSerializer::c_maxStringLen + 7;
+    auto const byteAt = [](size_t i) { return static_cast<char>((i * 31) % 251); };
+
+    std::thread writer([&]() {
+        size_t sent = 0;
+        s_sender->WriteStream(len, [&](char* dest, size_t maxlen) {
+            // Supply less than requested to check that the serializer keeps pulling.
+            size_t const amount = std::min<size_t>(maxlen, 1000);
+            for (size_t i = 0; i < amount; ++i)
+                dest[i] = byteAt(sent + i);
+            sent += amount;
+            return amount;
+        });
+    });
+
+    size_t received = 0;
+    bool matches = true;
+    size_t maxChunk = 0;
+    bool const success = s_receiver->ReadStream([&](char const* src, size_t chunkLen) {
+        maxChunk = std::max(maxChunk, chunkLen);
+        for (size_t i = 0; i < chunkLen; ++i)
+            matches = matches && src[i] == byteAt(received + i);
+        received += chunkLen;
+    });
+    writer.join();
+
+    ASSERT_TRUE(success);
+    ASSERT_EQ(received, len);
+    ASSERT_TRUE(matches);
+    ASSERT_LE(maxChunk, TcpSerializer::c_streamChunkSize);
+}
+
+TEST_F(UnitTestSerialize, SendRecvStdStream)
+{
+    std::string const out = "Hello, World!";
+    std::istringstream in(out + " This part is not sent.");
+    s_sender->WriteStream(in, out.length());
+
+    std::ostringstream received;
+    ASSERT_TRUE(s_receiver->ReadStream(received));
+    ASSERT_EQ(received.str(), out);
+
+    // Streams and strings share a wire format.
+    std::istringstream in2(out);
+    s_sender->WriteStream(in2, out.length());
+    std::string s;
+    ASSERT_TRUE(s_receiver->Read(&s));
+    ASSERT_EQ(s, out);
+}
+
+TEST_F(UnitTestSerialize, StreamSourceEndsEarly)
+{
+    TcpListener listener(TestGlobals::testPortB);
+    TcpSerializer sender(TcpSocket(TestGlobals::localhost, TestGlobals::testPortB));
+    TcpSerializer receiver(listener.Accept());
+
+    std::istringstream in("short");
+    ErrorCode ec;
+    sender.WriteStream(in, 100, &ec);
+    ASSERT_TRUE(ec);
+    ASSERT_FALSE(sender.Socket().IsOpen());
+
+    ASSERT_FALSE(receiver.ReadStream([](char const*, size_t) {}, &ec));
+    ASSERT_TRUE(ec);
+}
+
 }}}  // namespace strapper::net::test
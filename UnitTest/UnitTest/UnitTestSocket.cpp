@@ -16,7 +16,11 @@
 
 #include <gtest/gtest.h>
 
+#include <strapper/net/ErrorCode.h>
 #include <strapper/net/IpAddress.h>
+#include <strapper/net/Resolver.h>
+#include <strapper/net/SocketError.h>
+#include <strapper/net/SocketStats.h>
 #include <strapper/net/TcpListener.h>
 #include <strapper/net/TcpSerializer.h>
 #include <strapper/net/TcpSocket.h>
@@ -26,7 +30,9 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
 #include <cstring>
+#include <future>
 #include <memory>
 #include <string>
 #include <thread>
@@ -52,6 +58,250 @@ TEST_F(UnitTestSocket, SelfConnectTcp)
     ASSERT_TRUE(host.IsOpen());
 }
 
+TEST_F(UnitTestSocket, ListenerLocalPort)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpListener fixed(TestGlobals::testPortA);
+    ASSERT_EQ(fixed.LocalPort(), uint16_t{ TestGlobals::testPortA });
+
+    // Port 0 lets the system choose.
+    TcpListener listener(0);
+    uint16_t const port = listener.LocalPort();
+    ASSERT_NE(port, 0);
+    TcpSocket client(TestGlobals::localhost, port);
+    ASSERT_TRUE(listener.Accept().IsOpen());
+
+    listener.Close();
+    ErrorCode ec;
+    ASSERT_EQ(listener.LocalPort(&ec), 0);
+    ASSERT_TRUE(ec);
+}
+
+TEST_F(UnitTestSocket, DualStackTcp)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    // One listener accepts both IPv6 and IPv4 clients.
+    TcpListener listener(TestGlobals::testPortA);
+    ASSERT_TRUE(listener);
+
+    TcpSocket client6("::1", TestGlobals::testPortA);
+    ASSERT_TRUE(client6.IsOpen());
+    TcpSocket host6 = listener.Accept();
+    ASSERT_TRUE(host6.IsOpen());
+
+    TcpSocket client4(TestGlobals::localhost, TestGlobals::testPortA);
+    ASSERT_TRUE(client4.IsOpen());
+    TcpSocket host4 = listener.Accept();
+    ASSERT_TRUE(host4.IsOpen());
+
+    char const sentData[3] = { 1, 2, 3 };
+    char recvData[3] = { 0, 0, 0 };
+    client6.Write(sentData, 3);
+    ASSERT_TRUE(host6.Read(recvData, 3));
+    ASSERT_TRUE(std::equal(recvData, recvData + 3, sentData));
+    host4.Write(sentData, 2);
+    ASSERT_TRUE(client4.Read(recvData, 2));
+    ASSERT_TRUE(std::equal(recvData, recvData + 2, sentData));
+}
+
+TEST_F(UnitTestSocket, ConnectFallback)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    // The first address is unreachable (TEST-NET-1). It either fails or stalls, and the next address is tried.
+    Resolver resolver(Resolver::Options(), [](std::string const&) -> Resolver::Addresses {
+        return { IpAddressV4("192.0.2.1"), IpAddressV4::Loopback };
+    });
+    ConnectOptions options;
+    options.timeout = std::chrono::milliseconds(2000);
+    options.attemptDelay = std::chrono::milliseconds(50);
+    options.resolver = &resolver;
+
+    TcpListener listener(TestGlobals::testPortA);
+    ASSERT_TRUE(listener);
+    TcpSocket client("fallback.test", TestGlobals::testPortA, options);
+    ASSERT_TRUE(client.IsOpen());
+    TcpSocket host = listener.Accept();
+    ASSERT_TRUE(host.IsOpen());
+
+    char data = 7;
+    client.Write(&data, 1);
+    data = 0;
+    ASSERT_TRUE(host.Read(&data, 1));
+    ASSERT_EQ(data, 7);
+}
+
+TEST_F(UnitTestSocket, ConnectSetupFallback)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpListener listener(TestGlobals::testPortA);
+    ASSERT_TRUE(listener);
+    Resolver resolver(Resolver::Options(), [](std::string const&) -> Resolver::Addresses {
+        return { IpAddressV6::Loopback, IpAddressV4::Loopback };
+    });
+    ConnectOptions options;
+    options.resolver = &resolver;
+#ifdef _WIN32
+    // Rejected for every address, so the connect fails with the setup error.
+    options.socketOptions.cork = true;
+    ASSERT_THROW(TcpSocket("setup.test", TestGlobals::testPortA, options), ProgramError);
+#else
+    // Out of range for IPv6 traffic classes but not for IPv4 TOS, so only the IPv6 attempt fails to set up.
+    options.socketOptions.tos = 0x100;
+    TcpSocket client("setup.test", TestGlobals::testPortA, options);
+    ASSERT_TRUE(client.IsOpen());
+    TcpSocket host = listener.Accept();
+    ASSERT_TRUE(host.IsOpen());
+#endif
+}
+
+TEST_F(UnitTestSocket, ConnectTimeout)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    Resolver resolver(Resolver::Options(), [](std::string const&) -> Resolver::Addresses {
+        return { IpAddressV4("192.0.2.1") };
+    });
+    ConnectOptions options;
+    options.timeout = std::chrono::milliseconds(200);
+    options.resolver = &resolver;
+
+    auto const start = std::chrono::steady_clock::now();
+    ErrorCode ec;
+    TcpSocket client("blackhole.test", TestGlobals::testPortA, options, &ec);
+    ASSERT_TRUE(ec);
+    ASSERT_FALSE(client.IsOpen());
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1500));
+}
+
+TEST_F(UnitTestSocket, ConnectAsync)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpListener listener(TestGlobals::testPortA);
+    ASSERT_TRUE(listener);
+
+    std::future<TcpSocket> future = TcpSocket::ConnectAsync(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket host = listener.Accept();
+    ASSERT_TRUE(host.IsOpen());
+    TcpSocket client = future.get();
+    ASSERT_TRUE(client.IsOpen());
+
+    std::promise<TcpSocket> connected;
+    TcpSocket::ConnectAsync(TestGlobals::localhost, TestGlobals::testPortA, ConnectOptions(), [&connected](TcpSocket socket, ErrorCode const& ec) {
+        EXPECT_FALSE(ec);
+        connected.set_value(std::move(socket));
+    });
+    TcpSocket host2 = listener.Accept();
+    TcpSocket client2 = connected.get_future().get();
+    ASSERT_TRUE(client2.IsOpen());
+
+    char data = 9;
+    client2.Write(&data, 1);
+    data = 0;
+    ASSERT_TRUE(host2.Read(&data, 1));
+    ASSERT_EQ(data, 9);
+}
+
+TEST_F(UnitTestSocket, ConnectAsyncFail)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    Resolver resolver(Resolver::Options(), [](std::string const&) -> Resolver::Addresses {
+        return { IpAddressV4("192.0.2.1") };
+    });
+    ConnectOptions options;
+    options.timeout = std::chrono::milliseconds(200);
+    options.resolver = &resolver;
+
+    std::future<TcpSocket> future = TcpSocket::ConnectAsync("blackhole.test", TestGlobals::testPortA, options);
+    ASSERT_THROW(future.get(), SocketError);
+
+    std::promise<ErrorCode> failed;
+    TcpSocket::ConnectAsync("blackhole.test", TestGlobals::testPortA, options, [&failed](TcpSocket socket, ErrorCode const& ec) {
+        EXPECT_FALSE(socket.IsOpen());
+        failed.set_value(ec);
+    });
+    ASSERT_TRUE(failed.get_future().get());
+
+    // Exceptions other than ProgramError are reported too, instead of escaping into the pool's thread.
+    Resolver throwing(Resolver::Options(), [](std::string const&) -> Resolver::Addresses { throw std::bad_alloc(); });
+    options.resolver = &throwing;
+    ASSERT_THROW(TcpSocket::ConnectAsync("throws.test", TestGlobals::testPortA, options).get(), std::bad_alloc);
+    std::promise<ErrorCode> thrown;
+    TcpSocket::ConnectAsync("throws.test", TestGlobals::testPortA, options, [&thrown](TcpSocket, ErrorCode const& ec) {
+        thrown.set_value(ec);
+    });
+    ErrorCode const ec = thrown.get_future().get();
+    ASSERT_TRUE(ec);
+    ASSERT_THROW(ec.Rethrow(), std::bad_alloc);
+
+    // A throwing callback doesn't take the pool down.
+    std::promise<void> called;
+    TcpSocket::ConnectAsync("throws.test", TestGlobals::testPortA, options, [&called](TcpSocket, ErrorCode const&) {
+        called.set_value();
+        throw std::runtime_error("callback");
+    });
+    called.get_future().get();
+    ASSERT_THROW(TcpSocket::ConnectAsync("throws.test", TestGlobals::testPortA, options).get(), std::bad_alloc);
+}
+
+TEST_F(UnitTestSocket, ConnectLocalBind)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpListener listener(TestGlobals::testPortA);
+    ASSERT_TRUE(listener);
+
+    // Local address only. The port is left to the system.
+    ConnectOptions options;
+    options.localAddress = IpAddressV4::Loopback;
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA, options);
+    ASSERT_TRUE(client.IsOpen());
+    TcpSocket host = listener.Accept();
+
+    // A fixed local port can only be used by one connection at a time.
+    options.localPort = TestGlobals::testPortB;
+    TcpSocket client2(TestGlobals::localhost, TestGlobals::testPortA, options);
+    ASSERT_TRUE(client2.IsOpen());
+    TcpSocket host2 = listener.Accept();
+    ErrorCode ec;
+    TcpSocket client3(TestGlobals::localhost, TestGlobals::testPortA, options, &ec);
+    ASSERT_TRUE(ec);
+    ASSERT_FALSE(client3.IsOpen());
+
+    // The local address must have the family of a resolved address.
+    options.localAddress = IpAddressV6::Loopback;
+    options.localPort = 0;
+    ASSERT_THROW(TcpSocket(TestGlobals::localhost, TestGlobals::testPortA, options), ProgramError);
+    TcpSocket client6("::1", TestGlobals::testPortA, options);
+    ASSERT_TRUE(client6.IsOpen());
+    TcpSocket host6 = listener.Accept();
+}
+
+TEST_F(UnitTestSocket, ConnectDevice)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpListener listener(TestGlobals::testPortA);
+    ConnectOptions options;
+#ifdef _WIN32
+    options.device = "lo";
+    ASSERT_THROW(TcpSocket(TestGlobals::localhost, TestGlobals::testPortA, options), ProgramError);
+#else
+    options.device = "lo";
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA, options);
+    ASSERT_TRUE(client.IsOpen());
+    TcpSocket host = listener.Accept();
+
+    options.device = "nosuchdevice0";
+    ASSERT_THROW(TcpSocket(TestGlobals::localhost, TestGlobals::testPortA, options), SocketError);
+#endif
+}
+
 TEST_F(UnitTestSocket, SelfConnectTcpEc)
 {
     Timeout timeout(std::chrono::seconds(3));
@@ -265,6 +515,43 @@ TEST_F(UnitTestSocket, SendRecvBufUdpEc)
 }
 
 // Test the DataAvailable() function.
+TEST_F(UnitTestSocket, DualStackUdp)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    auto const portA = TestGlobals::testPortA;
+    auto const portB = TestGlobals::testPortB;
+
+    UdpSocket sender(portB);
+    ASSERT_TRUE(sender);
+    UdpSocket receiver(portA);
+    ASSERT_TRUE(receiver);
+
+    char const sentData[3] = { 1, 2, 3 };
+    char recvData[3] = { 0, 0, 0 };
+    IpAddress senderIp;
+    uint16_t senderPort = 0;
+
+    // IPv6 sender.
+    sender.Write(sentData, 3, IpAddressV6::Loopback, portA);
+    ASSERT_EQ(receiver.Read(recvData, 3, &senderIp, &senderPort), 3u);
+    ASSERT_TRUE(std::equal(recvData, recvData + 3, sentData));
+    ASSERT_EQ(senderIp, IpAddress(IpAddressV6::Loopback));
+    ASSERT_EQ(senderPort, portB);
+
+    // IPv4 senders on the same socket are reported as IPv4, not IPv4-mapped.
+    sender.Write(sentData, 2, IpAddressV4::Loopback, portA);
+    ASSERT_EQ(receiver.Read(recvData, 3, &senderIp, &senderPort), 2u);
+    ASSERT_EQ(senderIp, IpAddress(IpAddressV4::Loopback));
+    ASSERT_EQ(senderPort, portB);
+
+    // The IPv4-only overload rejects an IPv6 sender.
+    IpAddressV4 senderIpV4;
+    receiver.Write(sentData, 1, IpAddress("::1"), portB);
+    ASSERT_THROW(sender.Read(recvData, 3, &senderIpV4, &senderPort), ProgramError);
+    ASSERT_TRUE(sender.IsOpen());
+}
+
 TEST_F(UnitTestSocket, DataAvailableTcp)
 {
     Timeout timeout(std::chrono::seconds(3));
@@ -317,6 +604,512 @@ TEST_F(UnitTestSocket, DataAvailableTcpEc)
     ASSERT_FALSE(ec);
 }
 
+TEST_F(UnitTestSocket, WaitReadableTcp)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSocket clientA(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket serverA = listener.Accept();
+    TcpSocket clientB(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket serverB = listener.Accept();
+
+    std::vector<TcpSocket*> const sockets = { &serverA, &serverB };
+    std::vector<bool> ready;
+    ASSERT_EQ(TcpSocket::WaitReadable(sockets, &ready, 0), 0u);
+    ASSERT_EQ(ready, std::vector<bool>({ false, false }));
+
+    char c = 'b';
+    clientB.Write(&c, 1);
+    ASSERT_EQ(TcpSocket::WaitReadable(sockets, &ready, -1), 1u);
+    ASSERT_EQ(ready, std::vector<bool>({ false, true }));
+    ASSERT_TRUE(serverB.Read(&c, 1));
+
+    // A closed connection is readable.
+    clientA.Close();
+    ASSERT_EQ(TcpSocket::WaitReadable(sockets, &ready, 1000), 1u);
+    ASSERT_EQ(ready, std::vector<bool>({ true, false }));
+    ASSERT_FALSE(serverA.Read(&c, 1));
+
+    ErrorCode ec;
+    ASSERT_EQ(TcpSocket::WaitReadable({}, &ready, 0, &ec), 0u);
+    ASSERT_TRUE(ec);
+    serverB.Close();
+    ASSERT_THROW(TcpSocket::WaitReadable(sockets, &ready, 0), ProgramError);
+}
+
+TEST_F(UnitTestSocket, StatsTcp)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket host = listener.Accept();
+
+    SocketStats stats = client.GetStats();
+    ASSERT_EQ(stats.bytesWritten, 0u);
+    ASSERT_EQ(stats.writeCalls, 0u);
+
+    char const sentData[5] = { 1, 2, 3, 4, 5 };
+    client.Write(sentData, 5);
+    client.Write(sentData, 3);
+    char recvData[8] = {};
+    ASSERT_TRUE(host.Read(recvData, 8));
+
+    stats = client.GetStats();
+    SocketStats const hostStats = host.GetStats();
+#if STRAPPER_NET_SOCKET_STATS
+    ASSERT_EQ(stats.bytesWritten, 8u);
+    ASSERT_EQ(stats.writeCalls, 2u);
+    ASSERT_EQ(stats.partialWrites, 0u);
+    ASSERT_EQ(hostStats.bytesRead, 8u);
+    ASSERT_GE(hostStats.readCalls, 1u);
+    ASSERT_EQ(hostStats.readCalls, hostStats.partialReads + 1);
+#else
+    ASSERT_EQ(stats.bytesWritten, 0u);
+    ASSERT_EQ(hostStats.bytesRead, 0u);
+#endif
+
+    // The counters outlive the connection.
+    client.Close();
+    ASSERT_FALSE(host.Read(recvData, 1));
+    ASSERT_EQ(client.GetStats().bytesWritten, stats.bytesWritten);
+    ASSERT_EQ(host.GetStats().bytesRead, hostStats.bytesRead);
+    ASSERT_EQ(TcpSocket().GetStats().readCalls, 0u);
+}
+
+TEST_F(UnitTestSocket, StatsDuringBlockedWrite)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket host = listener.Accept();
+
+    // Far more than the socket buffers hold, so the write blocks until the host reads.
+    std::vector<char> const sentData(32 * 1024 * 1024, 'x');
+    std::thread writer([&client, &sentData]() { client.Write(sentData.data(), sentData.size()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Returns without waiting for the write. The send in progress isn't counted until it returns.
+    SocketStats const stats = client.GetStats();
+
+    std::vector<char> recvData(sentData.size());
+    bool const read = host.Read(recvData.data(), recvData.size());
+    writer.join();
+    ASSERT_TRUE(read);
+    ASSERT_LT(stats.bytesWritten, sentData.size());
+#if STRAPPER_NET_SOCKET_STATS
+    ASSERT_EQ(client.GetStats().bytesWritten, sentData.size());
+#endif
+}
+
+TEST_F(UnitTestSocket, TcpInfo)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket host = listener.Accept();
+
+#ifdef _WIN32
+    ASSERT_THROW(client.GetTcpInfo(), ProgramError);
+#else
+    std::vector<char> data(100000, 'x');
+    client.Write(data.data(), data.size());
+    ASSERT_TRUE(host.Read(data.data(), data.size()));
+
+    TcpInfo const info = client.GetTcpInfo();
+    ASSERT_GT(info.sendMss, 0u);
+    ASSERT_GT(info.congestionWindowBytes, 0u);
+    ASSERT_GT(info.rttMicroseconds, 0u);
+    ASSERT_GT(host.GetTcpInfo().bytesReceived, 0u);
+
+    // Does not wait for a blocked read.
+    char c = 0;
+    std::thread reader([&host, &c]() { ASSERT_TRUE(host.Read(&c, 1)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_GT(host.GetTcpInfo().sendMss, 0u);
+    client.Write(&c, 1);
+    reader.join();
+
+    // Nor for a blocked write.
+    std::vector<char> const large(32 * 1024 * 1024, 'x');
+    std::thread writer([&client, &large]() { client.Write(large.data(), large.size()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    uint32_t const mss = client.GetTcpInfo().sendMss;
+    std::vector<char> received(large.size());
+    bool const read = host.Read(received.data(), received.size());
+    writer.join();
+    ASSERT_TRUE(read);
+    ASSERT_GT(mss, 0u);
+#endif
+
+    client.Close();
+    ErrorCode ec;
+    client.GetTcpInfo(&ec);
+    ASSERT_TRUE(ec);
+}
+
+TEST_F(UnitTestSocket, OptionsTcp)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    TcpListener listener(TestGlobals::testPortA);
+    ConnectOptions connectOptions;
+    connectOptions.socketOptions.receiveBufferSize = 64 * 1024;
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA, connectOptions);
+    TcpSocket host = listener.Accept();
+    ASSERT_GE(client.GetOptions().receiveBufferSize.Get(), 64 * 1024);
+
+    SocketOptions options;
+    options.noDelay = true;
+    KeepAlive keepAlive;
+    keepAlive.idle = std::chrono::seconds(30);
+    keepAlive.interval = std::chrono::seconds(5);
+    keepAlive.count = 3;
+    options.keepAlive = keepAlive;
+    client.SetOptions(options);
+
+    SocketOptions const applied = client.GetOptions();
+    ASSERT_TRUE(applied.noDelay.Get());
+    ASSERT_TRUE(applied.keepAlive.Get().enable);
+    ASSERT_EQ(applied.keepAlive.Get().idle, std::chrono::seconds(30));
+    ASSERT_EQ(applied.keepAlive.Get().interval, std::chrono::seconds(5));
+    ASSERT_EQ(applied.keepAlive.Get().count, 3u);
+    ASSERT_FALSE(host.GetOptions().noDelay.Get());
+
+    SocketOptions linuxOnly;
+    linuxOnly.cork = true;
+    linuxOnly.userTimeout = std::chrono::milliseconds(5000);
+    linuxOnly.notSentLowWatermark = 16 * 1024;
+    linuxOnly.tos = 0x10;
+#ifdef _WIN32
+    ASSERT_THROW(client.SetOptions(linuxOnly), ProgramError);
+#else
+    client.SetOptions(linuxOnly);
+    SocketOptions const linuxApplied = client.GetOptions();
+    ASSERT_TRUE(linuxApplied.cork.Get());
+    ASSERT_EQ(linuxApplied.userTimeout.Get(), std::chrono::milliseconds(5000));
+    ASSERT_EQ(linuxApplied.notSentLowWatermark.Get(), 16 * 1024);
+    ASSERT_EQ(linuxApplied.tos.Get(), 0x10);
+
+    // Can be changed while another thread is reading. Uncorking flushes the held byte.
+    char c = 'x';
+    client.Write(&c, 1);
+    std::thread reader([&host, &c]() { ASSERT_TRUE(host.Read(&c, 1)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    SocketOptions uncork;
+    uncork.cork = false;
+    uncork.quickAck = true;
+    host.SetOptions(uncork);
+    client.SetOptions(uncork);
+    reader.join();
+#endif
+
+    client.Close();
+    ErrorCode ec;
+    client.SetOptions(options, &ec);
+    ASSERT_TRUE(ec);
+    ec = ErrorCode();
+    client.GetOptions(&ec);
+    ASSERT_TRUE(ec);
+}
+
+TEST_F(UnitTestSocket, OptionsInherited)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    SocketOptions options;
+    options.noDelay = true;
+    options.keepAlive = KeepAlive();
+    TcpListener listener(TestGlobals::testPortA, options);
+    ASSERT_TRUE(listener.GetOptions().noDelay.Get());
+
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket host = listener.Accept();
+    ASSERT_TRUE(host.GetOptions().noDelay.Get());
+    ASSERT_TRUE(host.GetOptions().keepAlive.Get().enable);
+    ASSERT_FALSE(client.GetOptions().noDelay.Get());
+
+    // Only sockets accepted afterwards see a change.
+    options.noDelay = false;
+    listener.SetOptions(options);
+    TcpSocket client2(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket host2 = listener.Accept();
+    ASSERT_FALSE(host2.GetOptions().noDelay.Get());
+    ASSERT_TRUE(host.GetOptions().noDelay.Get());
+}
+
+TEST_F(UnitTestSocket, OptionsUdp)
+{
+    UdpSocket socket(TestGlobals::testPortA);
+    SocketOptions options;
+    options.sendBufferSize = 32 * 1024;
+    socket.SetOptions(options);
+    SocketOptions const applied = socket.GetOptions();
+    ASSERT_GE(applied.sendBufferSize.Get(), 32 * 1024);
+    ASSERT_FALSE(applied.noDelay.IsSet());
+
+    // TCP options are rejected.
+    options.noDelay = true;
+    ErrorCode ec;
+    socket.SetOptions(options, &ec);
+    ASSERT_TRUE(ec);
+}
+
+TEST_F(UnitTestSocket, SendFile)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    std::vector<char> contents(300000);
+    for (size_t i = 0; i < contents.size(); ++i)
+        contents[i] = static_cast<char>(i * 7);
+    std::unique_ptr<FILE, decltype(&std::fclose)> file(std::tmpfile(), &std::fclose);
+    ASSERT_TRUE(file);
+    ASSERT_EQ(std::fwrite(contents.data(), 1, contents.size(), file.get()), contents.size());
+    ASSERT_EQ(std::fflush(file.get()), 0);
+    int const fd = fileno(file.get());
+
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket host = listener.Accept();
+
+    // Read on a separate thread, since the whole range does not fit in the socket buffers.
+    size_t const offset = 1000;
+    size_t const len = 200000;
+    std::vector<char> received(len);
+    std::thread reader([&host, &received]() { ASSERT_TRUE(host.Read(received.data(), received.size())); });
+    ASSERT_EQ(client.SendFile(fd, offset, len), len);
+    reader.join();
+    ASSERT_TRUE(std::equal(received.begin(), received.end(), contents.begin() + offset));
+
+    // Stops at the end of the file.
+    ASSERT_EQ(client.SendFile(fd, contents.size() - 10, 100), 10u);
+    ASSERT_TRUE(host.Read(received.data(), 10));
+    ASSERT_TRUE(std::equal(received.begin(), received.begin() + 10, contents.end() - 10));
+
+    // Progress is reported along with the error.
+    host.Close();
+    ErrorCode ec;
+    size_t sent = 0;
+    while (!ec)
+        sent += client.SendFile(fd, 0, contents.size(), &ec);
+    ASSERT_TRUE(ec);
+    ASSERT_GT(sent, 0u);
+}
+
+TEST_F(UnitTestSocket, SpliceTo)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    // client <-> proxyIn | proxyOut <-> server
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket proxyIn = listener.Accept();
+    TcpSocket proxyOut(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket server = listener.Accept();
+
+    // Both directions at once.
+    size_t const len = 500000;
+    std::vector<char> request(len, 'q');
+    std::vector<char> response(len, 'r');
+    std::thread upstream([&proxyIn, &proxyOut, len]() { ASSERT_EQ(proxyIn.SpliceTo(proxyOut, len), len); });
+    std::thread downstream([&proxyIn, &proxyOut, len]() { ASSERT_EQ(proxyOut.SpliceTo(proxyIn, len), len); });
+    std::thread clientWriter([&client, &request]() { client.Write(request.data(), request.size()); });
+    std::thread serverWriter([&server, &response]() { server.Write(response.data(), response.size()); });
+
+    std::vector<char> received(len);
+    ASSERT_TRUE(server.Read(received.data(), received.size()));
+    ASSERT_EQ(received, request);
+    ASSERT_TRUE(client.Read(received.data(), received.size()));
+    ASSERT_EQ(received, response);
+    upstream.join();
+    downstream.join();
+    clientWriter.join();
+    serverWriter.join();
+
+    // Stops early when the source closes.
+    client.Write(request.data(), 100);
+    client.ShutdownSend();
+    ASSERT_EQ(proxyIn.SpliceTo(proxyOut, len), 100u);
+    ASSERT_TRUE(server.Read(received.data(), 100));
+    ASSERT_TRUE(proxyIn.IsOpen());
+
+    // Can be stopped by closing the source from another thread.
+    std::thread splicer([&proxyOut, &proxyIn, len]() {
+        ErrorCode ec;
+        ASSERT_EQ(proxyOut.SpliceTo(proxyIn, len, &ec), 0u);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    proxyOut.Close();
+    splicer.join();
+
+    ASSERT_THROW(proxyIn.SpliceTo(proxyIn, 1), ProgramError);
+}
+
+TEST_F(UnitTestSocket, WriteZeroCopy)
+{
+    Timeout timeout(std::chrono::seconds(5));
+
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket host = listener.Accept();
+
+    // Small writes are copied right away. The callback runs with the socket unlocked, so it may use it.
+    char const small[10] = "012345678";
+    bool smallReleased = false;
+    client.WriteZeroCopy(small, sizeof(small), [&smallReleased, &client](TcpSocket::ZeroCopyStatus status) {
+        ASSERT_EQ(status, TcpSocket::ZeroCopyStatus::COPIED);
+        static_cast<void>(client.ZeroCopyEnabled());  // Would deadlock if the socket were still locked.
+        smallReleased = true;
+    });
+    ASSERT_TRUE(smallReleased);
+    char received[sizeof(small)] = {};
+    ASSERT_TRUE(host.Read(received, sizeof(received)));
+    ASSERT_TRUE(std::equal(small, small + sizeof(small), received));
+
+    // Each buffer is released exactly once, after which it may be reused.
+    size_t const count = 20;
+    size_t const len = 64 * 1024;
+    std::vector<std::vector<char>> buffers;
+    for (size_t i = 0; i < count; ++i)
+        buffers.emplace_back(len, static_cast<char>('a' + i));
+    std::vector<int> releases(count, 0);
+    std::vector<char> all(count * len);
+    std::thread reader([&host, &all]() { ASSERT_TRUE(host.Read(all.data(), all.size())); });
+    for (size_t i = 0; i < count; ++i)
+        client.WriteZeroCopy(buffers[i].data(), len, [&releases, i](TcpSocket::ZeroCopyStatus status) {
+            if (status != TcpSocket::ZeroCopyStatus::CANCELLED)
+                ++releases[i];
+        });
+    reader.join();
+    ASSERT_EQ(client.PollZeroCopy(-1), 0u);
+    ASSERT_EQ(releases, std::vector<int>(count, 1));
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_TRUE(std::all_of(all.begin() + static_cast<std::ptrdiff_t>(i * len), all.begin() + static_cast<std::ptrdiff_t>((i + 1) * len), [i](char c) { return c == static_cast<char>('a' + i); }));
+
+    // The kernel copies over loopback anyway, so zero-copy turns itself off.
+    ASSERT_FALSE(client.ZeroCopyEnabled());
+
+    client.Close();
+    ErrorCode ec;
+    bool closedReleased = false;
+    client.WriteZeroCopy(buffers[0].data(), len, [&closedReleased](TcpSocket::ZeroCopyStatus) { closedReleased = true; }, &ec);
+    ASSERT_TRUE(ec);
+    ASSERT_FALSE(closedReleased);  // Never handed to the socket.
+    client.PollZeroCopy(0, &ec);
+    ASSERT_TRUE(ec);
+}
+
+TEST_F(UnitTestSocket, WaitReadableZeroCopy)
+{
+    Timeout timeout(std::chrono::seconds(5));
+
+    TcpListener listener(TestGlobals::testPortA);
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA);
+    TcpSocket host = listener.Accept();
+
+    // The completion of a zero-copy send is queued as an error, but leaves nothing to read.
+    std::vector<char> sent(64 * 1024, 'z');
+    int releases = 0;
+    client.WriteZeroCopy(sent.data(), sent.size(), [&releases](TcpSocket::ZeroCopyStatus status) {
+        ASSERT_NE(status, TcpSocket::ZeroCopyStatus::CANCELLED);
+        ++releases;
+    });
+    std::vector<char> received(sent.size());
+    ASSERT_TRUE(host.Read(received.data(), received.size()));
+
+    std::vector<bool> ready;
+    ASSERT_EQ(TcpSocket::WaitReadable({ &client }, &ready, 200), 0u);
+    ASSERT_EQ(client.PollZeroCopy(-1), 0u);
+    ASSERT_EQ(releases, 1);
+
+    host.Write("x", 1);
+    ASSERT_EQ(TcpSocket::WaitReadable({ &client }, &ready, -1), 1u);
+    ASSERT_TRUE(ready[0]);
+}
+
+TEST_F(UnitTestSocket, ReadView)
+{
+    Timeout timeout(std::chrono::seconds(5));
+
+    // Pages can only be mapped if every segment carries whole pages. Over loopback that takes an MSS that is a
+    // multiple of the page size, and zero-copy sends, which loopback delivers as freshly copied whole pages.
+    TcpListener listener(TestGlobals::testPortA);
+    ConnectOptions options;
+#ifndef _WIN32
+    options.socketOptions.maxSegmentSize = 7 * 4096;
+#endif
+    TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA, options);
+    TcpSocket host = listener.Accept();
+
+    size_t const len = 4 * 1024 * 1024;
+    std::vector<char> sent(len);
+    for (size_t i = 0; i < len; ++i)
+        sent[i] = static_cast<char>(i * 13 + i / 4096);
+    std::thread writer([&client, &sent]() {
+        for (size_t i = 0; i < 4; ++i)
+            client.WriteZeroCopy(sent.data() + i * len / 4, len / 4, [](TcpSocket::ZeroCopyStatus) { });
+        client.ShutdownSend();
+    });
+
+    std::vector<char> received;
+    size_t mapped = 0;
+    for (;;)
+    {
+        ReceiveView const view = host.ReadView(1024 * 1024);
+        if (view.size == 0)
+            break;
+        received.insert(received.end(), view.data, view.data + view.size);
+        if (view.mapped)
+            mapped += view.size;
+    }
+    writer.join();
+    ASSERT_EQ(received, sent);
+#ifdef _WIN32
+    ASSERT_EQ(mapped, 0u);
+#else
+    ASSERT_GT(mapped, 0u);
+#endif
+
+    // Reading past the end closes the socket, like Read.
+    ErrorCode ec;
+    host.ReadView(1, &ec);
+    ASSERT_TRUE(ec);
+    ASSERT_FALSE(host.IsOpen());
+}
+
+TEST_F(UnitTestSocket, StatsUdp)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    IpAddressV4 const ip(TestGlobals::localhost);
+    UdpSocket sender(TestGlobals::testPortB);
+    UdpSocket receiver(TestGlobals::testPortA);
+
+    char const sentData[5] = { 1, 2, 3, 4, 5 };
+    sender.Write(sentData, 5, ip, TestGlobals::testPortA);
+    sender.Write(sentData, 2, ip, TestGlobals::testPortA);
+    char recvData[5] = {};
+    ASSERT_EQ(receiver.Read(recvData, 5, nullptr, nullptr), 5u);
+    ASSERT_EQ(receiver.Read(recvData, 5, nullptr, nullptr), 2u);
+
+    SocketStats const senderStats = sender.GetStats();
+    SocketStats const receiverStats = receiver.GetStats();
+#if STRAPPER_NET_SOCKET_STATS
+    ASSERT_EQ(senderStats.bytesWritten, 7u);
+    ASSERT_EQ(senderStats.writeCalls, 2u);
+    ASSERT_EQ(senderStats.readCalls, 0u);
+    ASSERT_EQ(receiverStats.bytesRead, 7u);
+    ASSERT_EQ(receiverStats.readCalls, 2u);
+    ASSERT_EQ(receiverStats.bytesWritten, 0u);
+#else
+    ASSERT_EQ(senderStats.bytesWritten, 0u);
+    ASSERT_EQ(receiverStats.bytesRead, 0u);
+#endif
+}
+
 // Test the DataAvailable() function.
 TEST_F(UnitTestSocket, DataAvailableUdp)
 {
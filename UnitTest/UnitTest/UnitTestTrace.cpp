@@ -0,0 +1,141 @@
+// ==================================================================
+// Copyright 2018-2022 Alexander K. Freed
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ==================================================================
+
+#include <gtest/gtest.h>
+
+#include <strapper/net/SocketError.h>
+#include <strapper/net/TcpListener.h>
+#include <strapper/net/Trace.h>
+#include "TestGlobals.h"
+#include "Timeout.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace strapper { namespace net { namespace test {
+
+class UnitTestTrace : public ::testing::Test
+{
+public:
+    void SetUp() override { Trace::Clear(); }
+    void TearDown() override
+    {
+        Trace::Enable(false);
+        Trace::SetRingRecords(Trace::c_defaultRingRecords);
+        Trace::Clear();
+    }
+
+    static std::vector<TraceRecord> DumpAndRead()
+    {
+        std::stringstream file;
+        size_t const written = Trace::Dump(file);
+        std::vector<TraceRecord> records = Trace::Read(file);
+        EXPECT_EQ(records.size(), written);
+        return records;
+    }
+};
+
+TEST_F(UnitTestTrace, Disabled)
+{
+    Trace::Record(TraceEvent::TCP_CLOSE, 1, 0);
+    ASSERT_TRUE(DumpAndRead().empty());
+}
+
+TEST_F(UnitTestTrace, Sockets)
+{
+    Timeout timeout(std::chrono::seconds(3));
+
+    Trace::Enable(true);
+    {
+        TcpListener listener(TestGlobals::testPortA);
+        TcpSocket client(TestGlobals::localhost, TestGlobals::testPortA);
+        TcpSocket host = listener.Accept();
+        char data[10] = {};
+        client.Write(data, 10);
+        ASSERT_TRUE(host.Read(data, 10));
+    }
+    Trace::Enable(false);
+
+    std::vector<TraceRecord> const records = DumpAndRead();
+    auto const count = [&records](TraceEvent event) {
+        return std::count_if(records.begin(), records.end(), [event](TraceRecord const& r) { return r.event == static_cast<uint16_t>(event); });
+    };
+    ASSERT_EQ(count(TraceEvent::TCP_CONNECT), 1);
+    ASSERT_EQ(count(TraceEvent::TCP_ACCEPT), 1);
+    ASSERT_EQ(count(TraceEvent::TCP_WRITE_START), 1);
+    ASSERT_EQ(count(TraceEvent::TCP_WRITE_END), 1);
+    ASSERT_GE(count(TraceEvent::TCP_READ_END), 1);
+    ASSERT_EQ(count(TraceEvent::TCP_CLOSE), 2);
+    for (size_t i = 1; i < records.size(); ++i)
+        ASSERT_LE(records[i - 1].nanoseconds, records[i].nanoseconds);
+
+    auto const writeEnd = std::find_if(records.begin(), records.end(), [](TraceRecord const& r) { return r.event == static_cast<uint16_t>(TraceEvent::TCP_WRITE_END); });
+    ASSERT_EQ(writeEnd->value, 10);
+    auto const connect = std::find_if(records.begin(), records.end(), [](TraceRecord const& r) { return r.event == static_cast<uint16_t>(TraceEvent::TCP_CONNECT); });
+    ASSERT_EQ(connect->value, static_cast<int64_t>(TestGlobals::testPortA));
+    ASSERT_EQ(connect->socket, writeEnd->socket);
+
+    std::ostringstream json;
+    Trace::WriteChromeJson(records, json);
+    std::string const text = json.str();
+    ASSERT_EQ(text.find(R"({"displayTimeUnit":"ns","traceEvents":[)"), 0u);
+    ASSERT_NE(text.find(R"({"name":"tcp_write","cat":"tcp","pid":1,"tid":)"), std::string::npos);
+    ASSERT_NE(text.find(R"("ph":"X","dur":)"), std::string::npos);
+    ASSERT_NE(text.find(R"("requested":10,"result":10})"), std::string::npos);
+    ASSERT_NE(text.find(R"({"name":"tcp_connect")"), std::string::npos);
+    ASSERT_EQ(text.find("incomplete"), std::string::npos);
+}
+
+TEST_F(UnitTestTrace, RingWraps)
+{
+    Trace::SetRingRecords(4);
+    Trace::Enable(true);
+    std::thread([]() {
+        for (int64_t i = 0; i < 10; ++i)
+            Trace::Record(TraceEvent::UDP_CLOSE, i, 0);
+    }).join();
+    Trace::Enable(false);
+
+    std::vector<TraceRecord> const records = DumpAndRead();
+    ASSERT_EQ(records.size(), 4u);
+    for (size_t i = 0; i < records.size(); ++i)
+        ASSERT_EQ(records[i].socket, static_cast<int64_t>(6 + i));
+
+    // The exited thread's ring is released.
+    Trace::Clear();
+    ASSERT_TRUE(DumpAndRead().empty());
+}
+
+TEST_F(UnitTestTrace, Decode)
+{
+    TraceRecord start{ 1000, 5, 100, 1, static_cast<uint16_t>(TraceEvent::UDP_READ_START), 0 };
+    TraceRecord end{ 3500, 5, 40, 1, static_cast<uint16_t>(TraceEvent::UDP_READ_END), 0 };
+    TraceRecord lone{ 2000, 6, 64, 2, static_cast<uint16_t>(TraceEvent::TCP_WRITE_START), 0 };
+    std::ostringstream json;
+    Trace::WriteChromeJson({ end, lone, start }, json);
+    std::string const text = json.str();
+    ASSERT_NE(text.find(R"({"name":"udp_read","cat":"udp","pid":1,"tid":1,"ts":0.000,"ph":"X","dur":2.500,"args":{"socket":5,"requested":100,"result":40}})"), std::string::npos);
+    ASSERT_NE(text.find(R"({"name":"tcp_write","cat":"tcp","pid":1,"tid":2,"ts":1.000,"ph":"i","s":"t","args":{"socket":6,"requested":64,"incomplete":true}})"), std::string::npos);
+
+    std::istringstream garbage("not a trace at all");
+    ASSERT_THROW(Trace::Read(garbage), ProgramError);
+}
+
+}}}  // namespace strapper::net::test
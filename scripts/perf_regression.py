@@ -0,0 +1,209 @@
+#!/usr/bin/env python
+
+# ==================================================================
+# Copyright 2022 Alexander K. Freed
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================
+
+"""Runs StrapperNetBench several times and compares the medians of tracked metrics against a checked-in baseline.
+
+Exits with 1 if any tracked metric regressed by more than its threshold, so it can gate a build.
+Everything runs over loopback. Baselines are only comparable on the same machine and build type,
+so regenerate the baseline with --update-baseline when either changes.
+"""
+
+import argparse
+import json
+import math
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+DEFAULT_THRESHOLD = 0.15
+
+
+def median(values: list) -> float:
+    ordered = sorted(values)
+    n = len(ordered)
+    if n == 0:
+        raise ValueError("median of no values")
+    middle = n // 2
+    if n % 2:
+        return ordered[middle]
+    return (ordered[middle - 1] + ordered[middle]) / 2
+
+
+def median_confidence_interval(values: list, confidence: float = 0.95) -> tuple:
+    """Distribution-free confidence interval for the median, from order statistics.
+    Uses the widest interval, the min and max, when there are too few values for the requested confidence.
+    """
+    ordered = sorted(values)
+    n = len(ordered)
+    if n == 0:
+        raise ValueError("confidence interval of no values")
+    alpha = 1 - confidence
+    # Find the largest k where P(Binomial(n, 0.5) < k) <= alpha / 2. Then [x(k), x(n-k+1)] covers the median.
+    cumulative = 0.0
+    k = 0
+    for i in range(n):
+        cumulative += math.comb(n, i) / 2**n
+        if cumulative > alpha / 2:
+            break
+        k = i + 1
+    if k == 0:
+        return ordered[0], ordered[-1]
+    return ordered[k - 1], ordered[n - k]
+
+
+def load_results(path: str) -> dict:
+    """Reads a Google Benchmark JSON file into {name: run}, skipping aggregates and errors."""
+    with open(path) as f:
+        data = json.load(f)
+    results = {}
+    for run in data.get("benchmarks", []):
+        if run.get("run_type", "iteration") != "iteration" or run.get("error_occurred"):
+            continue
+        results[run["name"]] = run
+    return results
+
+
+def benchmark_filter(metrics: dict) -> str:
+    """A --benchmark_filter regex that runs only the benchmark families with tracked metrics."""
+    families = sorted({name.split("/")[0] for name in metrics})
+    return "^({})(/|$)".format("|".join(re.escape(family) for family in families))
+
+
+def run_benchmarks(bench: str, runs: int, bench_filter: str, min_time: str) -> dict:
+    """Runs the benchmark binary in separate processes and returns {name: {field: [value per run]}}."""
+    samples = {}
+    with tempfile.TemporaryDirectory() as tmp:
+        for i in range(runs):
+            out = os.path.join(tmp, "run{}.json".format(i))
+            command = [
+                bench,
+                "--benchmark_filter=" + bench_filter,
+                "--benchmark_out=" + out,
+                "--benchmark_out_format=json",
+                "--benchmark_min_time=" + min_time,
+            ]
+            print("Run {}/{}: {}".format(i + 1, runs, " ".join(command)), flush=True)
+            subprocess.run(command, check=True, stdout=subprocess.DEVNULL)
+            for name, run in load_results(out).items():
+                fields = samples.setdefault(name, {})
+                for field, value in run.items():
+                    if isinstance(value, (int, float)) and not isinstance(value, bool):
+                        fields.setdefault(field, []).append(float(value))
+    return samples
+
+
+def compare(metric: dict, values: list, default_threshold: float) -> dict:
+    """Compares the samples of one metric to its baseline value.
+    A metric regresses when its median is worse than the baseline by more than the threshold.
+    The median already ignores a minority of noisy runs. The confidence interval is only reported, since with few runs
+    it spans nearly every sample and would hide real regressions.
+    """
+    baseline = float(metric["value"])
+    threshold = float(metric.get("threshold", default_threshold))
+    lower_is_better = metric.get("better", "lower") == "lower"
+
+    mid = median(values)
+    low, high = median_confidence_interval(values)
+    change = (mid - baseline) / baseline if baseline else 0.0
+    worse_by = change if lower_is_better else -change
+    return {
+        "median": mid,
+        "low": low,
+        "high": high,
+        "baseline": baseline,
+        "change": change,
+        "regressed": worse_by > threshold,
+    }
+
+
+def check(baseline: dict, samples: dict) -> list:
+    """Returns a list of (name, field, comparison) tuples, with comparison None if the metric wasn't measured."""
+    default_threshold = float(baseline.get("threshold", DEFAULT_THRESHOLD))
+    report = []
+    for name, metric in sorted(baseline["metrics"].items()):
+        field = metric.get("field", "real_time")
+        values = samples.get(name, {}).get(field)
+        report.append((name, field, compare(metric, values, default_threshold) if values else None))
+    return report
+
+
+def update_baseline(baseline: dict, samples: dict) -> list:
+    """Sets each tracked metric's value to its measured median. Returns the names that weren't measured."""
+    missing = []
+    for name, metric in baseline["metrics"].items():
+        values = samples.get(name, {}).get(metric.get("field", "real_time"))
+        if not values:
+            missing.append(name)
+            continue
+        metric["value"] = round(median(values), 3)
+    return missing
+
+
+def print_report(report: list):
+    print("{:<55} {:>18} {:>14} {:>14} {:>27} {:>8}".format("metric", "field", "baseline", "median", "95% CI", "change"))
+    for name, field, result in report:
+        if result is None:
+            print("{:<55} {:>18} {:>14}  NOT MEASURED".format(name, field, ""))
+            continue
+        status = "  REGRESSED" if result["regressed"] else ""
+        print("{:<55} {:>18} {:>14.6g} {:>14.6g} {:>27} {:>+7.1%}{}".format(
+            name, field, result["baseline"], result["median"],
+            "[{:.6g}, {:.6g}]".format(result["low"], result["high"]), result["change"], status))
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--bench", required=True, help="Path to the StrapperNetBench executable.")
+    parser.add_argument("--baseline", required=True, help="Baseline JSON file with the tracked metrics.")
+    parser.add_argument("--runs", type=int, default=9, help="Number of times to run the benchmarks. Default 9, the fewest for a 95%% interval narrower than the extremes.")
+    parser.add_argument("--min-time", default="0.5", help="Passed to --benchmark_min_time. Default 0.5 seconds.")
+    parser.add_argument("--update-baseline", action="store_true", help="Write the measured medians into the baseline file.")
+    args = parser.parse_args()
+
+    if args.runs < 1:
+        parser.error("--runs must be at least 1")
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+
+    samples = run_benchmarks(args.bench, args.runs, benchmark_filter(baseline["metrics"]), args.min_time)
+
+    if args.update_baseline:
+        missing = update_baseline(baseline, samples)
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=4)
+            f.write("\n")
+        for name in missing:
+            print("Not measured, left unchanged: " + name)
+        print("Updated " + args.baseline)
+        return 1 if missing else 0
+
+    report = check(baseline, samples)
+    print_report(report)
+    failed = [name for name, _, result in report if result is None or result["regressed"]]
+    if failed:
+        print("\n{} tracked metric(s) regressed or were not measured.".format(len(failed)))
+        return 1
+    print("\nNo regressions.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,106 @@
+# ==================================================================
+# Copyright 2022 Alexander K. Freed
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================
+
+import json
+
+import pytest
+
+from perf_regression import *
+
+
+def test_median():
+    assert median([3]) == 3
+    assert median([5, 1, 3]) == 3
+    assert median([4, 1, 3, 2]) == 2.5
+    with pytest.raises(ValueError):
+        median([])
+
+
+def test_confidence_interval_small_sample_uses_extremes():
+    assert median_confidence_interval([5, 1, 4, 2, 3]) == (1, 5)
+    assert median_confidence_interval([7]) == (7, 7)
+
+
+def test_confidence_interval_narrows_with_more_samples():
+    values = list(range(1, 21))
+    low, high = median_confidence_interval(values)
+    assert (low, high) == (6, 15)
+    assert low <= median(values) <= high
+
+
+def test_lower_is_better_regression():
+    metric = {"value": 100, "better": "lower"}
+    result = compare(metric, [130, 131, 129, 132, 130], 0.15)
+    assert result["regressed"]
+    assert result["change"] == pytest.approx(0.30)
+
+
+def test_higher_is_better_regression():
+    metric = {"value": 100, "better": "higher"}
+    assert compare(metric, [70, 71, 69, 72, 70], 0.15)["regressed"]
+    assert not compare(metric, [130, 131, 129, 132, 130], 0.15)["regressed"]
+
+
+def test_noisy_samples_use_the_median():
+    metric = {"value": 100, "better": "lower"}
+    # Outliers alone don't regress.
+    assert not compare(metric, [95, 100, 105, 250, 300], 0.15)["regressed"]
+    # A median 30% worse regresses, even when the interval includes the baseline.
+    result = compare(metric, [95, 130, 130, 131, 200], 0.15)
+    assert result["low"] <= 100
+    assert result["regressed"]
+
+
+def test_per_metric_threshold():
+    metric = {"value": 100, "better": "lower", "threshold": 0.5}
+    assert not compare(metric, [130, 131, 129, 132, 130], 0.15)["regressed"]
+
+
+def test_check_reports_missing_metrics():
+    baseline = {"metrics": {
+        "A/real_time": {"field": "real_time", "value": 10},
+        "B": {"field": "items_per_second", "better": "higher", "value": 10},
+    }}
+    samples = {"A/real_time": {"real_time": [10, 10, 10]}}
+    report = check(baseline, samples)
+    assert [(name, field) for name, field, _ in report] == [("A/real_time", "real_time"), ("B", "items_per_second")]
+    assert not report[0][2]["regressed"]
+    assert report[1][2] is None
+
+
+def test_update_baseline():
+    baseline = {"metrics": {"A": {"value": 10}, "B": {"value": 5}}}
+    missing = update_baseline(baseline, {"A": {"real_time": [1, 2, 3]}})
+    assert baseline["metrics"]["A"]["value"] == 2
+    assert baseline["metrics"]["B"]["value"] == 5
+    assert missing == ["B"]
+
+
+def test_benchmark_filter():
+    regex = benchmark_filter({"TcpSocketPingPong/64/real_time": {}, "TcpSocketPingPong/1/real_time": {}, "IpAddressV4Parse": {}})
+    assert regex == "^(IpAddressV4Parse|TcpSocketPingPong)(/|$)"
+    assert re.search(regex, "TcpSocketPingPong/64")
+    assert not re.search(regex, "TcpSocketPingPongX/64")
+
+
+def test_load_results_skips_aggregates_and_errors(tmp_path):
+    path = tmp_path / "results.json"
+    path.write_text(json.dumps({"benchmarks": [
+        {"name": "A", "run_type": "iteration", "real_time": 1.0},
+        {"name": "A_mean", "run_type": "aggregate", "real_time": 1.0},
+        {"name": "B", "run_type": "iteration", "error_occurred": True},
+    ]}))
+    assert list(load_results(str(path))) == ["A"]